@@ -1,11 +1,19 @@
 /**
  * @file capture.cpp
  *
- * Implementation of the screenshot function.
+ * Implementation of the screenshot and frame capture functions.
  */
+#include <array>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <ctime>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -14,124 +22,156 @@
 #include "engine/dx.h"
 #include "engine/palette.h"
 #include "utils/file_util.h"
+#include "utils/frame_stream.hpp"
 #include "utils/log.hpp"
 #include "utils/paths.h"
-#include "utils/pcx.hpp"
+#include "utils/sdl_cond.h"
+#include "utils/sdl_geometry.h"
+#include "utils/sdl_mutex.h"
+#include "utils/sdl_thread.h"
 #include "utils/str_cat.hpp"
+#include "utils/surface_to_pcx.hpp"
 #include "utils/ui_fwd.h"
 
 namespace devilution {
 namespace {
 
-/**
- * @brief Write the PCX-file header
- * @param width Image width
- * @param height Image height
- * @param out File stream to write to
- * @return True on success
- */
-bool CaptureHdr(int16_t width, int16_t height, FILE *out)
-{
-	PCXHeader buffer;
-
-	memset(&buffer, 0, sizeof(buffer));
-	buffer.Manufacturer = 10;
-	buffer.Version = 5;
-	buffer.Encoding = 1;
-	buffer.BitsPerPixel = 8;
-	buffer.Xmax = SDL_SwapLE16(width - 1);
-	buffer.Ymax = SDL_SwapLE16(height - 1);
-	buffer.HDpi = SDL_SwapLE16(width);
-	buffer.VDpi = SDL_SwapLE16(height);
-	buffer.NPlanes = 1;
-	buffer.BytesPerLine = SDL_SwapLE16(width);
-
-	return std::fwrite(&buffer, sizeof(buffer), 1, out) == 1;
-}
+struct CaptureJob {
+	FILE *out;
+	std::string path;
+	OwnedSurface pixels;
+	std::array<SDL_Color, 256> palette;
+};
 
-/**
- * @brief Write the current in-game palette to the PCX file
- * @param palette Current palette
- * @param out File stream for the PCX file.
- * @return True if successful, else false
- */
-bool CapturePal(SDL_Color *palette, FILE *out)
+SdlMutex CaptureMutex;
+/** @brief Screenshots waiting to be encoded, in the order they were taken. */
+std::deque<CaptureJob> CaptureQueue;
+/** @brief Whether CaptureThread is still working through CaptureQueue. */
+bool CaptureWorkerRunning;
+SdlThread CaptureThread;
+
+void WriteCapture(CaptureJob &job)
 {
-	uint8_t pcxPalette[1 + 256 * 3];
+	const bool success = SurfaceToPcx(job.pixels, job.palette.data(), job.out);
+	std::fclose(job.out);
 
-	pcxPalette[0] = 12;
-	for (int i = 0; i < 256; i++) {
-		pcxPalette[1 + 3 * i + 0] = palette[i].r;
-		pcxPalette[1 + 3 * i + 1] = palette[i].g;
-		pcxPalette[1 + 3 * i + 2] = palette[i].b;
+	if (!success) {
+		Log("Failed to save screenshot at {}", job.path);
+		RemoveFile(job.path.c_str());
+	} else {
+		Log("Screenshot saved at {}", job.path);
 	}
+}
 
-	return std::fwrite(pcxPalette, sizeof(pcxPalette), 1, out) == 1;
+void CaptureWorker()
+{
+	while (true) {
+		std::optional<CaptureJob> job;
+		{
+			std::lock_guard<SdlMutex> lock(CaptureMutex);
+			if (CaptureQueue.empty()) {
+				CaptureWorkerRunning = false;
+				return;
+			}
+			job.emplace(std::move(CaptureQueue.front()));
+			CaptureQueue.pop_front();
+		}
+		WriteCapture(*job);
+	}
 }
 
-/**
- * @brief RLE compress the pixel data
- * @param src Raw pixel buffer
- * @param dst Output buffer
- * @param width Width of pixel buffer
+/** @brief Frames the game thread may get ahead of the encoder before it has to wait, this bounds the memory used. */
+constexpr size_t MaxQueuedFrames = 8;
 
- * @return Output buffer
- */
-uint8_t *CaptureEnc(uint8_t *src, uint8_t *dst, int width)
-{
-	int rleLength;
+struct CapturedFrame {
+	uint32_t number;
+	std::unique_ptr<uint8_t[]> pixels;
+	std::array<SDL_Color, 256> palette;
+};
 
-	do {
-		uint8_t rlePixel = *src;
-		src++;
-		rleLength = 1;
+struct FrameCaptureState {
+	FILE *out;
+	std::string path;
+	int width;
+	int height;
 
-		width--;
+	SdlMutex mutex;
+	SdlCond frameQueued;
+	SdlCond frameTaken;
+	std::deque<CapturedFrame> queue;
+	/** @brief Pixel buffers of frames that have been written, reused for new frames. */
+	std::vector<std::unique_ptr<uint8_t[]>> freeBuffers;
+	bool stopRequested = false;
+	SdlThread thread;
+};
 
-		while (rlePixel == *src) {
-			if (rleLength >= 63)
-				break;
-			if (width == 0)
-				break;
-			rleLength++;
+/** @brief Capture every n-th frame, 0 when frame capture is off. */
+int FrameCaptureInterval;
+/** @brief Number of frames presented since frame capture was enabled. */
+uint32_t FrameCaptureCount;
+std::unique_ptr<FrameCaptureState> FrameCapture;
 
-			width--;
-			src++;
+void FrameCaptureWorker()
+{
+	FrameCaptureState &state = *FrameCapture;
+	FrameStreamWriter writer(state.out, state.width, state.height);
+	bool reportedError = false;
+	while (true) {
+		CapturedFrame frame;
+		{
+			std::unique_lock<SdlMutex> lock(state.mutex);
+			state.frameQueued.wait(lock, [&state] { return !state.queue.empty() || state.stopRequested; });
+			if (state.queue.empty())
+				break;
+			frame = std::move(state.queue.front());
+			state.queue.pop_front();
 		}
+		state.frameTaken.notify_one();
 
-		if (rleLength > 1 || rlePixel > 0xBF) {
-			*dst = rleLength | 0xC0;
-			dst++;
+		// Keep draining the queue after a write error so that the game thread never blocks on it.
+		if (!writer.WriteFrame(frame.number, frame.pixels.get(), frame.palette) && !reportedError) {
+			LogError("Failed to write frame {} to {}", frame.number, state.path);
+			reportedError = true;
 		}
 
-		*dst = rlePixel;
-		dst++;
-	} while (width > 0);
-
-	return dst;
+		std::lock_guard<SdlMutex> lock(state.mutex);
+		state.freeBuffers.push_back(std::move(frame.pixels));
+	}
 }
 
-/**
- * @brief Write the pixel data to the PCX file
- *
- * @param buf Pixel data
- * @param out File stream for the PCX file.
- * @return True if successful, else false
- */
-bool CapturePix(const Surface &buf, FILE *out)
+bool OpenFrameCapture(int width, int height)
 {
-	int width = buf.w();
-	std::unique_ptr<uint8_t[]> pBuffer { new uint8_t[2 * width] };
-	uint8_t *pixels = buf.begin();
-	for (int height = buf.h(); height > 0; height--) {
-		const uint8_t *pBufferEnd = CaptureEnc(pixels, pBuffer.get(), width);
-		pixels += buf.pitch();
-		if (std::fwrite(pBuffer.get(), pBufferEnd - pBuffer.get(), 1, out) != 1)
-			return false;
+	std::string path = StrCat(paths::PrefPath(), "frames.dxfs");
+	FILE *out = OpenFile(path.c_str(), "wb");
+	if (out == nullptr) {
+		LogError("Failed to open {} for writing", path);
+		return false;
 	}
+	FrameCapture = std::make_unique<FrameCaptureState>();
+	FrameCapture->out = out;
+	FrameCapture->path = std::move(path);
+	FrameCapture->width = width;
+	FrameCapture->height = height;
+	FrameCapture->thread = SdlThread { FrameCaptureWorker };
+	Log("Capturing frames to {}", FrameCapture->path);
 	return true;
 }
 
+void CloseFrameCapture()
+{
+	if (!FrameCapture)
+		return;
+	{
+		std::lock_guard<SdlMutex> lock(FrameCapture->mutex);
+		FrameCapture->stopRequested = true;
+	}
+	FrameCapture->frameQueued.notify_one();
+	FrameCapture->thread.join();
+	std::fclose(FrameCapture->out);
+	Log("Frame capture saved at {}", FrameCapture->path);
+	FrameCapture = nullptr;
+}
+
 FILE *CaptureFile(std::string *dstPath)
 {
 	const std::time_t tt = std::time(nullptr);
@@ -166,33 +206,33 @@ void RedPalette()
 
 void CaptureScreen()
 {
-	SDL_Color palette[256];
 	std::string fileName;
-	bool success;
 
+	// The file is created right away so that overlapping captures never pick the same name.
 	FILE *outStream = CaptureFile(&fileName);
 	if (outStream == nullptr)
 		return;
 	DrawAndBlit();
-	PaletteGetEntries(256, palette);
-	RedPalette();
 
 	const Surface &buf = GlobalBackBuffer();
-	success = CaptureHdr(buf.w(), buf.h(), outStream);
-	if (success) {
-		success = CapturePix(buf, outStream);
+	CaptureJob job { outStream, std::move(fileName), OwnedSurface { buf.w(), buf.h() }, {} };
+	job.pixels.BlitFrom(buf, MakeSdlRect(0, 0, buf.w(), buf.h()), { 0, 0 });
+	PaletteGetEntries(256, job.palette.data());
+	const std::array<SDL_Color, 256> palette = job.palette;
+
+	bool startWorker;
+	{
+		std::lock_guard<SdlMutex> lock(CaptureMutex);
+		CaptureQueue.push_back(std::move(job));
+		startWorker = !CaptureWorkerRunning;
+		CaptureWorkerRunning = true;
 	}
-	if (success) {
-		success = CapturePal(palette, outStream);
+	if (startWorker) {
+		CaptureThread.join(); // The previous worker has already run out of work
+		CaptureThread = SdlThread { CaptureWorker };
 	}
-	std::fclose(outStream);
 
-	if (!success) {
-		Log("Failed to save screenshot at {}", fileName);
-		RemoveFile(fileName.c_str());
-	} else {
-		Log("Screenshot saved at {}", fileName);
-	}
+	RedPalette();
 	SDL_Delay(300);
 	for (int i = 0; i < 256; i++) {
 		system_palette[i] = palette[i];
@@ -201,4 +241,59 @@ void CaptureScreen()
 	RedrawEverything();
 }
 
+void FinishScreenCaptures()
+{
+	CaptureThread.join();
+	CloseFrameCapture();
+	FrameCaptureInterval = 0;
+}
+
+void StartFrameCapture(int interval)
+{
+	FrameCaptureInterval = interval;
+	FrameCaptureCount = 0;
+}
+
+void CaptureFrame(const Surface &out)
+{
+	if (FrameCaptureInterval <= 0)
+		return;
+	const uint32_t number = FrameCaptureCount++;
+	if (number % FrameCaptureInterval != 0)
+		return;
+
+	if (!FrameCapture && !OpenFrameCapture(out.w(), out.h())) {
+		FrameCaptureInterval = 0;
+		return;
+	}
+	FrameCaptureState &state = *FrameCapture;
+	if (out.w() != state.width || out.h() != state.height) {
+		LogError("Frame capture stopped, the resolution changed to {}x{}", out.w(), out.h());
+		CloseFrameCapture();
+		FrameCaptureInterval = 0;
+		return;
+	}
+
+	CapturedFrame frame { number, nullptr, {} };
+	{
+		std::lock_guard<SdlMutex> lock(state.mutex);
+		if (!state.freeBuffers.empty()) {
+			frame.pixels = std::move(state.freeBuffers.back());
+			state.freeBuffers.pop_back();
+		}
+	}
+	if (frame.pixels == nullptr)
+		frame.pixels = std::make_unique<uint8_t[]>(static_cast<size_t>(state.width) * state.height);
+	for (int y = 0; y < state.height; y++)
+		memcpy(&frame.pixels[static_cast<size_t>(y) * state.width], out.at(0, y), state.width);
+	PaletteGetEntries(256, frame.palette.data());
+
+	{
+		std::unique_lock<SdlMutex> lock(state.mutex);
+		state.frameTaken.wait(lock, [&state] { return state.queue.size() < MaxQueuedFrames; });
+		state.queue.push_back(std::move(frame));
+	}
+	state.frameQueued.notify_one();
+}
+
 } // namespace devilution
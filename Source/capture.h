@@ -1,15 +1,36 @@
 /**
  * @file capture.h
  *
- * Interface of the screenshot function.
+ * Interface of the screenshot and frame capture functions.
  */
 #pragma once
 
+#include "engine/surface.hpp"
+
 namespace devilution {
 
 /**
  * @brief Save the current screen to a screen??.pcx (00-99) in file if available, then make the screen red for 200ms.
+ *
+ * The screen is copied right away, encoding and writing the file happens on a background thread.
  */
 void CaptureScreen();
 
+/**
+ * @brief Waits until all screenshots and captured frames have been written.
+ */
+void FinishScreenCaptures();
+
+/**
+ * @brief Records every `interval`-th frame presented from here on to frames.dxfs, see utils/frame_stream.hpp.
+ *
+ * Frames are encoded on a background thread. When it falls behind the game waits for it, so no frame is ever dropped.
+ */
+void StartFrameCapture(int interval);
+
+/**
+ * @brief Queues the finished back buffer for the frame capture, if one is running and the frame is due.
+ */
+void CaptureFrame(const Surface &out);
+
 } // namespace devilution
@@ -491,6 +491,33 @@ std::string TextCmdInspect(const std::string_view parameter)
 	return ret;
 }
 
+std::string TextCmdStashFind(const std::string_view parameter)
+{
+	std::string ret;
+	if (parameter.empty()) {
+		ClearStashSearch();
+		StrAppend(ret, _("Stopped highlighting stash items."));
+		return ret;
+	}
+
+	StashSearchQuery query;
+	query.text = parameter;
+	const StashSearchQuery *activeSearch = GetStashSearch();
+	if (activeSearch != nullptr && *activeSearch == query) {
+		if (!JumpToNextStashSearchMatch())
+			StrAppend(ret, _("No other stash page has matching items."));
+		return ret;
+	}
+
+	const size_t matchCount = SetStashSearch(query);
+	if (matchCount == 0) {
+		StrAppend(ret, _("No stash items found with such a name"));
+		return ret;
+	}
+	StrAppend(ret, fmt::format(fmt::runtime(ngettext("Found {:d} stash item, repeat the command to go to the next page with matches.", "Found {:d} stash items, repeat the command to go to the next page with matches.", static_cast<int>(matchCount))), matchCount));
+	return ret;
+}
+
 bool IsQuestEnabled(const Quest &quest)
 {
 	switch (quest._qidx) {
@@ -556,6 +583,7 @@ std::vector<TextCmdItem> TextCmdList = {
 	{ "/arenapot", N_("Gives Arena Potions."), N_("<number>"), &TextCmdArenaPot },
 	{ "/inspect", N_("Inspects stats and equipment of another player."), N_("<player name>"), &TextCmdInspect },
 	{ "/seedinfo", N_("Show seed infos for current level."), "", &TextCmdLevelSeed },
+	{ "/stashfind", N_("Highlights stash items whose name contains the text, or stops highlighting without a text."), N_("[text]"), &TextCmdStashFind },
 };
 
 bool CheckTextCommand(const std::string_view text)
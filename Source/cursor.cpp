@@ -20,6 +20,7 @@
 #include "engine/load_cel.hpp"
 #include "engine/point.hpp"
 #include "engine/points_in_rectangle_range.hpp"
+#include "engine/render/clx_hit_mask.hpp"
 #include "engine/render/clx_render.hpp"
 #include "engine/trn.hpp"
 #include "hwcursor.hpp"
@@ -325,7 +326,7 @@ bool TrySelectPixelBased(Point tile)
 		Point pointInSprite = Point { 0, 0 } + (MousePosition - spriteCoords.position);
 		if (*sgOptions.Graphics.zoom)
 			pointInSprite /= 2;
-		return IsPointWithinClx(pointInSprite, sprite);
+		return IsPointWithinClxCached(pointInSprite, sprite);
 	};
 
 	auto convertFromRenderingToWorldTile = [](Point renderingPoint) {
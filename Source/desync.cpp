@@ -0,0 +1,346 @@
+/**
+ * @file desync.cpp
+ *
+ * Implementation of the game state hashing used to detect desyncs between peers and demo playback.
+ */
+#include "desync.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <optional>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "items.h"
+#include "levels/gendung.h"
+#include "missiles.h"
+#include "monster.h"
+#include "msg.h"
+#include "multi.h"
+#include "objects.h"
+#include "options.h"
+#include "player.h"
+#include "utils/file_util.h"
+#include "utils/log.hpp"
+#include "utils/paths.h"
+#include "utils/str_cat.hpp"
+
+namespace devilution {
+
+namespace {
+
+/** @brief Number of our own hashes that are kept around for peers that are behind. */
+constexpr size_t HistorySize = 16;
+
+/**
+ * @brief 32-bit FNV-1a, fed with the fields one at a time so padding and pointers never end up in the hash.
+ */
+class StateHasher {
+public:
+	template <typename T>
+	void Add(T value)
+	{
+		uint32_t v = static_cast<uint32_t>(value);
+		for (int i = 0; i < 4; i++) {
+			hash_ = (hash_ ^ (v & 0xFF)) * 16777619;
+			v >>= 8;
+		}
+	}
+
+	template <typename CoordT>
+	void Add(PointOf<CoordT> point)
+	{
+		Add(point.x);
+		Add(point.y);
+	}
+
+	[[nodiscard]] uint32_t value() const
+	{
+		return hash_;
+	}
+
+private:
+	uint32_t hash_ = 2166136261;
+};
+
+/**
+ * @brief Combines the entity hashes of one category and optionally keeps them for a dump.
+ */
+class CategoryHasher {
+public:
+	CategoryHasher(GameStateCategory category, std::vector<GameStateEntityHash> *entities)
+	    : category_(category)
+	    , entities_(entities)
+	{
+	}
+
+	void Add(size_t id, const StateHasher &entity)
+	{
+		hasher_.Add(id);
+		hasher_.Add(entity.value());
+		if (entities_ != nullptr)
+			entities_->push_back({ category_, static_cast<uint16_t>(id), entity.value() });
+	}
+
+	[[nodiscard]] uint32_t value() const
+	{
+		return hasher_.value();
+	}
+
+private:
+	GameStateCategory category_;
+	std::vector<GameStateEntityHash> *entities_;
+	StateHasher hasher_;
+};
+
+uint32_t HashPlayers(std::vector<GameStateEntityHash> *entities)
+{
+	CategoryHasher category(GameStateCategory::Players, entities);
+	for (const Player &player : Players) {
+		if (!player.plractive || player._pLvlChanging || !player.isOnActiveLevel())
+			continue;
+		StateHasher hasher;
+		hasher.Add(player.position.tile);
+		hasher.Add(player.position.future);
+		hasher.Add(player._pmode);
+		hasher.Add(player._pdir);
+		hasher.Add(player._pHitPoints);
+		hasher.Add(player._pMana);
+		hasher.Add(player._pExperience);
+		category.Add(player.getId(), hasher);
+	}
+	return category.value();
+}
+
+uint32_t HashMonsters(std::vector<GameStateEntityHash> *entities)
+{
+	CategoryHasher category(GameStateCategory::Monsters, entities);
+	for (size_t i = 0; i < ActiveMonsterCount; i++) {
+		const int id = ActiveMonsters[i];
+		const Monster &monster = Monsters[id];
+		StateHasher hasher;
+		hasher.Add(monster.position.tile);
+		hasher.Add(monster.position.future);
+		hasher.Add(monster.mode);
+		hasher.Add(monster.direction);
+		hasher.Add(monster.hitPoints);
+		hasher.Add(monster.enemy);
+		hasher.Add(monster.flags);
+		hasher.Add(monster.aiSeed);
+		hasher.Add(monster.rndItemSeed);
+		category.Add(id, hasher);
+	}
+	return category.value();
+}
+
+uint32_t HashMissiles(std::vector<GameStateEntityHash> *entities)
+{
+	CategoryHasher category(GameStateCategory::Missiles, entities);
+	size_t id = 0;
+	for (const Missile &missile : Missiles) {
+		StateHasher hasher;
+		hasher.Add(missile._mitype);
+		hasher.Add(missile.position.tile);
+		hasher.Add(missile._mirange);
+		hasher.Add(missile._misource);
+		hasher.Add(missile._midam);
+		category.Add(id++, hasher);
+	}
+	return category.value();
+}
+
+uint32_t HashItems(std::vector<GameStateEntityHash> *entities)
+{
+	CategoryHasher category(GameStateCategory::Items, entities);
+	for (uint8_t i = 0; i < ActiveItemCount; i++) {
+		const int id = ActiveItems[i];
+		const Item &item = Items[id];
+		StateHasher hasher;
+		hasher.Add(item.position);
+		hasher.Add(item.IDidx);
+		hasher.Add(item._iSeed);
+		hasher.Add(item._iCreateInfo);
+		category.Add(id, hasher);
+	}
+	return category.value();
+}
+
+uint32_t HashObjects(std::vector<GameStateEntityHash> *entities)
+{
+	CategoryHasher category(GameStateCategory::Objects, entities);
+	for (int i = 0; i < ActiveObjectCount; i++) {
+		const int id = ActiveObjects[i];
+		const Object &object = Objects[id];
+		StateHasher hasher;
+		hasher.Add(object._otype);
+		hasher.Add(object.position);
+		hasher.Add(object._oSelFlag);
+		hasher.Add(object._oBreak);
+		hasher.Add(object._oSolidFlag);
+		hasher.Add(object._oAnimFrame);
+		category.Add(id, hasher);
+	}
+	return category.value();
+}
+
+std::string_view CategoryName(GameStateCategory category)
+{
+	switch (category) {
+	case GameStateCategory::Players:
+		return "players";
+	case GameStateCategory::Monsters:
+		return "monsters";
+	case GameStateCategory::Missiles:
+		return "missiles";
+	case GameStateCategory::Items:
+		return "items";
+	case GameStateCategory::Objects:
+		return "objects";
+	}
+	return "unknown";
+}
+
+struct HashRecord {
+	uint32_t tick;
+	uint8_t level;
+	bool isSetLevel;
+	GameStateHash hash;
+};
+
+struct LocalHashRecord : HashRecord {
+	/** @brief Only filled in when `Network.DesyncDump` is enabled. */
+	std::vector<GameStateEntityHash> entities;
+};
+
+std::array<std::optional<LocalHashRecord>, HistorySize> LocalHashes;
+/** @brief Hashes of players that are ahead of us, waiting for our own hash of the same tick. */
+std::array<std::vector<HashRecord>, MAX_PLRS> PendingPeerHashes;
+/** @brief Only the first divergence with each player is reported, everything after it is a consequence. */
+std::array<std::optional<uint32_t>, MAX_PLRS> FirstDesyncTicks;
+
+uint8_t GetActiveLevelId()
+{
+	return setlevel ? static_cast<uint8_t>(setlvlnum) : currlevel;
+}
+
+void DumpEntityHashes(const LocalHashRecord &record)
+{
+	const std::string path = StrCat(paths::PrefPath(), "desync_", record.tick, "_p", static_cast<int>(MyPlayerId), ".txt");
+	FILE *file = OpenFile(path.c_str(), "w");
+	if (file == nullptr) {
+		LogError("Failed to open {} for writing", path);
+		return;
+	}
+	for (const GameStateEntityHash &entity : record.entities) {
+		const std::string line = fmt::format("{} {} {:08x}\n", CategoryName(entity.category), entity.id, entity.hash);
+		std::fputs(line.c_str(), file);
+	}
+	std::fclose(file);
+	Log("Desync: wrote entity hashes to {}", path);
+}
+
+void CompareWithPeer(const Player &player, const LocalHashRecord &local, const HashRecord &remote)
+{
+	if (local.level != remote.level || local.isSetLevel != remote.isSetLevel)
+		return;
+	if (local.hash == remote.hash)
+		return;
+	const size_t playerId = player.getId();
+	if (FirstDesyncTicks[playerId])
+		return;
+	FirstDesyncTicks[playerId] = local.tick;
+	LogError("Desync: game state differs from player {} ({}) at tick {}, {} differ",
+	    playerId, player._pName, local.tick, DescribeGameStateDifference(local.hash, remote.hash));
+	if (*sgOptions.Network.desyncDump)
+		DumpEntityHashes(local);
+}
+
+} // namespace
+
+GameStateHash ComputeGameStateHash(std::vector<GameStateEntityHash> *entities)
+{
+	GameStateHash result;
+	result.categories[static_cast<size_t>(GameStateCategory::Players)] = HashPlayers(entities);
+	result.categories[static_cast<size_t>(GameStateCategory::Monsters)] = HashMonsters(entities);
+	result.categories[static_cast<size_t>(GameStateCategory::Missiles)] = HashMissiles(entities);
+	result.categories[static_cast<size_t>(GameStateCategory::Items)] = HashItems(entities);
+	result.categories[static_cast<size_t>(GameStateCategory::Objects)] = HashObjects(entities);
+	return result;
+}
+
+std::string DescribeGameStateDifference(const GameStateHash &expected, const GameStateHash &actual)
+{
+	std::string result;
+	for (size_t i = 0; i < NumGameStateCategories; i++) {
+		if (expected.categories[i] == actual.categories[i])
+			continue;
+		if (!result.empty())
+			result.append(", ");
+		result.append(CategoryName(static_cast<GameStateCategory>(i)));
+	}
+	return result;
+}
+
+void DesyncCheckGameTick(uint32_t tick)
+{
+	const uint16_t interval = *sgOptions.Network.desyncCheckInterval;
+	if (!gbIsMultiplayer || interval == 0 || tick % interval != 0)
+		return;
+
+	std::optional<LocalHashRecord> &record = LocalHashes[(tick / interval) % HistorySize];
+	record.emplace();
+	record->tick = tick;
+	record->level = GetActiveLevelId();
+	record->isSetLevel = setlevel;
+	record->hash = ComputeGameStateHash(*sgOptions.Network.desyncDump ? &record->entities : nullptr);
+	NetSendCmdStateHash(tick, record->level, record->isSetLevel, record->hash);
+
+	for (const Player &player : Players) {
+		std::vector<HashRecord> &pending = PendingPeerHashes[player.getId()];
+		for (const HashRecord &remote : pending) {
+			if (remote.tick == tick)
+				CompareWithPeer(player, *record, remote);
+		}
+		pending.erase(std::remove_if(pending.begin(), pending.end(), [tick](const HashRecord &remote) { return remote.tick <= tick; }), pending.end());
+	}
+}
+
+void DesyncCheckReceive(const Player &player, uint32_t tick, uint8_t level, bool isSetLevel, const GameStateHash &hash)
+{
+	if (&player == MyPlayer)
+		return;
+
+	const HashRecord remote { tick, level, isSetLevel, hash };
+	uint32_t latestTick = 0;
+	for (const std::optional<LocalHashRecord> &local : LocalHashes) {
+		if (!local)
+			continue;
+		if (local->tick == tick) {
+			CompareWithPeer(player, *local, remote);
+			return;
+		}
+		latestTick = std::max(latestTick, local->tick);
+	}
+	if (tick < latestTick)
+		return; // Too old, we no longer have a hash for it
+
+	std::vector<HashRecord> &pending = PendingPeerHashes[player.getId()];
+	if (pending.size() >= HistorySize)
+		pending.erase(pending.begin());
+	pending.push_back(remote);
+}
+
+void DesyncCheckReset()
+{
+	LocalHashes = {};
+	PendingPeerHashes = {};
+	FirstDesyncTicks = {};
+}
+
+std::optional<uint32_t> GetFirstDesyncTick(const Player &player)
+{
+	return FirstDesyncTicks[player.getId()];
+}
+
+} // namespace devilution
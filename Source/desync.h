@@ -0,0 +1,87 @@
+/**
+ * @file desync.h
+ *
+ * Interface of the game state hashing used to detect desyncs between peers and demo playback.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace devilution {
+
+struct Player;
+
+/**
+ * @brief Parts of the game state that are hashed separately.
+ *
+ * The global RNG is left out, local effects like the voice lines of our own player advance it on one machine only.
+ * Seeds owned by an entity, like the AI seed of a monster, are hashed with the entity instead.
+ */
+enum class GameStateCategory : uint8_t {
+	Players,
+	Monsters,
+	Missiles,
+	Items,
+	Objects,
+
+	LAST = Objects
+};
+
+constexpr size_t NumGameStateCategories = static_cast<size_t>(GameStateCategory::LAST) + 1;
+
+/**
+ * @brief Hashes of the parts of the simulation that must come out the same for everyone simulating the level.
+ */
+struct GameStateHash {
+	std::array<uint32_t, NumGameStateCategories> categories;
+
+	bool operator==(const GameStateHash &other) const = default;
+};
+
+/**
+ * @brief Hash of a single entity, used to narrow a divergence down to the entities that differ.
+ */
+struct GameStateEntityHash {
+	GameStateCategory category;
+	/** @brief Index of the entity in its global array, missiles use their position in the list. */
+	uint16_t id;
+	uint32_t hash;
+};
+
+/**
+ * @brief Hashes the simulation state of the active level.
+ * @param entities If not null, receives the hashes of the individual entities
+ */
+GameStateHash ComputeGameStateHash(std::vector<GameStateEntityHash> *entities = nullptr);
+
+/**
+ * @brief Lists the names of the categories that differ between two hashes.
+ */
+std::string DescribeGameStateDifference(const GameStateHash &expected, const GameStateHash &actual);
+
+/**
+ * @brief Hashes the game state every `Network.DesyncCheckInterval` ticks and shares it with the other players.
+ * @param tick Game tick as agreed on by all players
+ */
+void DesyncCheckGameTick(uint32_t tick);
+
+/**
+ * @brief Compares the hash another player computed for a game tick with our own.
+ */
+void DesyncCheckReceive(const Player &player, uint32_t tick, uint8_t level, bool isSetLevel, const GameStateHash &hash);
+
+/**
+ * @brief Forgets all hashes, called when starting a game or changing levels.
+ */
+void DesyncCheckReset();
+
+/**
+ * @brief Returns the first tick at which our game state was found to differ from the given player's, if any.
+ */
+std::optional<uint32_t> GetFirstDesyncTick(const Player &player);
+
+} // namespace devilution
@@ -20,6 +20,7 @@
 #ifdef _DEBUG
 #include "debug.h"
 #endif
+#include "desync.h"
 #include "DiabloUI/diabloui.h"
 #include "controls/plrctrls.h"
 #include "controls/remap_keyboard.h"
@@ -36,6 +37,7 @@
 #include "engine/load_cel.hpp"
 #include "engine/load_file.hpp"
 #include "engine/random.hpp"
+#include "engine/render/clx_hit_mask.hpp"
 #include "engine/sound.h"
 #include "gamemenu.h"
 #include "gmenu.h"
@@ -204,6 +206,7 @@ void FreeGame()
 	FreeDebugGFX();
 #endif
 	FreeGameMem();
+	LevelArena.release();
 	stream_stop();
 	music_stop();
 }
@@ -955,6 +958,7 @@ void PrintHelpOption(std::string_view flags, std::string_view description)
 	PrintHelpOption("-n", _(/* TRANSLATORS: Commandline Option */ "Skip startup videos"));
 	PrintHelpOption("-f", _(/* TRANSLATORS: Commandline Option */ "Display frames per second"));
 	PrintHelpOption("--verbose", _(/* TRANSLATORS: Commandline Option */ "Enable verbose logging"));
+	PrintHelpOption("--capture-frames <#>", _(/* TRANSLATORS: Commandline Option */ "Save every nth rendered frame to frames.dxfs"));
 #ifndef DISABLE_DEMOMODE
 	PrintHelpOption("--record <#>", _(/* TRANSLATORS: Commandline Option */ "Record a demo file"));
 	PrintHelpOption("--demo <#>", _(/* TRANSLATORS: Commandline Option */ "Play a demo file"));
@@ -1077,6 +1081,17 @@ void DiabloParseFlags(int argc, char **argv)
 			gbShowIntro = false;
 		} else if (arg == "-f") {
 			EnableFrameCount();
+		} else if (arg == "--capture-frames") {
+			if (i + 1 == argc) {
+				PrintFlagRequiresArgument("--capture-frames");
+				diablo_quit(64);
+			}
+			ParseIntResult<int> parsedParam = ParseInt<int>(argv[++i]);
+			if (!parsedParam.has_value() || parsedParam.value() < 1) {
+				PrintFlagMessage("--capture-frames", " must be a positive number");
+				diablo_quit(64);
+			}
+			StartFrameCapture(parsedParam.value());
 		} else if (arg == "--spawn") {
 			forceSpawn = true;
 		} else if (arg == "--diablo") {
@@ -1251,6 +1266,7 @@ void DiabloSplash()
 
 void DiabloDeinit()
 {
+	FinishScreenCaptures();
 	FreeItemGFX();
 
 	LuaShutdown();
@@ -1278,42 +1294,42 @@ void LoadLvlGFX()
 	switch (leveltype) {
 	case DTYPE_TOWN:
 		if (gbIsHellfire) {
-			pDungeonCels = LoadFileInMem("nlevels\\towndata\\town.cel");
-			pMegaTiles = LoadFileInMem<MegaTile>("nlevels\\towndata\\town.til");
+			pDungeonCels = LoadFileInMem(LevelArena, "nlevels\\towndata\\town.cel");
+			pMegaTiles = LoadFileInMem<MegaTile>(LevelArena, "nlevels\\towndata\\town.til");
 		} else {
-			pDungeonCels = LoadFileInMem("levels\\towndata\\town.cel");
-			pMegaTiles = LoadFileInMem<MegaTile>("levels\\towndata\\town.til");
+			pDungeonCels = LoadFileInMem(LevelArena, "levels\\towndata\\town.cel");
+			pMegaTiles = LoadFileInMem<MegaTile>(LevelArena, "levels\\towndata\\town.til");
 		}
 		pSpecialCels = LoadCel("levels\\towndata\\towns", SpecialCelWidth);
 		break;
 	case DTYPE_CATHEDRAL:
-		pDungeonCels = LoadFileInMem("levels\\l1data\\l1.cel");
-		pMegaTiles = LoadFileInMem<MegaTile>("levels\\l1data\\l1.til");
+		pDungeonCels = LoadFileInMem(LevelArena, "levels\\l1data\\l1.cel");
+		pMegaTiles = LoadFileInMem<MegaTile>(LevelArena, "levels\\l1data\\l1.til");
 		pSpecialCels = LoadCel("levels\\l1data\\l1s", SpecialCelWidth);
 		break;
 	case DTYPE_CATACOMBS:
-		pDungeonCels = LoadFileInMem("levels\\l2data\\l2.cel");
-		pMegaTiles = LoadFileInMem<MegaTile>("levels\\l2data\\l2.til");
+		pDungeonCels = LoadFileInMem(LevelArena, "levels\\l2data\\l2.cel");
+		pMegaTiles = LoadFileInMem<MegaTile>(LevelArena, "levels\\l2data\\l2.til");
 		pSpecialCels = LoadCel("levels\\l2data\\l2s", SpecialCelWidth);
 		break;
 	case DTYPE_CAVES:
-		pDungeonCels = LoadFileInMem("levels\\l3data\\l3.cel");
-		pMegaTiles = LoadFileInMem<MegaTile>("levels\\l3data\\l3.til");
+		pDungeonCels = LoadFileInMem(LevelArena, "levels\\l3data\\l3.cel");
+		pMegaTiles = LoadFileInMem<MegaTile>(LevelArena, "levels\\l3data\\l3.til");
 		pSpecialCels = LoadCel("levels\\l1data\\l1s", SpecialCelWidth);
 		break;
 	case DTYPE_HELL:
-		pDungeonCels = LoadFileInMem("levels\\l4data\\l4.cel");
-		pMegaTiles = LoadFileInMem<MegaTile>("levels\\l4data\\l4.til");
+		pDungeonCels = LoadFileInMem(LevelArena, "levels\\l4data\\l4.cel");
+		pMegaTiles = LoadFileInMem<MegaTile>(LevelArena, "levels\\l4data\\l4.til");
 		pSpecialCels = LoadCel("levels\\l2data\\l2s", SpecialCelWidth);
 		break;
 	case DTYPE_NEST:
-		pDungeonCels = LoadFileInMem("nlevels\\l6data\\l6.cel");
-		pMegaTiles = LoadFileInMem<MegaTile>("nlevels\\l6data\\l6.til");
+		pDungeonCels = LoadFileInMem(LevelArena, "nlevels\\l6data\\l6.cel");
+		pMegaTiles = LoadFileInMem<MegaTile>(LevelArena, "nlevels\\l6data\\l6.til");
 		pSpecialCels = LoadCel("levels\\l1data\\l1s", SpecialCelWidth);
 		break;
 	case DTYPE_CRYPT:
-		pDungeonCels = LoadFileInMem("nlevels\\l5data\\l5.cel");
-		pMegaTiles = LoadFileInMem<MegaTile>("nlevels\\l5data\\l5.til");
+		pDungeonCels = LoadFileInMem(LevelArena, "nlevels\\l5data\\l5.cel");
+		pMegaTiles = LoadFileInMem<MegaTile>(LevelArena, "nlevels\\l5data\\l5.til");
 		pSpecialCels = LoadCel("nlevels\\l5data\\l5s", SpecialCelWidth);
 		break;
 	default:
@@ -2447,6 +2463,8 @@ void SetCursorPos(Point position)
 
 void FreeGameMem()
 {
+	ClearClxHitMaskCache();
+
 	pDungeonCels = nullptr;
 	pMegaTiles = nullptr;
 	pSpecialCels = std::nullopt;
@@ -2460,6 +2478,12 @@ void FreeGameMem()
 	DeactivateVirtualGamepad();
 	FreeVirtualGamepadGFX();
 #endif
+
+	const ArenaStats arenaStats = LevelArena.stats();
+	LogVerbose("Level arena: {:>5d} KiB used, {:>5d} KiB peak, {:>5d} KiB wasted, {} allocations in {} chunks",
+	    arenaStats.usedBytes / 1024, arenaStats.peakUsedBytes / 1024, arenaStats.wastedBytes / 1024,
+	    arenaStats.numAllocations, arenaStats.numChunks);
+	LevelArena.reset();
 }
 
 bool StartGame(bool bNewGame, bool bSinglePlayer)
@@ -2609,6 +2633,7 @@ bool TryIconCurs()
 		else if (pcursstashitem != StashStruct::EmptyCell) {
 			Item &item = Stash.stashList[pcursstashitem];
 			item._iIdentified = true;
+			Stash.ItemChanged(pcursstashitem);
 		}
 		NewCursor(CURSOR_HAND);
 		return true;
@@ -2620,6 +2645,7 @@ bool TryIconCurs()
 		else if (pcursstashitem != StashStruct::EmptyCell) {
 			Item &item = Stash.stashList[pcursstashitem];
 			RepairItem(item, myPlayer.getCharacterLevel());
+			Stash.ItemChanged(pcursstashitem);
 		}
 		NewCursor(CURSOR_HAND);
 		return true;
@@ -2631,6 +2657,7 @@ bool TryIconCurs()
 		else if (pcursstashitem != StashStruct::EmptyCell) {
 			Item &item = Stash.stashList[pcursstashitem];
 			RechargeItem(item, myPlayer);
+			Stash.ItemChanged(pcursstashitem);
 		}
 		NewCursor(CURSOR_HAND);
 		return true;
@@ -2643,6 +2670,7 @@ bool TryIconCurs()
 		else if (pcursstashitem != StashStruct::EmptyCell) {
 			Item &item = Stash.stashList[pcursstashitem];
 			changeCursor = ApplyOilToItem(item, myPlayer);
+			Stash.ItemChanged(pcursstashitem);
 		}
 		if (changeCursor)
 			NewCursor(CURSOR_HAND);
@@ -3105,6 +3133,7 @@ void LoadGameLevel(bool firstflag, lvl_entry lvldir)
 		music_mute();
 	}
 
+	DesyncCheckReset();
 	CompleteProgress();
 
 	// Recalculate mouse selection of entities after level change/load
@@ -3127,6 +3156,7 @@ bool game_loop(bool bStartup)
 		TimeoutCursor(false);
 		GameLogic();
 		ClearLastSentPlayerCmd();
+		DesyncCheckGameTick(sgdwGameLoops);
 
 		if (!gbRunGame || !gbIsMultiplayer || demo::IsRunning() || demo::IsRecording() || !nthread_has_500ms_passed())
 			break;
@@ -0,0 +1,194 @@
+#include "engine/demo_file.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include <zlib.h>
+
+#include "utils/endian_stream.hpp"
+#include "utils/log.hpp"
+
+namespace devilution {
+
+namespace {
+
+constexpr uint8_t BlockTag = 'B';
+constexpr uint8_t IndexTag = 'I';
+constexpr std::array<char, 4> IndexMagic { 'D', 'M', 'O', 'I' };
+constexpr size_t KeyframeSize = 12;
+/** @brief Size of the index offset and the magic at the very end of the file. */
+constexpr long IndexTrailerSize = 8;
+
+} // namespace
+
+void DemoBlockWriter::StartBlock(uint32_t tick, uint32_t rngState)
+{
+	FlushBlock();
+	keyframe_ = DemoKeyframe { tick, rngState, 0 };
+}
+
+void DemoBlockWriter::Finish()
+{
+	FlushBlock();
+	keyframe_ = std::nullopt;
+
+	const auto indexOffset = static_cast<uint32_t>(std::ftell(out_));
+	devilution::WriteByte(out_, IndexTag);
+	devilution::WriteLE32(out_, static_cast<uint32_t>(index_.size()));
+	for (const DemoKeyframe &keyframe : index_) {
+		devilution::WriteLE32(out_, keyframe.tick);
+		devilution::WriteLE32(out_, keyframe.rngState);
+		devilution::WriteLE32(out_, keyframe.offset);
+	}
+	devilution::WriteLE32(out_, indexOffset);
+	LoggedFwrite(IndexMagic.data(), IndexMagic.size(), out_);
+	index_.clear();
+}
+
+void DemoBlockWriter::FlushBlock()
+{
+	if (!keyframe_)
+		return;
+
+	keyframe_->offset = static_cast<uint32_t>(std::ftell(out_));
+	index_.push_back(*keyframe_);
+	if (block_.size() > MaxDemoBlockSize)
+		LogError("Demo: block at tick {} is too large to be played back", keyframe_->tick);
+
+	const auto rawSize = static_cast<uLong>(block_.size());
+	uLongf storedSize = compressBound(rawSize);
+	std::vector<uint8_t> compressed(storedSize);
+	bool isCompressed = compress2(compressed.data(), &storedSize, block_.data(), rawSize, Z_BEST_SPEED) == Z_OK && storedSize < rawSize;
+	const uint8_t *data = isCompressed ? compressed.data() : block_.data();
+	if (!isCompressed)
+		storedSize = rawSize;
+
+	devilution::WriteByte(out_, BlockTag);
+	devilution::WriteLE32(out_, keyframe_->tick);
+	devilution::WriteLE32(out_, keyframe_->rngState);
+	devilution::WriteByte(out_, isCompressed ? 1 : 0);
+	devilution::WriteLE32(out_, static_cast<uint32_t>(rawSize));
+	devilution::WriteLE32(out_, static_cast<uint32_t>(storedSize));
+	if (storedSize != 0)
+		LoggedFwrite(data, storedSize, out_);
+	std::fflush(out_);
+
+	block_.clear();
+	keyframe_ = std::nullopt;
+}
+
+std::optional<DemoKeyframe> DemoBlockReader::SeekToTick(uint32_t tick)
+{
+	const std::optional<std::vector<DemoKeyframe>> index = ReadDemoIndex(in_);
+	if (!index || index->empty())
+		return std::nullopt;
+
+	auto it = std::upper_bound(index->begin(), index->end(), tick,
+	    [](uint32_t value, const DemoKeyframe &keyframe) { return value < keyframe.tick; });
+	if (it != index->begin())
+		--it;
+
+	if (std::fseek(in_, static_cast<long>(it->offset), SEEK_SET) != 0)
+		return std::nullopt;
+	block_.clear();
+	blockPos_ = 0;
+	eof_ = false;
+	pendingKeyframe_ = std::nullopt;
+	return *it;
+}
+
+const uint8_t *DemoBlockReader::Read(size_t size)
+{
+	// Messages never cross a block boundary, so a new block is only needed once the current one is used up.
+	while (blockPos_ == block_.size()) {
+		if (eof_ || !LoadNextBlock()) {
+			eof_ = true;
+			return nullptr;
+		}
+	}
+	if (blockPos_ + size > block_.size()) {
+		LogError("Demo: message crosses a block boundary");
+		eof_ = true;
+		return nullptr;
+	}
+	const uint8_t *data = &block_[blockPos_];
+	blockPos_ += size;
+	return data;
+}
+
+bool DemoBlockReader::LoadNextBlock()
+{
+	const uint8_t tag = devilution::ReadByte(in_);
+	if (std::feof(in_) != 0 || tag != BlockTag)
+		return false;
+
+	DemoKeyframe keyframe;
+	keyframe.offset = static_cast<uint32_t>(std::ftell(in_) - 1);
+	keyframe.tick = devilution::ReadLE32(in_);
+	keyframe.rngState = devilution::ReadLE32(in_);
+	const bool isCompressed = devilution::ReadByte(in_) != 0;
+	const uint32_t rawSize = devilution::ReadLE32(in_);
+	const uint32_t storedSize = devilution::ReadLE32(in_);
+	if (std::feof(in_) != 0)
+		return false;
+	// Compressed data is only stored when it is smaller than the raw data, otherwise the raw data is stored as is.
+	if (rawSize > MaxDemoBlockSize || (isCompressed ? storedSize >= rawSize : storedSize != rawSize)) {
+		LogError("Demo: invalid block size at tick {}", keyframe.tick);
+		return false;
+	}
+
+	std::vector<uint8_t> stored(storedSize);
+	if (storedSize != 0 && std::fread(stored.data(), storedSize, 1, in_) != 1) {
+		LogError("Demo: truncated block at tick {}", keyframe.tick);
+		return false;
+	}
+
+	if (isCompressed) {
+		block_.resize(rawSize);
+		uLongf destSize = rawSize;
+		if (uncompress(block_.data(), &destSize, stored.data(), storedSize) != Z_OK || destSize != rawSize) {
+			LogError("Demo: corrupt block at tick {}", keyframe.tick);
+			block_.clear();
+			return false;
+		}
+	} else {
+		block_ = std::move(stored);
+	}
+	blockPos_ = 0;
+	pendingKeyframe_ = keyframe;
+	return true;
+}
+
+std::optional<std::vector<DemoKeyframe>> ReadDemoIndex(FILE *in)
+{
+	const long position = std::ftell(in);
+	std::optional<std::vector<DemoKeyframe>> result;
+
+	if (std::fseek(in, -IndexTrailerSize, SEEK_END) == 0) {
+		const uint32_t indexOffset = devilution::ReadLE32(in);
+		std::array<char, 4> magic;
+		LoggedFread(magic.data(), magic.size(), in);
+		if (std::feof(in) == 0 && magic == IndexMagic && std::fseek(in, static_cast<long>(indexOffset), SEEK_SET) == 0
+		    && devilution::ReadByte(in) == IndexTag) {
+			const uint32_t count = devilution::ReadLE32(in);
+			const long end = static_cast<long>(indexOffset) + 5 + static_cast<long>(count) * static_cast<long>(KeyframeSize);
+			std::fseek(in, 0, SEEK_END);
+			if (end + IndexTrailerSize == std::ftell(in)) {
+				std::fseek(in, static_cast<long>(indexOffset) + 5, SEEK_SET);
+				std::vector<DemoKeyframe> keyframes(count);
+				for (DemoKeyframe &keyframe : keyframes) {
+					keyframe.tick = devilution::ReadLE32(in);
+					keyframe.rngState = devilution::ReadLE32(in);
+					keyframe.offset = devilution::ReadLE32(in);
+				}
+				result = std::move(keyframes);
+			}
+		}
+	}
+
+	std::clearerr(in);
+	std::fseek(in, position, SEEK_SET);
+	return result;
+}
+
+} // namespace devilution
@@ -0,0 +1,183 @@
+/**
+ * @file demo_file.hpp
+ *
+ * Block container used by demo files from version 4 on.
+ *
+ * After the demo header the file holds a sequence of blocks followed by an index:
+ *
+ *     block: 'B', LE32 tick, LE32 rngState, u8 compressed, LE32 rawSize, LE32 storedSize, data
+ *     index: 'I', LE32 count, count * (LE32 tick, LE32 rngState, LE32 offset), LE32 indexOffset, "DMOI"
+ *
+ * Every block but the first starts on a game tick, so playback can resume from the start of any block.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <vector>
+
+#include "utils/endian.hpp"
+
+namespace devilution {
+
+/**
+ * @brief Largest uncompressed block the reader accepts.
+ *
+ * Recording starts a new block every few hundred game ticks, so blocks stay far below this. Only a block that spans
+ * a very long pause gets anywhere near it, at one byte per rendered frame.
+ */
+constexpr uint32_t MaxDemoBlockSize = 16 * 1024 * 1024;
+
+/**
+ * @brief Marks the start of a block of demo messages.
+ */
+struct DemoKeyframe {
+	/** @brief Number of game ticks recorded before the block. */
+	uint32_t tick;
+	/** @brief State of the game RNG when the first game tick of the block was recorded. */
+	uint32_t rngState;
+	/** @brief Offset of the block from the start of the demo file. */
+	uint32_t offset;
+};
+
+/**
+ * @brief Collects demo messages and writes them to the file in compressed blocks.
+ *
+ * Each block is flushed to disk once it is complete, so a crash loses at most the block being recorded.
+ */
+class DemoBlockWriter {
+public:
+	/** @param out File positioned right after the demo header, must stay open until Finish is called */
+	explicit DemoBlockWriter(FILE *out)
+	    : out_(out)
+	{
+	}
+
+	/**
+	 * @brief Writes out the current block and starts a new one.
+	 * @param tick Number of game ticks recorded so far
+	 * @param rngState Current state of the game RNG
+	 */
+	void StartBlock(uint32_t tick, uint32_t rngState);
+
+	/** @brief Writes out the last block followed by the index. */
+	void Finish();
+
+	[[nodiscard]] size_t BlockSize() const
+	{
+		return block_.size();
+	}
+
+	/** @brief Tick of the keyframe that started the current block. */
+	[[nodiscard]] std::optional<uint32_t> BlockTick() const
+	{
+		if (!keyframe_)
+			return std::nullopt;
+		return keyframe_->tick;
+	}
+
+	void WriteByte(uint8_t val)
+	{
+		block_.push_back(val);
+	}
+
+	void WriteLE16(uint16_t val)
+	{
+		const size_t pos = block_.size();
+		block_.resize(pos + 2);
+		devilution::WriteLE16(&block_[pos], val);
+	}
+
+	void WriteLE32(uint32_t val)
+	{
+		const size_t pos = block_.size();
+		block_.resize(pos + 4);
+		devilution::WriteLE32(&block_[pos], val);
+	}
+
+private:
+	void FlushBlock();
+
+	FILE *out_;
+	std::vector<uint8_t> block_;
+	std::optional<DemoKeyframe> keyframe_;
+	std::vector<DemoKeyframe> index_;
+};
+
+/**
+ * @brief Reads demo messages back from the blocks written by DemoBlockWriter.
+ */
+class DemoBlockReader {
+public:
+	/** @param in File positioned at the first block, must outlive the reader */
+	explicit DemoBlockReader(FILE *in)
+	    : in_(in)
+	{
+	}
+
+	/** @brief Whether a read went past the last block. */
+	[[nodiscard]] bool eof() const
+	{
+		return eof_;
+	}
+
+	/**
+	 * @brief Returns the keyframe of the block that the last read started, once.
+	 */
+	std::optional<DemoKeyframe> TakeKeyframe()
+	{
+		std::optional<DemoKeyframe> keyframe = pendingKeyframe_;
+		pendingKeyframe_ = std::nullopt;
+		return keyframe;
+	}
+
+	/**
+	 * @brief Continues reading from the last block that starts at or before `tick`.
+	 * @return The keyframe of that block, or std::nullopt if the file has no usable index.
+	 */
+	std::optional<DemoKeyframe> SeekToTick(uint32_t tick);
+
+	template <typename T = uint8_t>
+	T ReadByte()
+	{
+		static_assert(sizeof(T) == 1, "invalid argument");
+		const uint8_t *data = Read(1);
+		return data != nullptr ? static_cast<T>(*data) : T {};
+	}
+
+	template <typename T = uint16_t>
+	T ReadLE16()
+	{
+		static_assert(sizeof(T) == 2, "invalid argument");
+		const uint8_t *data = Read(2);
+		return data != nullptr ? static_cast<T>(LoadLE16(data)) : T {};
+	}
+
+	template <typename T = uint32_t>
+	T ReadLE32()
+	{
+		static_assert(sizeof(T) == 4, "invalid argument");
+		const uint8_t *data = Read(4);
+		return data != nullptr ? static_cast<T>(LoadLE32(data)) : T {};
+	}
+
+private:
+	const uint8_t *Read(size_t size);
+	bool LoadNextBlock();
+
+	FILE *in_;
+	std::vector<uint8_t> block_;
+	size_t blockPos_ = 0;
+	bool eof_ = false;
+	std::optional<DemoKeyframe> pendingKeyframe_;
+};
+
+/**
+ * @brief Reads the block index from the end of a demo file, leaving the file position unchanged.
+ * @return The keyframes in file order, or std::nullopt if the file doesn't end with an index.
+ */
+std::optional<std::vector<DemoKeyframe>> ReadDemoIndex(FILE *in);
+
+} // namespace devilution
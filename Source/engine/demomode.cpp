@@ -12,7 +12,10 @@
 #endif
 
 #include "controls/plrctrls.h"
+#include "desync.h"
+#include "engine/demo_file.hpp"
 #include "engine/events.hpp"
+#include "engine/random.hpp"
 #include "gmenu.h"
 #include "menu.h"
 #include "nthread.h"
@@ -33,7 +36,22 @@ namespace devilution {
 
 namespace {
 
-constexpr uint8_t Version = 3;
+constexpr uint8_t Version = 5;
+
+/** @brief Messages are stored in compressed blocks with keyframes from this version on, see demo_file.hpp. */
+constexpr uint8_t FirstBlockVersion = 4;
+
+/** @brief Game state hashes are recorded from this version on. */
+constexpr uint8_t FirstStateHashVersion = 5;
+
+/** @brief Number of game ticks between recorded game state hashes. */
+constexpr int StateHashInterval = 20;
+
+/** @brief Number of game ticks after which recording starts a new block. */
+constexpr uint32_t KeyframeInterval = 600;
+
+/** @brief Size of the uncompressed messages after which recording starts a new block on the next game tick. */
+constexpr size_t MaxBlockSize = 64 * 1024;
 
 enum class LoadingStatus : uint8_t {
 	Success,
@@ -68,6 +86,7 @@ struct DemoMsg {
 	enum EventType : uint8_t {
 		GameTick = 0,
 		Rendering = 1,
+		StateHash = 2,
 
 		// Inputs:
 		MinEvent = 8,
@@ -100,8 +119,12 @@ struct DemoMsg {
 
 FILE *DemoFile;
 int DemoFileVersion;
+/** @brief Reads the messages of DemoFile for versions that store them in blocks. */
+std::optional<DemoBlockReader> DemoFileBlocks;
 int DemoNumber = -1;
 std::optional<DemoMsg> CurrentDemoMessage;
+/** @brief First game tick where the game state didn't match the hash recorded in the demo. */
+std::optional<int> DemoStateDivergedTick;
 
 bool Timedemo = false;
 int RecordNumber = -1;
@@ -136,6 +159,7 @@ struct {
 } DemoSettings;
 
 FILE *DemoRecording;
+std::optional<DemoBlockWriter> DemoRecordingBlocks;
 uint32_t DemoModeLastTick = 0;
 
 int LogicTick = 0;
@@ -457,6 +481,7 @@ void LogDemoMessage(const DemoMsg &dmsg)
 
 void CloseDemoFile()
 {
+	DemoFileBlocks = std::nullopt;
 	if (DemoFile != nullptr) {
 		std::fclose(DemoFile);
 		DemoFile = nullptr;
@@ -476,59 +501,132 @@ LoadingStatus OpenDemoFile(int demoNumber)
 		return LoadingStatus::UnsupportedVersion;
 	}
 	DemoNumber = demoNumber;
+	DemoStateDivergedTick = std::nullopt;
 
 	gSaveNumber = ReadLE32(DemoFile);
 	ReadSettings(DemoFile, DemoFileVersion);
 
+	if (DemoFileVersion >= FirstBlockVersion) {
+		DemoFileBlocks.emplace(DemoFile);
+		const std::optional<std::vector<DemoKeyframe>> index = ReadDemoIndex(DemoFile);
+		if (index && !index->empty())
+			LogVerbose("Demo: {} keyframes, last at tick {}", index->size(), index->back().tick);
+		else
+			LogVerbose("Demo: no index, the recording was not finished");
+	}
+
 	return LoadingStatus::Success;
 }
 
+template <typename T = uint8_t>
+T ReadDemoByte()
+{
+	return DemoFileBlocks ? DemoFileBlocks->ReadByte<T>() : ReadByte<T>(DemoFile);
+}
+
+template <typename T = uint16_t>
+T ReadDemoLE16()
+{
+	return DemoFileBlocks ? DemoFileBlocks->ReadLE16<T>() : ReadLE16<T>(DemoFile);
+}
+
+template <typename T = uint32_t>
+T ReadDemoLE32()
+{
+	return DemoFileBlocks ? DemoFileBlocks->ReadLE32<T>() : ReadLE32<T>(DemoFile);
+}
+
+bool IsDemoFileAtEnd()
+{
+	return DemoFileBlocks ? DemoFileBlocks->eof() : std::feof(DemoFile) != 0;
+}
+
+/**
+ * @brief Compares the game state with the keyframe recorded at the start of a block.
+ */
+void CheckDemoKeyframe(const DemoKeyframe &keyframe)
+{
+	const uint32_t rngState = GetLCGEngineState();
+	if (keyframe.tick != static_cast<uint32_t>(LogicTick) || keyframe.rngState != rngState) {
+		LogWarn("Demo: playback diverged from the recording, expected tick {} with RNG state {:08x} but got tick {} with RNG state {:08x}",
+		    keyframe.tick, keyframe.rngState, LogicTick, rngState);
+	}
+}
+
+/**
+ * @brief Compares the game state with the hash recorded at the same point of the demo.
+ */
+void CheckDemoStateHash()
+{
+	const uint32_t tick = ReadDemoLE32();
+	GameStateHash expected;
+	for (uint32_t &categoryHash : expected.categories)
+		categoryHash = ReadDemoLE32();
+
+	if (DemoStateDivergedTick)
+		return; // Everything after the first divergence is a consequence of it
+	const GameStateHash actual = ComputeGameStateHash();
+	if (tick == static_cast<uint32_t>(LogicTick) && actual == expected)
+		return;
+	DemoStateDivergedTick = LogicTick;
+	LogWarn("Demo: game state diverged from the recording at tick {} (recorded at tick {}), {} differ",
+	    LogicTick, tick, DescribeGameStateDifference(expected, actual));
+}
+
 std::optional<DemoMsg> ReadDemoMessage()
 {
-	const uint8_t typeNum = DemoFileVersion >= 2 ? ReadByte(DemoFile) : ReadLE32(DemoFile);
+	const uint8_t typeNum = DemoFileVersion >= 2 ? ReadDemoByte() : ReadDemoLE32();
 
-	if (std::feof(DemoFile) != 0) {
+	if (IsDemoFileAtEnd()) {
 		CloseDemoFile();
 		return std::nullopt;
 	}
 
+	if (DemoFileBlocks) {
+		if (std::optional<DemoKeyframe> keyframe = DemoFileBlocks->TakeKeyframe())
+			CheckDemoKeyframe(*keyframe);
+	}
+
 	// Events with the high bit 1 are Rendering events with the rest of the bits used
 	// to encode `progressToNextGameTick` inline.
 	if ((typeNum & 0b10000000) != 0) {
 		DemoModeLastTick = SDL_GetTicks();
 		return DemoMsg { DemoMsg::Rendering, static_cast<uint8_t>(typeNum & 0b01111111u), {} };
 	}
-	const uint8_t progressToNextGameTick = ReadByte(DemoFile);
+	const uint8_t progressToNextGameTick = ReadDemoByte();
 
 	switch (typeNum) {
+	case DemoMsg::StateHash:
+		CheckDemoStateHash();
+		return ReadDemoMessage();
 	case DemoMsg::GameTick:
 	case DemoMsg::Rendering:
 		DemoModeLastTick = SDL_GetTicks();
 		return DemoMsg { static_cast<DemoMsg::EventType>(typeNum), progressToNextGameTick, {} };
 	default: {
-		const uint8_t eventType = DemoFileVersion >= 2 ? typeNum : MapPreV2DemoMsgEventType(static_cast<uint16_t>(ReadLE32(DemoFile)));
+		const uint8_t eventType = DemoFileVersion >= 2 ? typeNum : MapPreV2DemoMsgEventType(static_cast<uint16_t>(ReadDemoLE32()));
 		DemoMsg result { static_cast<DemoMsg::EventType>(eventType), progressToNextGameTick, {} };
 		switch (eventType) {
 		case DemoMsg::MouseMotionEvent: {
-			result.motion.x = ReadLE16(DemoFile);
-			result.motion.y = ReadLE16(DemoFile);
+			result.motion.x = ReadDemoLE16();
+			result.motion.y = ReadDemoLE16();
 		} break;
 		case DemoMsg::MouseButtonDownEvent:
 		case DemoMsg::MouseButtonUpEvent: {
-			result.button.button = ReadByte(DemoFile);
-			result.button.x = ReadLE16(DemoFile);
-			result.button.y = ReadLE16(DemoFile);
-			result.button.mod = ReadLE16(DemoFile);
+			result.button.button = ReadDemoByte();
+			result.button.x = ReadDemoLE16();
+			result.button.y = ReadDemoLE16();
+			result.button.mod = ReadDemoLE16();
 		} break;
 		case DemoMsg::MouseWheelEvent: {
-			result.wheel.x = DemoFileVersion >= 2 ? ReadLE16<int16_t>(DemoFile) : static_cast<int16_t>(ReadLE32<int32_t>(DemoFile));
-			result.wheel.y = DemoFileVersion >= 2 ? ReadLE16<int16_t>(DemoFile) : static_cast<int16_t>(ReadLE32<int32_t>(DemoFile));
-			result.wheel.mod = ReadLE16(DemoFile);
+			result.wheel.x = DemoFileVersion >= 2 ? ReadDemoLE16<int16_t>() : static_cast<int16_t>(ReadDemoLE32<int32_t>());
+			result.wheel.y = DemoFileVersion >= 2 ? ReadDemoLE16<int16_t>() : static_cast<int16_t>(ReadDemoLE32<int32_t>());
+			result.wheel.mod = ReadDemoLE16();
 		} break;
 		case DemoMsg::KeyDownEvent:
 		case DemoMsg::KeyUpEvent: {
-			result.key.sym = static_cast<SDL_Keycode>(ReadLE32(DemoFile));
-			result.key.mod = static_cast<SDL_Keymod>(ReadLE16(DemoFile));
+			result.key.sym = static_cast<SDL_Keycode>(ReadDemoLE32());
+			result.key.mod = static_cast<SDL_Keymod>(ReadDemoLE16());
 		} break;
 		case DemoMsg::QuitEvent: // SDL_QUIT
 			break;
@@ -546,12 +644,32 @@ std::optional<DemoMsg> ReadDemoMessage()
 
 void WriteDemoMsgHeader(DemoMsg::EventType type)
 {
+	if (!DemoRecordingBlocks->BlockTick())
+		DemoRecordingBlocks->StartBlock(LogicTick, GetLCGEngineState());
+
 	if (type == DemoMsg::Rendering && ProgressToNextGameTick <= 127) {
-		WriteByte(DemoRecording, ProgressToNextGameTick | 0b10000000);
+		DemoRecordingBlocks->WriteByte(ProgressToNextGameTick | 0b10000000);
 		return;
 	}
-	WriteByte(DemoRecording, type);
-	WriteByte(DemoRecording, ProgressToNextGameTick);
+	DemoRecordingBlocks->WriteByte(type);
+	DemoRecordingBlocks->WriteByte(ProgressToNextGameTick);
+}
+
+/**
+ * @brief Whether the next game tick should start a new block, so that seeking never has to replay too far.
+ */
+bool IsDemoBlockDue()
+{
+	const std::optional<uint32_t> blockTick = DemoRecordingBlocks->BlockTick();
+	return blockTick && (static_cast<uint32_t>(LogicTick) - *blockTick >= KeyframeInterval || DemoRecordingBlocks->BlockSize() >= MaxBlockSize);
+}
+
+void WriteDemoStateHash()
+{
+	WriteDemoMsgHeader(DemoMsg::StateHash);
+	DemoRecordingBlocks->WriteLE32(LogicTick);
+	for (const uint32_t categoryHash : ComputeGameStateHash().categories)
+		DemoRecordingBlocks->WriteLE32(categoryHash);
 }
 
 } // namespace
@@ -728,6 +846,13 @@ bool FetchMessage(SDL_Event *event, uint16_t *modState)
 
 void RecordGameLoopResult(bool runGameLoop)
 {
+	if (!DemoRecordingBlocks)
+		return;
+
+	if (runGameLoop && IsDemoBlockDue())
+		DemoRecordingBlocks->StartBlock(LogicTick, GetLCGEngineState());
+	if (runGameLoop && LogicTick % StateHashInterval == 0)
+		WriteDemoStateHash();
 	WriteDemoMsgHeader(runGameLoop ? DemoMsg::GameTick : DemoMsg::Rendering);
 
 	if (runGameLoop && !IsRunning())
@@ -736,31 +861,31 @@ void RecordGameLoopResult(bool runGameLoop)
 
 void RecordMessage(const SDL_Event &event, uint16_t modState)
 {
-	if (!gbRunGame || DemoRecording == nullptr)
+	if (!gbRunGame || !DemoRecordingBlocks)
 		return;
 	if (CurrentEventHandler == DisableInputEventHandler)
 		return;
 	switch (event.type) {
 	case SDL_MOUSEMOTION:
 		WriteDemoMsgHeader(DemoMsg::MouseMotionEvent);
-		WriteLE16(DemoRecording, event.motion.x);
-		WriteLE16(DemoRecording, event.motion.y);
+		DemoRecordingBlocks->WriteLE16(event.motion.x);
+		DemoRecordingBlocks->WriteLE16(event.motion.y);
 		break;
 	case SDL_MOUSEBUTTONDOWN:
 	case SDL_MOUSEBUTTONUP:
 #ifdef USE_SDL1
 		if (event.button.button == SDL_BUTTON_WHEELUP || event.button.button == SDL_BUTTON_WHEELDOWN) {
 			WriteDemoMsgHeader(DemoMsg::MouseWheelEvent);
-			WriteLE16(DemoRecording, 0);
-			WriteLE16(DemoRecording, event.button.button == SDL_BUTTON_WHEELUP ? 1 : -1);
-			WriteLE16(DemoRecording, modState);
+			DemoRecordingBlocks->WriteLE16(0);
+			DemoRecordingBlocks->WriteLE16(event.button.button == SDL_BUTTON_WHEELUP ? 1 : -1);
+			DemoRecordingBlocks->WriteLE16(modState);
 		} else {
 #endif
 			WriteDemoMsgHeader(event.type == SDL_MOUSEBUTTONDOWN ? DemoMsg::MouseButtonDownEvent : DemoMsg::MouseButtonUpEvent);
-			WriteByte(DemoRecording, event.button.button);
-			WriteLE16(DemoRecording, event.button.x);
-			WriteLE16(DemoRecording, event.button.y);
-			WriteLE16(DemoRecording, modState);
+			DemoRecordingBlocks->WriteByte(event.button.button);
+			DemoRecordingBlocks->WriteLE16(event.button.x);
+			DemoRecordingBlocks->WriteLE16(event.button.y);
+			DemoRecordingBlocks->WriteLE16(modState);
 #ifdef USE_SDL1
 		}
 #endif
@@ -775,16 +900,16 @@ void RecordMessage(const SDL_Event &event, uint16_t modState)
 			app_fatal(fmt::format("Mouse wheel event x/y out of int16_t range. x={} y={}",
 			    event.wheel.x, event.wheel.y));
 		}
-		WriteLE16(DemoRecording, event.wheel.x);
-		WriteLE16(DemoRecording, event.wheel.y);
-		WriteLE16(DemoRecording, modState);
+		DemoRecordingBlocks->WriteLE16(event.wheel.x);
+		DemoRecordingBlocks->WriteLE16(event.wheel.y);
+		DemoRecordingBlocks->WriteLE16(modState);
 		break;
 #endif
 	case SDL_KEYDOWN:
 	case SDL_KEYUP:
 		WriteDemoMsgHeader(event.type == SDL_KEYDOWN ? DemoMsg::KeyDownEvent : DemoMsg::KeyUpEvent);
-		WriteLE32(DemoRecording, static_cast<uint32_t>(event.key.keysym.sym));
-		WriteLE16(DemoRecording, static_cast<uint16_t>(event.key.keysym.mod));
+		DemoRecordingBlocks->WriteLE32(static_cast<uint32_t>(event.key.keysym.sym));
+		DemoRecordingBlocks->WriteLE16(static_cast<uint16_t>(event.key.keysym.mod));
 		break;
 #ifndef USE_SDL1
 	case SDL_WINDOWEVENT:
@@ -824,12 +949,15 @@ void NotifyGameLoopStart()
 		WriteByte(DemoRecording, Version);
 		WriteLE32(DemoRecording, gSaveNumber);
 		WriteSettings(DemoRecording);
+		DemoRecordingBlocks.emplace(DemoRecording);
 	}
 }
 
 void NotifyGameLoopEnd()
 {
 	if (IsRecording()) {
+		DemoRecordingBlocks->Finish();
+		DemoRecordingBlocks = std::nullopt;
 		std::fclose(DemoRecording);
 		DemoRecording = nullptr;
 		if (CreateDemoReference)
@@ -841,17 +969,22 @@ void NotifyGameLoopEnd()
 
 	if (IsRunning() && !HeadlessMode) {
 		const float seconds = (SDL_GetTicks() - StartTime) / 1000.0F;
-		SDL_Log("%d frames, %.2f seconds: %.1f fps", LogicTick, seconds, LogicTick / seconds);
+		Log("{} frames, {:.2f} seconds: {:.1f} fps", LogicTick, seconds, LogicTick / seconds);
 		gbRunGameResult = false;
 		gbRunGame = false;
 
+		if (DemoStateDivergedTick)
+			Log("Timedemo: Game state diverged from the recording at tick {}.", *DemoStateDivergedTick);
+		else if (DemoFileVersion >= FirstStateHashVersion)
+			Log("Timedemo: Game state matched the recording.");
+
 		HeroCompareResult compareResult = pfile_compare_hero_demo(DemoNumber, false);
 		switch (compareResult.status) {
 		case HeroCompareResult::ReferenceNotFound:
-			SDL_Log("Timedemo: No final comparison cause reference is not present.");
+			Log("Timedemo: No final comparison cause reference is not present.");
 			break;
 		case HeroCompareResult::Same:
-			SDL_Log("Timedemo: Same outcome as initial run. :)");
+			Log("Timedemo: Same outcome as initial run. :)");
 			break;
 		case HeroCompareResult::Difference:
 			Log("Timedemo: Different outcome than initial run. ;(\n{}", compareResult.message);
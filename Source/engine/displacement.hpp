@@ -8,6 +8,7 @@
 #include "engine/direction.hpp"
 #include "engine/size.hpp"
 #include "utils/attributes.h"
+#include "utils/soft_float.hpp"
 
 namespace devilution {
 
@@ -89,13 +90,6 @@ struct DisplacementOf {
 		return *this;
 	}
 
-	DVL_ALWAYS_INLINE constexpr DisplacementOf<DeltaT> &operator*=(const float factor)
-	{
-		deltaX = static_cast<DeltaT>(deltaX * factor);
-		deltaY = static_cast<DeltaT>(deltaY * factor);
-		return *this;
-	}
-
 	template <typename DeltaU>
 	DVL_ALWAYS_INLINE constexpr DisplacementOf<DeltaT> &operator*=(const DisplacementOf<DeltaU> factor)
 	{
@@ -111,29 +105,6 @@ struct DisplacementOf {
 		return *this;
 	}
 
-	DVL_ALWAYS_INLINE constexpr DisplacementOf<DeltaT> &operator/=(const float factor)
-	{
-		deltaX = static_cast<DeltaT>(deltaX / factor);
-		deltaY = static_cast<DeltaT>(deltaY / factor);
-		return *this;
-	}
-
-	DVL_ALWAYS_INLINE float magnitude() const
-	{
-		// If [x * x <= max], then [x <= max / x] for x > 0
-		assert(deltaX == 0 || std::abs(deltaX) <= std::numeric_limits<DeltaT>::max() / std::abs(deltaX));
-		assert(deltaY == 0 || std::abs(deltaY) <= std::numeric_limits<DeltaT>::max() / std::abs(deltaY));
-
-		// If [x + y <= max], then [x <= max - y]
-		assert(deltaX * deltaX <= std::numeric_limits<DeltaT>::max() - deltaY * deltaY);
-
-		// Maximum precision of float is 24 bits
-		assert(deltaX * deltaX + deltaY * deltaY < (1 << 24));
-
-		// We do not use `std::hypot` here because it is slower and we do not need the extra precision.
-		return sqrtf(static_cast<float>(deltaX * deltaX + deltaY * deltaY));
-	}
-
 	/**
 	 * @brief Returns a new Displacement object in screen coordinates.
 	 *
@@ -304,13 +275,6 @@ DVL_ALWAYS_INLINE constexpr DisplacementOf<DisplacementDeltaT> operator*(Displac
 	return a;
 }
 
-template <typename DisplacementDeltaT>
-DVL_ALWAYS_INLINE constexpr DisplacementOf<DisplacementDeltaT> operator*(DisplacementOf<DisplacementDeltaT> a, const float factor)
-{
-	a *= factor;
-	return a;
-}
-
 template <typename DisplacementDeltaT, typename DisplacementDeltaU>
 DVL_ALWAYS_INLINE constexpr DisplacementOf<DisplacementDeltaT> operator*(DisplacementOf<DisplacementDeltaT> a, const DisplacementOf<DisplacementDeltaU> factor)
 {
@@ -325,13 +289,6 @@ DVL_ALWAYS_INLINE constexpr DisplacementOf<DisplacementDeltaT> operator/(Displac
 	return a;
 }
 
-template <typename DisplacementDeltaT>
-DVL_ALWAYS_INLINE constexpr DisplacementOf<DisplacementDeltaT> operator/(DisplacementOf<DisplacementDeltaT> a, const float factor)
-{
-	a /= factor;
-	return a;
-}
-
 template <typename DisplacementDeltaT>
 DVL_ALWAYS_INLINE constexpr DisplacementOf<DisplacementDeltaT> operator-(DisplacementOf<DisplacementDeltaT> a)
 {
@@ -359,10 +316,15 @@ DVL_ALWAYS_INLINE constexpr DisplacementOf<DisplacementDeltaT> abs(DisplacementO
 template <typename DeltaT>
 Displacement DisplacementOf<DeltaT>::normalized() const
 {
-	const float magnitude = this->magnitude();
-	Displacement normalDisplacement = Displacement(*this) << 16u;
-	normalDisplacement /= magnitude;
-	return normalDisplacement;
+	// Same result as dividing by magnitude() in float, without depending on how the compiler treats floats
+	const SoftFloat magnitude = SoftFloat::FromInt(static_cast<uint32_t>(deltaX * deltaX + deltaY * deltaY)).squareRoot();
+	if (magnitude.isZero())
+		return { 0, 0 };
+	const auto normalize = [&magnitude](int delta) {
+		const int value = static_cast<int>((SoftFloat::FromInt(static_cast<uint32_t>(std::abs(delta)) << 16) / magnitude).truncate());
+		return delta < 0 ? -value : value;
+	};
+	return { normalize(static_cast<int>(deltaX)), normalize(static_cast<int>(deltaY)) };
 }
 
 } // namespace devilution
@@ -5,6 +5,8 @@
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <type_traits>
+#include <utility>
 
 #include <fmt/core.h>
 
@@ -12,6 +14,7 @@
 #include "diablo.h"
 #include "engine/assets.hpp"
 #include "mpq/mpq_common.hpp"
+#include "utils/arena.hpp"
 #include "utils/static_vector.hpp"
 #include "utils/str_cat.hpp"
 
@@ -75,6 +78,32 @@ std::unique_ptr<T[]> LoadFileInMem(const char *path, std::size_t *numRead = null
 	return buf;
 }
 
+/**
+ * @brief Load a file in to a buffer allocated from an arena
+ * @param arena Arena that owns the returned buffer
+ * @param path Path of file
+ * @param numRead Number of T elements read
+ * @return Buffer with content of file, valid until the arena is reset
+ */
+template <typename T = std::byte>
+T *LoadFileInMem(Arena &arena, const char *path, std::size_t *numRead = nullptr)
+{
+	static_assert(std::is_trivially_default_constructible_v<T>);
+	size_t size;
+	AssetHandle handle = OpenAsset(path, size);
+	if (!ValidateHandle(path, handle))
+		return nullptr;
+	if ((size % sizeof(T)) != 0)
+		app_fatal(StrCat("File size does not align with type\n", path));
+
+	if (numRead != nullptr)
+		*numRead = size / sizeof(T);
+
+	T *buf = arena.allocate<T>(size / sizeof(T));
+	handle.read(buf, size);
+	return buf;
+}
+
 /**
  * @brief Reads multiple files into a single buffer
  *
@@ -99,6 +128,32 @@ struct MultiFileLoader {
 	template <typename PathFn, typename FilterFn = DefaultFilterFn>
 	[[nodiscard]] std::unique_ptr<std::byte[]> operator()(size_t numFiles, PathFn &&pathFn, uint32_t *outOffsets,
 	    FilterFn filterFn = DefaultFilterFn {})
+	{
+		std::unique_ptr<std::byte[]> buf;
+		load(
+		    numFiles, std::forward<PathFn>(pathFn), outOffsets, filterFn, [&buf](size_t size) {
+			    buf = std::unique_ptr<std::byte[]> { new std::byte[size] };
+			    return buf.get();
+		    });
+		return buf;
+	}
+
+	/**
+	 * @brief Same as above, but the buffer is allocated from `arena` and is valid until the arena is reset.
+	 */
+	template <typename PathFn, typename FilterFn = DefaultFilterFn>
+	[[nodiscard]] std::byte *operator()(Arena &arena, size_t numFiles, PathFn &&pathFn, uint32_t *outOffsets,
+	    FilterFn filterFn = DefaultFilterFn {})
+	{
+		return load(
+		    numFiles, std::forward<PathFn>(pathFn), outOffsets, filterFn, [&arena](size_t size) {
+			    return arena.allocate<std::byte>(size);
+		    });
+	}
+
+private:
+	template <typename PathFn, typename FilterFn, typename AllocFn>
+	std::byte *load(size_t numFiles, PathFn &&pathFn, uint32_t *outOffsets, FilterFn filterFn, AllocFn allocFn)
 	{
 		StaticVector<std::array<char, MaxMpqPathSize>, MaxFiles> paths;
 		StaticVector<AssetRef, MaxFiles> files;
@@ -124,7 +179,7 @@ struct MultiFileLoader {
 			++j;
 		}
 		outOffsets[files.size()] = static_cast<uint32_t>(totalSize);
-		std::unique_ptr<std::byte[]> buf { new std::byte[totalSize] };
+		std::byte *buf = allocFn(totalSize);
 		for (size_t i = 0, j = 0; i < numFiles; ++i) {
 			if (!filterFn(i))
 				continue;
@@ -10,6 +10,7 @@
 #include "engine/direction.hpp"
 #include "engine/displacement.hpp"
 #include "utils/attributes.h"
+#include "utils/math.h"
 
 namespace devilution {
 
@@ -74,13 +75,6 @@ struct PointOf {
 		return *this;
 	}
 
-	DVL_ALWAYS_INLINE constexpr PointOf<CoordT> &operator*=(const float factor)
-	{
-		x = static_cast<int>(x * factor);
-		y = static_cast<int>(y * factor);
-		return *this;
-	}
-
 	DVL_ALWAYS_INLINE constexpr PointOf<CoordT> &operator*=(const int factor)
 	{
 		x *= factor;
@@ -133,7 +127,7 @@ struct PointOf {
 		const Displacement vector = Point(*this) - Point(other); // No need to call abs() as we square the values anyway
 
 		// Casting multiplication operands to a wide type to address overflow warnings
-		return static_cast<int>(std::sqrt(static_cast<int64_t>(vector.deltaX) * vector.deltaX + static_cast<int64_t>(vector.deltaY) * vector.deltaY));
+		return static_cast<int>(math::IntegerSqrt(static_cast<uint64_t>(static_cast<int64_t>(vector.deltaX) * vector.deltaX + static_cast<int64_t>(vector.deltaY) * vector.deltaY)));
 	}
 
 	template <typename PointCoordT>
@@ -210,13 +204,6 @@ DVL_ALWAYS_INLINE constexpr PointOf<PointCoordT> operator-(PointOf<PointCoordT>
 	return a;
 }
 
-template <typename PointCoordT>
-DVL_ALWAYS_INLINE constexpr PointOf<PointCoordT> operator*(PointOf<PointCoordT> a, const float factor)
-{
-	a *= factor;
-	return a;
-}
-
 template <typename PointCoordT>
 DVL_ALWAYS_INLINE constexpr PointOf<PointCoordT> operator*(PointOf<PointCoordT> a, const int factor)
 {
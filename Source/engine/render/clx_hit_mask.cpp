@@ -0,0 +1,93 @@
+/**
+ * @file clx_hit_mask.cpp
+ *
+ * Cached opacity masks for pixel-perfect hit testing of CLX sprites.
+ */
+#include "engine/render/clx_hit_mask.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "utils/clx_decode.hpp"
+
+namespace devilution {
+
+namespace {
+
+/** Upper bound on the number of cached masks, the cache is emptied when it is reached. */
+constexpr size_t MaxCachedHitMasks = 2048;
+
+std::unordered_map<const uint8_t *, ClxHitMask> HitMaskCache;
+
+} // namespace
+
+ClxHitMask::ClxHitMask(ClxSprite clx)
+    : width_(clx.width())
+    , height_(clx.height())
+    , rowWords_(static_cast<uint16_t>((clx.width() + 31) / 32))
+    , pixelDataSize_(clx.pixelDataSize())
+    , bits_(new uint32_t[static_cast<size_t>(rowWords_) * height_] {})
+{
+	const uint8_t *src = clx.pixelData();
+	const uint8_t *end = src + clx.pixelDataSize();
+	const int width = width_;
+
+	// Rows are stored bottom to top. Runs can continue past the end of a row,
+	// in which case `IsPointWithinClx` treats the overrun part as transparent.
+	int xCur = 0;
+	int yCur = height_ - 1;
+	while (src < end && yCur >= 0) {
+		uint8_t val = *src++;
+		if (!IsClxOpaque(val)) {
+			xCur += val;
+		} else if (IsClxOpaqueFill(val)) {
+			val = GetClxOpaqueFillWidth(val);
+			const uint8_t color = *src++;
+			if (color != 0) // ignore shadows
+				setSpan(yCur, xCur, std::min(xCur + val, width));
+			xCur += val;
+		} else {
+			val = GetClxOpaquePixelsWidth(val);
+			for (uint8_t pixel = 0; pixel < val; pixel++) {
+				const uint8_t color = *src++;
+				if (color != 0 && xCur < width) // ignore shadows
+					setSpan(yCur, xCur, xCur + 1);
+				xCur++;
+			}
+		}
+
+		if (xCur >= width) {
+			yCur -= xCur / width;
+			xCur %= width;
+		}
+	}
+}
+
+void ClxHitMask::setSpan(int y, int xBegin, int xEnd)
+{
+	uint32_t *row = &bits_[y * rowWords_];
+	for (int x = xBegin; x < xEnd; x++) {
+		row[x / 32] |= 1U << (x % 32);
+	}
+}
+
+bool IsPointWithinClxCached(Point position, ClxSprite clx)
+{
+	auto it = HitMaskCache.find(clx.pixelData());
+	if (it == HitMaskCache.end() || !it->second.matches(clx)) {
+		if (it != HitMaskCache.end()) {
+			HitMaskCache.erase(it);
+		} else if (HitMaskCache.size() >= MaxCachedHitMasks) {
+			HitMaskCache.clear();
+		}
+		it = HitMaskCache.emplace(clx.pixelData(), ClxHitMask { clx }).first;
+	}
+	return it->second.contains(position);
+}
+
+void ClearClxHitMaskCache()
+{
+	HitMaskCache.clear();
+}
+
+} // namespace devilution
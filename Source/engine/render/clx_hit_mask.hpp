@@ -0,0 +1,67 @@
+/**
+ * @file clx_hit_mask.hpp
+ *
+ * Cached opacity masks for pixel-perfect hit testing of CLX sprites.
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "engine/clx_sprite.hpp"
+#include "engine/point.hpp"
+
+namespace devilution {
+
+/**
+ * @brief One bit per pixel of a CLX sprite, set for opaque non-shadow pixels.
+ *
+ * The mask agrees with `IsPointWithinClx` for every point within the sprite.
+ */
+class ClxHitMask {
+public:
+	explicit ClxHitMask(ClxSprite clx);
+
+	/**
+	 * @brief Returns if the point (relative to the top-left corner of the sprite) is opaque.
+	 */
+	[[nodiscard]] bool contains(Point position) const
+	{
+		if (position.x < 0 || position.y < 0 || position.x >= width_ || position.y >= height_)
+			return false;
+		const uint32_t word = bits_[position.y * rowWords_ + position.x / 32];
+		return ((word >> (position.x % 32)) & 1) != 0;
+	}
+
+	/**
+	 * @brief Returns if the mask was built from a sprite with the same dimensions and data size.
+	 */
+	[[nodiscard]] bool matches(ClxSprite clx) const
+	{
+		return clx.width() == width_ && clx.height() == height_ && clx.pixelDataSize() == pixelDataSize_;
+	}
+
+private:
+	void setSpan(int y, int xBegin, int xEnd);
+
+	uint16_t width_;
+	uint16_t height_;
+	uint16_t rowWords_;
+	uint32_t pixelDataSize_;
+	std::unique_ptr<uint32_t[]> bits_;
+};
+
+/**
+ * @brief Returns if cursor is within the CLX sprite (ignores shadow).
+ *
+ * Same result as `IsPointWithinClx`, but answered from a `ClxHitMask` that is built the first time
+ * the sprite is tested and cached afterwards.
+ */
+bool IsPointWithinClxCached(Point position, ClxSprite clx);
+
+/**
+ * @brief Drops all cached hit masks, must be called before sprite data is freed.
+ */
+void ClearClxHitMaskCache();
+
+} // namespace devilution
@@ -0,0 +1,244 @@
+/**
+ * @file draw_commands.cpp
+ *
+ * Implementation of the retained list of draw commands.
+ */
+#include "engine/render/draw_commands.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <optional>
+#include <unordered_map>
+
+#include "engine.h"
+#include "engine/load_clx.hpp"
+#include "engine/render/clx_render.hpp"
+#include "engine/render/text_render.hpp"
+#include "utils/log.hpp"
+
+namespace devilution {
+
+namespace {
+
+/** @brief Sprites by asset path, files that failed to load are kept as nullopt so they are only tried once. */
+std::unordered_map<std::string, OptionalOwnedClxSpriteListOrSheet> DrawCommandSprites;
+
+std::optional<ClxSpriteList> GetDrawCommandSprites(std::string_view path)
+{
+	std::string key { path };
+	auto it = DrawCommandSprites.find(key);
+	if (it == DrawCommandSprites.end()) {
+		it = DrawCommandSprites.emplace(key, LoadOptionalClxListOrSheet(key.c_str())).first;
+		if (!it->second)
+			LogError("Failed to load sprite {}", path);
+	}
+	if (!it->second)
+		return std::nullopt;
+	return it->second->isSheet() ? it->second->sheet()[0] : it->second->list();
+}
+
+enum OutCode : uint8_t {
+	OutLeft = 1 << 0,
+	OutRight = 1 << 1,
+	OutTop = 1 << 2,
+	OutBottom = 1 << 3,
+};
+
+uint8_t GetOutCode(double x, double y, int maxX, int maxY)
+{
+	uint8_t code = 0;
+	if (x < 0)
+		code |= OutLeft;
+	else if (x > maxX)
+		code |= OutRight;
+	if (y < 0)
+		code |= OutTop;
+	else if (y > maxY)
+		code |= OutBottom;
+	return code;
+}
+
+/**
+ * @brief Cohen-Sutherland clipping of the line to the surface.
+ *
+ * Endpoints moved onto an edge are rounded to the nearest pixel.
+ * Works in doubles because the deltas of arbitrary int coordinates overflow when multiplied.
+ * @return false if no part of the line is on the surface
+ */
+bool ClipLine(const Surface &out, Point &from, Point &to)
+{
+	const int maxX = out.w() - 1;
+	const int maxY = out.h() - 1;
+	if (maxX < 0 || maxY < 0)
+		return false;
+
+	double x0 = from.x;
+	double y0 = from.y;
+	double x1 = to.x;
+	double y1 = to.y;
+	uint8_t code0 = GetOutCode(x0, y0, maxX, maxY);
+	uint8_t code1 = GetOutCode(x1, y1, maxX, maxY);
+	// Each endpoint is moved at most twice, once per axis.
+	for (int i = 0; i < 4 && (code0 | code1) != 0; i++) {
+		if ((code0 & code1) != 0)
+			return false;
+		const bool clipFrom = code0 != 0;
+		const uint8_t code = clipFrom ? code0 : code1;
+		double x;
+		double y;
+		if ((code & OutTop) != 0) {
+			y = 0;
+			x = x0 + (x1 - x0) * (y - y0) / (y1 - y0);
+		} else if ((code & OutBottom) != 0) {
+			y = maxY;
+			x = x0 + (x1 - x0) * (y - y0) / (y1 - y0);
+		} else if ((code & OutLeft) != 0) {
+			x = 0;
+			y = y0 + (y1 - y0) * (x - x0) / (x1 - x0);
+		} else {
+			x = maxX;
+			y = y0 + (y1 - y0) * (x - x0) / (x1 - x0);
+		}
+		x = std::round(x);
+		y = std::round(y);
+		if (clipFrom) {
+			x0 = x;
+			y0 = y;
+			code0 = GetOutCode(x0, y0, maxX, maxY);
+		} else {
+			x1 = x;
+			y1 = y;
+			code1 = GetOutCode(x1, y1, maxX, maxY);
+		}
+	}
+	if ((code0 | code1) != 0)
+		return false;
+
+	from = { static_cast<int>(x0), static_cast<int>(y0) };
+	to = { static_cast<int>(x1), static_cast<int>(y1) };
+	return true;
+}
+
+/** @brief Bresenham's line algorithm, with lines along an axis drawn as a whole. */
+void DrawLine(const Surface &out, Point from, Point to, uint8_t color)
+{
+	if (!ClipLine(out, from, to))
+		return;
+
+	if (from.y == to.y) {
+		DrawHorizontalLine(out, { std::min(from.x, to.x), from.y }, std::abs(to.x - from.x) + 1, color);
+		return;
+	}
+	if (from.x == to.x) {
+		DrawVerticalLine(out, { from.x, std::min(from.y, to.y) }, std::abs(to.y - from.y) + 1, color);
+		return;
+	}
+
+	const int dx = std::abs(to.x - from.x);
+	const int dy = -std::abs(to.y - from.y);
+	const int stepX = from.x < to.x ? 1 : -1;
+	const int stepY = from.y < to.y ? 1 : -1;
+	int error = dx + dy;
+	Point position = from;
+	while (true) {
+		out.SetPixel(position, color);
+		if (position == to)
+			break;
+		const int doubleError = 2 * error;
+		if (doubleError >= dy) {
+			error += dy;
+			position.x += stepX;
+		}
+		if (doubleError <= dx) {
+			error += dx;
+			position.y += stepY;
+		}
+	}
+}
+
+} // namespace
+
+void DrawCommandList::Clear()
+{
+	commands_.clear();
+	text_.clear();
+	sprites_.clear();
+}
+
+void DrawCommandList::SetClip(Rectangle rect)
+{
+	commands_.push_back({ .type = CommandType::Clip, .rect = rect });
+}
+
+void DrawCommandList::AddRect(Rectangle rect, uint8_t color)
+{
+	commands_.push_back({ .type = CommandType::Rect, .color = color, .rect = rect });
+}
+
+void DrawCommandList::AddLine(Point from, Point to, uint8_t color)
+{
+	commands_.push_back({ .type = CommandType::Line, .color = color, .rect = Rectangle { from, Size {} }, .to = to });
+}
+
+bool DrawCommandList::AddSprite(std::string_view path, uint16_t frame, Point position)
+{
+	const std::optional<ClxSpriteList> sprites = GetDrawCommandSprites(path);
+	if (!sprites || frame >= sprites->numSprites())
+		return false;
+	commands_.push_back({ .type = CommandType::Sprite, .rect = Rectangle { position, Size {} }, .begin = static_cast<uint32_t>(sprites_.size()) });
+	sprites_.push_back((*sprites)[frame]);
+	return true;
+}
+
+void DrawCommandList::AddText(std::string_view text, Rectangle rect, UiFlags flags)
+{
+	commands_.push_back({ .type = CommandType::Text, .flags = flags, .rect = rect, .begin = static_cast<uint32_t>(text_.size()), .length = static_cast<uint32_t>(text.size()) });
+	text_.append(text);
+}
+
+void DrawCommandList::Draw(const Surface &out) const
+{
+	Surface target = out;
+	Displacement origin = {};
+	for (const Command &command : commands_) {
+		switch (command.type) {
+		case CommandType::Clip: {
+			if (command.rect.size.width <= 0 || command.rect.size.height <= 0) {
+				target = out;
+				origin = {};
+				break;
+			}
+			const int left = std::clamp(command.rect.position.x, 0, out.w());
+			const int top = std::clamp(command.rect.position.y, 0, out.h());
+			const int right = std::clamp(command.rect.position.x + command.rect.size.width, left, out.w());
+			const int bottom = std::clamp(command.rect.position.y + command.rect.size.height, top, out.h());
+			target = out.subregion(left, top, right - left, bottom - top);
+			origin = { left, top };
+		} break;
+		case CommandType::Rect:
+			FillRect(target, command.rect.position.x - origin.deltaX, command.rect.position.y - origin.deltaY, command.rect.size.width, command.rect.size.height, command.color);
+			break;
+		case CommandType::Line:
+			DrawLine(target, command.rect.position - origin, command.to - origin, command.color);
+			break;
+		case CommandType::Sprite:
+			RenderClxSprite(target, sprites_[command.begin], command.rect.position - origin);
+			break;
+		case CommandType::Text: {
+			Rectangle rect = command.rect;
+			rect.position -= origin;
+			if (rect.size.width <= 0)
+				rect.size.width = target.w() - rect.position.x;
+			DrawString(target, std::string_view(text_).substr(command.begin, command.length), rect, { .flags = command.flags });
+		} break;
+		}
+	}
+}
+
+void ClearDrawCommandSprites()
+{
+	DrawCommandSprites.clear();
+}
+
+} // namespace devilution
@@ -0,0 +1,93 @@
+/**
+ * @file draw_commands.hpp
+ *
+ * Retained list of draw commands that is recorded once and drawn every frame.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "DiabloUI/ui_flags.hpp"
+#include "engine/clx_sprite.hpp"
+#include "engine/point.hpp"
+#include "engine/rectangle.hpp"
+#include "engine/surface.hpp"
+
+namespace devilution {
+
+/**
+ * @brief Draw commands in screen coordinates, kept until they are cleared.
+ */
+class DrawCommandList {
+public:
+	void Clear();
+
+	/** @brief Limits the following commands to the given area, an empty rectangle removes the limit. */
+	void SetClip(Rectangle rect);
+
+	/** @brief Fills a rectangle. */
+	void AddRect(Rectangle rect, uint8_t color);
+
+	void AddLine(Point from, Point to, uint8_t color);
+
+	/**
+	 * @brief Draws a frame of a CLX sprite list with its top left corner at the given position.
+	 *
+	 * The sprites are loaded on first use and kept until ClearDrawCommandSprites() is called.
+	 * @return False if the sprite doesn't exist
+	 */
+	bool AddSprite(std::string_view path, uint16_t frame, Point position);
+
+	/** @brief Draws text, aligned within the given rectangle for UiFlags::AlignCenter and UiFlags::AlignRight. */
+	void AddText(std::string_view text, Rectangle rect, UiFlags flags);
+
+	void Draw(const Surface &out) const;
+
+	[[nodiscard]] bool empty() const
+	{
+		return commands_.empty();
+	}
+
+	[[nodiscard]] size_t size() const
+	{
+		return commands_.size();
+	}
+
+private:
+	enum class CommandType : uint8_t {
+		Clip,
+		Rect,
+		Line,
+		Sprite,
+		Text,
+	};
+
+	struct Command {
+		CommandType type;
+		uint8_t color;
+		UiFlags flags;
+		/** @brief Area of Clip, Rect and Text, start of Line, position of Sprite. */
+		Rectangle rect;
+		/** @brief End of Line. */
+		Point to;
+		/** @brief Index into sprites_ for Sprite, into text_ for Text. */
+		uint32_t begin;
+		uint32_t length;
+	};
+
+	std::vector<Command> commands_;
+	/** @brief Text of all Text commands, so recording doesn't allocate once the buffers have grown. */
+	std::string text_;
+	std::vector<ClxSprite> sprites_;
+};
+
+/**
+ * @brief Unloads the sprites used by draw commands, lists that contain sprites must be cleared first.
+ */
+void ClearDrawCommandSprites();
+
+} // namespace devilution
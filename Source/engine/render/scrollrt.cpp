@@ -10,6 +10,7 @@
 
 #include "DiabloUI/ui_flags.hpp"
 #include "automap.h"
+#include "capture.h"
 #include "controls/plrctrls.h"
 #include "cursor.h"
 #include "dead.h"
@@ -1660,6 +1661,7 @@ void DrawAndBlit()
 	DrawFPS(out);
 
 	LuaEvent("GameDrawComplete");
+	DrawLuaRenderCommands(out);
 
 	DrawMain(out, hgt, drawInfoBox, drawHealth, drawMana, drawBelt, drawControlButtons);
 
@@ -1674,6 +1676,8 @@ void DrawAndBlit()
 		}
 	}
 
+	CaptureFrame(out);
+
 	RenderPresent();
 }
 
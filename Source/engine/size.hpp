@@ -56,13 +56,6 @@ struct SizeOf {
 		return *this;
 	}
 
-	DVL_ALWAYS_INLINE constexpr SizeOf<SizeT> &operator*=(float factor)
-	{
-		width = static_cast<SizeT>(width * factor);
-		height = static_cast<SizeT>(height * factor);
-		return *this;
-	}
-
 	DVL_ALWAYS_INLINE constexpr SizeOf<SizeT> &operator/=(SizeT factor)
 	{
 		width /= factor;
@@ -22,6 +22,7 @@
 #include "engine/size.hpp"
 #include "hwcursor.hpp"
 #include "inv_iterators.hpp"
+#include "inv_occupancy.hpp"
 #include "levels/town.h"
 #include "minitext.h"
 #include "options.h"
@@ -278,7 +279,7 @@ bool AutoEquip(Player &player, const Item &item, inv_body_loc bodyLocation, bool
 			PlaySFX(ItemInvSnds[ItemCAnimTbl[item._iCurs]]);
 		}
 
-		CalcPlrInv(player, true);
+		CalcPlrInvAfterEquip(player, { bodyLocation }, true);
 	}
 
 	return true;
@@ -1266,29 +1267,17 @@ namespace {
  * @brief Checks whether the given item can be placed on the specified player's inventory slot.
  * If 'persistItem' is 'True', the item is also placed in the inventory slot.
  * @param player The player whose inventory will be checked.
+ * @param occupancy The cells of the player's inventory that are in use.
  * @param slotIndex The 0-based index of the slot to put the item on.
  * @param item The item to be checked.
+ * @param itemSize The inventory size of the item.
  * @param persistItem Pass 'True' to actually place the item in the inventory slot. The default is 'False'.
  * @return 'True' in case the item can be placed on the specified player's inventory slot and 'False' otherwise.
  */
-bool AutoPlaceItemInInventorySlot(Player &player, int slotIndex, const Item &item, bool persistItem, bool sendNetworkMessage)
+bool AutoPlaceItemInInventorySlot(Player &player, const InventoryOccupancy &occupancy, int slotIndex, const Item &item, Size itemSize, bool persistItem, bool sendNetworkMessage)
 {
-	int yy = (slotIndex > 0) ? (10 * (slotIndex / 10)) : 0;
-
-	Size itemSize = GetInventorySize(item);
-	for (int j = 0; j < itemSize.height; j++) {
-		if (yy >= InventoryGridCells) {
-			return false;
-		}
-		int xx = (slotIndex > 0) ? (slotIndex % 10) : 0;
-		for (int i = 0; i < itemSize.width; i++) {
-			if (xx >= 10 || player.InvGrid[xx + yy] != 0) {
-				return false;
-			}
-			xx++;
-		}
-		yy += 10;
-	}
+	if (!occupancy.CanFit(slotIndex, itemSize))
+		return false;
 
 	if (persistItem) {
 		player.InvList[player._pNumInv] = item;
@@ -1305,15 +1294,16 @@ bool AutoPlaceItemInInventorySlot(Player &player, int slotIndex, const Item &ite
 bool AutoPlaceItemInInventory(Player &player, const Item &item, bool persistItem, bool sendNetworkMessage)
 {
 	Size itemSize = GetInventorySize(item);
+	const InventoryOccupancy occupancy { player.InvGrid };
 
 	if (itemSize.height == 1) {
 		for (int i = 30; i <= 39; i++) {
-			if (AutoPlaceItemInInventorySlot(player, i, item, persistItem, sendNetworkMessage))
+			if (AutoPlaceItemInInventorySlot(player, occupancy, i, item, itemSize, persistItem, sendNetworkMessage))
 				return true;
 		}
 		for (int x = 9; x >= 0; x--) {
 			for (int y = 2; y >= 0; y--) {
-				if (AutoPlaceItemInInventorySlot(player, 10 * y + x, item, persistItem, sendNetworkMessage))
+				if (AutoPlaceItemInInventorySlot(player, occupancy, 10 * y + x, item, itemSize, persistItem, sendNetworkMessage))
 					return true;
 			}
 		}
@@ -1323,14 +1313,14 @@ bool AutoPlaceItemInInventory(Player &player, const Item &item, bool persistItem
 	if (itemSize.height == 2) {
 		for (int x = 10 - itemSize.width; x >= 0; x -= itemSize.width) {
 			for (int y = 0; y < 3; y++) {
-				if (AutoPlaceItemInInventorySlot(player, 10 * y + x, item, persistItem, sendNetworkMessage))
+				if (AutoPlaceItemInInventorySlot(player, occupancy, 10 * y + x, item, itemSize, persistItem, sendNetworkMessage))
 					return true;
 			}
 		}
 		if (itemSize.width == 2) {
 			for (int x = 7; x >= 0; x -= 2) {
 				for (int y = 0; y < 3; y++) {
-					if (AutoPlaceItemInInventorySlot(player, 10 * y + x, item, persistItem, sendNetworkMessage))
+					if (AutoPlaceItemInInventorySlot(player, occupancy, 10 * y + x, item, itemSize, persistItem, sendNetworkMessage))
 						return true;
 				}
 			}
@@ -1340,7 +1330,7 @@ bool AutoPlaceItemInInventory(Player &player, const Item &item, bool persistItem
 
 	if (itemSize == Size { 1, 3 }) {
 		for (int i = 0; i < 20; i++) {
-			if (AutoPlaceItemInInventorySlot(player, i, item, persistItem, sendNetworkMessage))
+			if (AutoPlaceItemInInventorySlot(player, occupancy, i, item, itemSize, persistItem, sendNetworkMessage))
 				return true;
 		}
 		return false;
@@ -1348,12 +1338,12 @@ bool AutoPlaceItemInInventory(Player &player, const Item &item, bool persistItem
 
 	if (itemSize == Size { 2, 3 }) {
 		for (int i = 0; i < 9; i++) {
-			if (AutoPlaceItemInInventorySlot(player, i, item, persistItem, sendNetworkMessage))
+			if (AutoPlaceItemInInventorySlot(player, occupancy, i, item, itemSize, persistItem, sendNetworkMessage))
 				return true;
 		}
 
 		for (int i = 10; i < 19; i++) {
-			if (AutoPlaceItemInInventorySlot(player, i, item, persistItem, sendNetworkMessage))
+			if (AutoPlaceItemInInventorySlot(player, occupancy, i, item, itemSize, persistItem, sendNetworkMessage))
 				return true;
 		}
 		return false;
@@ -1434,21 +1424,24 @@ bool GoldAutoPlace(Player &player, Item &goldStack)
 void CheckInvSwap(Player &player, inv_body_loc bLoc)
 {
 	Item &item = player.InvBody[bLoc];
+	inv_body_loc otherHand = bLoc;
 
 	if (bLoc == INVLOC_HAND_LEFT && player.GetItemLocation(item) == ILOC_TWOHAND) {
+		otherHand = INVLOC_HAND_RIGHT;
 		player.InvBody[INVLOC_HAND_RIGHT].clear();
 	} else if (bLoc == INVLOC_HAND_RIGHT && player.GetItemLocation(item) == ILOC_TWOHAND) {
+		otherHand = INVLOC_HAND_LEFT;
 		player.InvBody[INVLOC_HAND_LEFT].clear();
 	}
 
-	CalcPlrInv(player, true);
+	CalcPlrInvAfterEquip(player, { bLoc, otherHand }, true);
 }
 
 void inv_update_rem_item(Player &player, inv_body_loc iv)
 {
 	player.InvBody[iv].clear();
 
-	CalcPlrInv(player, player._pmode != PM_DEATH);
+	CalcPlrInvAfterEquip(player, { iv }, player._pmode != PM_DEATH);
 }
 
 void CheckInvSwap(Player &player, const Item &item, int invGridIndex)
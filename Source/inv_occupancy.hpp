@@ -0,0 +1,60 @@
+/**
+ * @file inv_occupancy.hpp
+ *
+ * Bitmap of the occupied cells of a player's inventory grid.
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "engine/size.hpp"
+#include "player.h"
+
+namespace devilution {
+
+/**
+ * @brief One bit per inventory cell, in InvGrid order, set when the cell holds (part of) an item.
+ *
+ * Lets the auto-placement code test whether an item fits on a slot with a single mask instead of
+ * looking at every cell the item would cover.
+ */
+class InventoryOccupancy {
+public:
+	static constexpr int Pitch = 10;
+	static constexpr int Rows = InventoryGridCells / Pitch;
+
+	explicit InventoryOccupancy(const int8_t (&invGrid)[InventoryGridCells])
+	{
+		for (int i = 0; i < InventoryGridCells; i++) {
+			if (invGrid[i] != 0)
+				cells_ |= uint64_t { 1 } << i;
+		}
+	}
+
+	/**
+	 * @brief Checks whether an item of the given size can be placed with its top-left cell on `slotIndex`.
+	 */
+	[[nodiscard]] constexpr bool CanFit(int slotIndex, Size itemSize) const
+	{
+		const int x = slotIndex % Pitch;
+		const int y = slotIndex / Pitch;
+		if (x + itemSize.width > Pitch || y + itemSize.height > Rows)
+			return false;
+		return (cells_ & (ItemMask(itemSize) << slotIndex)) == 0;
+	}
+
+private:
+	/** @brief Bits covered by an item placed on the first slot. */
+	[[nodiscard]] static constexpr uint64_t ItemMask(Size itemSize)
+	{
+		const uint64_t row = (uint64_t { 1 } << itemSize.width) - 1;
+		uint64_t mask = 0;
+		for (int y = 0; y < itemSize.height; y++)
+			mask |= row << (y * Pitch);
+		return mask;
+	}
+
+	uint64_t cells_ = 0;
+};
+
+} // namespace devilution
@@ -6,6 +6,8 @@
 
 #include "itemdat.h"
 
+#include <algorithm>
+#include <array>
 #include <string_view>
 #include <vector>
 
@@ -571,6 +573,33 @@ void LoadItemAffixesDat(std::string_view filename, std::vector<PLStruct> &out)
 	out.shrink_to_fit();
 }
 
+/** Number of distinct AffixItemType flag combinations. */
+constexpr size_t NumAffixItemTypeCombinations = 1 << 6;
+
+/** Affix candidates by [hellfireItem][AffixItemType flags]. */
+using AffixCandidateTable = std::array<std::array<std::vector<AffixCandidate>, NumAffixItemTypeCombinations>, 2>;
+
+AffixCandidateTable PrefixCandidates;
+AffixCandidateTable SuffixCandidates;
+
+template <typename IsValid>
+void BuildAffixCandidates(const std::vector<PLStruct> &affixes, AffixCandidateTable &out, IsValid &&isValid)
+{
+	for (size_t hellfireItem = 0; hellfireItem < 2; ++hellfireItem) {
+		for (size_t flgs = 0; flgs < NumAffixItemTypeCombinations; ++flgs) {
+			std::vector<AffixCandidate> &candidates = out[hellfireItem][flgs];
+			candidates.clear();
+			for (size_t i = 0; i < affixes.size(); ++i) {
+				if (isValid(static_cast<int>(i), static_cast<AffixItemType>(flgs), hellfireItem != 0))
+					candidates.push_back({ affixes[i].PLMinLvl, static_cast<uint16_t>(i) });
+			}
+			std::stable_sort(candidates.begin(), candidates.end(),
+			    [](const AffixCandidate &a, const AffixCandidate &b) { return a.minLvl < b.minLvl; });
+			candidates.shrink_to_fit();
+		}
+	}
+}
+
 } // namespace
 
 void LoadItemData()
@@ -579,6 +608,53 @@ void LoadItemData()
 	LoadUniqueItemDat();
 	LoadItemAffixesDat("txtdata\\items\\item_prefixes.tsv", ItemPrefixes);
 	LoadItemAffixesDat("txtdata\\items\\item_suffixes.tsv", ItemSuffixes);
+	BuildAffixCandidates(ItemPrefixes, PrefixCandidates, IsPrefixValidForItemType);
+	BuildAffixCandidates(ItemSuffixes, SuffixCandidates, IsSuffixValidForItemType);
+}
+
+bool IsPrefixValidForItemType(int i, AffixItemType flgs, bool hellfireItem)
+{
+	AffixItemType itemTypes = ItemPrefixes[i].PLIType;
+
+	if (!hellfireItem) {
+		if (i > 82)
+			return false;
+
+		if (i >= 12 && i <= 20)
+			itemTypes &= ~AffixItemType::Staff;
+	}
+
+	return HasAnyOf(flgs, itemTypes);
+}
+
+bool IsSuffixValidForItemType(int i, AffixItemType flgs, bool hellfireItem)
+{
+	AffixItemType itemTypes = ItemSuffixes[i].PLIType;
+
+	if (!hellfireItem) {
+		if (i > 94)
+			return false;
+
+		if ((i >= 0 && i <= 1)
+		    || (i >= 14 && i <= 15)
+		    || (i >= 21 && i <= 22)
+		    || (i >= 34 && i <= 36)
+		    || (i >= 41 && i <= 44)
+		    || (i >= 60 && i <= 63))
+			itemTypes &= ~AffixItemType::Staff;
+	}
+
+	return HasAnyOf(flgs, itemTypes);
+}
+
+const std::vector<AffixCandidate> &GetPrefixCandidates(AffixItemType flgs, bool hellfireItem)
+{
+	return PrefixCandidates[hellfireItem ? 1 : 0][static_cast<size_t>(flgs) % NumAffixItemTypeCombinations];
+}
+
+const std::vector<AffixCandidate> &GetSuffixCandidates(AffixItemType flgs, bool hellfireItem)
+{
+	return SuffixCandidates[hellfireItem ? 1 : 0][static_cast<size_t>(flgs) % NumAffixItemTypeCombinations];
 }
 
 std::string_view ItemTypeToString(ItemType itemType)
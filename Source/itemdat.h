@@ -599,6 +599,28 @@ extern std::vector<PLStruct> ItemPrefixes;
 extern std::vector<PLStruct> ItemSuffixes;
 extern std::vector<UniqueItem> UniqueItems;
 
+/**
+ * @brief An affix that can be rolled for some item type, see GetPrefixCandidates.
+ */
+struct AffixCandidate {
+	int8_t minLvl;
+	/** Index into ItemPrefixes or ItemSuffixes. */
+	uint16_t id;
+};
+
 void LoadItemData();
 
+bool IsPrefixValidForItemType(int i, AffixItemType flgs, bool hellfireItem);
+bool IsSuffixValidForItemType(int i, AffixItemType flgs, bool hellfireItem);
+
+/**
+ * @brief Returns the prefixes that are valid for the given item types, sorted by PLMinLvl (table order within a level).
+ */
+const std::vector<AffixCandidate> &GetPrefixCandidates(AffixItemType flgs, bool hellfireItem);
+
+/**
+ * @brief Returns the suffixes that are valid for the given item types, sorted by PLMinLvl (table order within a level).
+ */
+const std::vector<AffixCandidate> &GetSuffixCandidates(AffixItemType flgs, bool hellfireItem);
+
 } // namespace devilution
@@ -25,12 +25,14 @@
 #include "engine/dx.h"
 #include "engine/load_cel.hpp"
 #include "engine/random.hpp"
+#include "engine/render/clx_hit_mask.hpp"
 #include "engine/render/clx_render.hpp"
 #include "engine/render/text_render.hpp"
 #include "init.h"
 #include "inv_iterators.hpp"
 #include "levels/town.h"
 #include "lighting.h"
+#include "lua/game_events.hpp"
 #include "minitext.h"
 #include "missiles.h"
 #include "options.h"
@@ -136,6 +138,21 @@ SfxID ItemInvSnds[] = {
 
 namespace {
 
+struct AffixCandidateRange {
+	const AffixCandidate *first;
+	const AffixCandidate *last;
+
+	[[nodiscard]] const AffixCandidate *begin() const
+	{
+		return first;
+	}
+
+	[[nodiscard]] const AffixCandidate *end() const
+	{
+		return last;
+	}
+};
+
 OptionalOwnedClxSpriteList itemanims[ITEMTYPES];
 
 enum class PlayerArmorGraphic : uint8_t {
@@ -353,41 +370,6 @@ int premiumLvlAddHellfire[] = {
 	// clang-format on
 };
 
-bool IsPrefixValidForItemType(int i, AffixItemType flgs, bool hellfireItem)
-{
-	AffixItemType itemTypes = ItemPrefixes[i].PLIType;
-
-	if (!hellfireItem) {
-		if (i > 82)
-			return false;
-
-		if (i >= 12 && i <= 20)
-			itemTypes &= ~AffixItemType::Staff;
-	}
-
-	return HasAnyOf(flgs, itemTypes);
-}
-
-bool IsSuffixValidForItemType(int i, AffixItemType flgs, bool hellfireItem)
-{
-	AffixItemType itemTypes = ItemSuffixes[i].PLIType;
-
-	if (!hellfireItem) {
-		if (i > 94)
-			return false;
-
-		if ((i >= 0 && i <= 1)
-		    || (i >= 14 && i <= 15)
-		    || (i >= 21 && i <= 22)
-		    || (i >= 34 && i <= 36)
-		    || (i >= 41 && i <= 44)
-		    || (i >= 60 && i <= 63))
-			itemTypes &= ~AffixItemType::Staff;
-	}
-
-	return HasAnyOf(flgs, itemTypes);
-}
-
 int ItemsGetCurrlevel()
 {
 	if (setlevel) {
@@ -1091,26 +1073,49 @@ void SaveItemAffix(const Player &player, Item &item, const PLStruct &affix)
 	}
 }
 
+/**
+ * @brief Returns the candidates with a PLMinLvl in [minlvl, maxlvl].
+ * @param candidates Candidates sorted by PLMinLvl
+ */
+AffixCandidateRange GetAffixCandidatesInLevelRange(const std::vector<AffixCandidate> &candidates, int minlvl, int maxlvl)
+{
+	const AffixCandidate *first = candidates.data();
+	const AffixCandidate *last = first + candidates.size();
+	const AffixCandidate *begin = std::lower_bound(first, last, minlvl,
+	    [](const AffixCandidate &candidate, int lvl) { return candidate.minLvl < lvl; });
+	const AffixCandidate *end = std::upper_bound(begin, last, maxlvl,
+	    [](int lvl, const AffixCandidate &candidate) { return lvl < candidate.minLvl; });
+	return { begin, end };
+}
+
+/**
+ * @brief Returns the affix that would be at position `n` if the candidates were listed in table order.
+ */
+int SelectNthAffix(uint16_t *candidates, int count, int n)
+{
+	std::nth_element(candidates, candidates + n, candidates + count);
+	return candidates[n];
+}
+
 int GetStaffPrefixId(int lvl, bool onlygood, bool hellfireItem)
 {
 	int preidx = -1;
 	if (FlipCoin(10) || onlygood) {
 		int nl = 0;
-		int l[256];
-		for (int j = 0, n = static_cast<int>(ItemPrefixes.size()); j < n; ++j) {
-			if (!IsPrefixValidForItemType(j, AffixItemType::Staff, hellfireItem) || ItemPrefixes[j].PLMinLvl > lvl)
-				continue;
-			if (onlygood && !ItemPrefixes[j].PLOk)
+		uint16_t l[512];
+		for (const AffixCandidate &candidate : GetAffixCandidatesInLevelRange(GetPrefixCandidates(AffixItemType::Staff, hellfireItem), INT8_MIN, lvl)) {
+			const PLStruct &prefix = ItemPrefixes[candidate.id];
+			if (onlygood && !prefix.PLOk)
 				continue;
-			l[nl] = j;
+			l[nl] = candidate.id;
 			nl++;
-			if (ItemPrefixes[j].PLDouble) {
-				l[nl] = j;
+			if (prefix.PLDouble) {
+				l[nl] = candidate.id;
 				nl++;
 			}
 		}
 		if (nl != 0) {
-			preidx = l[GenerateRnd(nl)];
+			preidx = SelectNthAffix(l, nl, GenerateRnd(nl));
 		}
 	}
 	return preidx;
@@ -1144,15 +1149,28 @@ std::string GenerateStaffNameMagical(const ItemData &baseItemData, SpellID spell
 	return identifiedName;
 }
 
-void GetStaffPower(const Player &player, Item &item, int lvl, SpellID bs, bool onlygood)
-{
-	int preidx = GetStaffPrefixId(lvl, onlygood, gbIsHellfire);
-	if (preidx != -1) {
-		item._iMagical = ITEM_QUALITY_MAGIC;
-		SaveItemAffix(player, item, ItemPrefixes[preidx]);
-		item._iPrePower = ItemPrefixes[preidx].power.type;
-	}
+/**
+ * @brief Affixes of an item that is named only once it has been accepted, see ApplyDeferredItemName.
+ *
+ * Naming measures the text width of the generated name, which is the most expensive part of rolling
+ * a magic item and doesn't use the RNG. Vendors that reroll their stock until an item fits their
+ * constraints use this to skip naming the candidates they throw away.
+ */
+struct DeferredItemName {
+	enum class Kind : uint8_t {
+		None,
+		Magic,
+		Staff,
+	};
+
+	Kind kind = Kind::None;
+	const PLStruct *prefix = nullptr;
+	const PLStruct *suffix = nullptr;
+	int staffPrefix = -1;
+};
 
+void SetStaffItemName(Item &item, int preidx)
+{
 	const ItemData &baseItemData = AllItemsList[item.IDidx];
 	std::string staffName = GenerateStaffName(baseItemData, item._iSpell, false);
 
@@ -1163,6 +1181,23 @@ void GetStaffPower(const Player &player, Item &item, int lvl, SpellID bs, bool o
 	} else {
 		CopyUtf8(item._iIName, item._iName, sizeof(item._iIName));
 	}
+}
+
+void GetStaffPower(const Player &player, Item &item, int lvl, SpellID bs, bool onlygood, DeferredItemName *deferredName = nullptr)
+{
+	int preidx = GetStaffPrefixId(lvl, onlygood, gbIsHellfire);
+	if (preidx != -1) {
+		item._iMagical = ITEM_QUALITY_MAGIC;
+		SaveItemAffix(player, item, ItemPrefixes[preidx]);
+		item._iPrePower = ItemPrefixes[preidx].power.type;
+	}
+
+	if (deferredName != nullptr) {
+		deferredName->kind = DeferredItemName::Kind::Staff;
+		deferredName->staffPrefix = preidx;
+	} else {
+		SetStaffItemName(item, preidx);
+	}
 
 	CalcItemValue(item);
 }
@@ -1183,12 +1218,15 @@ std::string GenerateMagicItemName(const std::string_view &baseNamel, const PLStr
 	return std::string(baseNamel);
 }
 
+} // namespace
+
 void GetItemPowerPrefixAndSuffix(int minlvl, int maxlvl, AffixItemType flgs, bool onlygood, bool hellfireItem, tl::function_ref<void(const PLStruct &prefix)> prefixFound, tl::function_ref<void(const PLStruct &suffix)> suffixFound)
 {
 	int preidx = -1;
 	int sufidx = -1;
 
-	int l[256];
+	// Candidates are collected sorted by level, SelectNthAffix picks the one that would be at the rolled position in table order.
+	uint16_t l[512];
 	goodorevil goe;
 
 	bool allocatePrefix = FlipCoin(4);
@@ -1205,47 +1243,67 @@ void GetItemPowerPrefixAndSuffix(int minlvl, int maxlvl, AffixItemType flgs, boo
 		onlygood = true;
 	if (allocatePrefix) {
 		int nt = 0;
-		for (int j = 0, n = static_cast<int>(ItemPrefixes.size()); j < n; ++j) {
-			if (!IsPrefixValidForItemType(j, flgs, hellfireItem))
-				continue;
-			if (ItemPrefixes[j].PLMinLvl < minlvl || ItemPrefixes[j].PLMinLvl > maxlvl)
-				continue;
-			if (onlygood && !ItemPrefixes[j].PLOk)
+		for (const AffixCandidate &candidate : GetAffixCandidatesInLevelRange(GetPrefixCandidates(flgs, hellfireItem), minlvl, maxlvl)) {
+			const PLStruct &prefix = ItemPrefixes[candidate.id];
+			if (onlygood && !prefix.PLOk)
 				continue;
-			if (HasAnyOf(flgs, AffixItemType::Staff) && ItemPrefixes[j].power.type == IPL_CHARGES)
+			if (HasAnyOf(flgs, AffixItemType::Staff) && prefix.power.type == IPL_CHARGES)
 				continue;
-			l[nt] = j;
+			l[nt] = candidate.id;
 			nt++;
-			if (ItemPrefixes[j].PLDouble) {
-				l[nt] = j;
+			if (prefix.PLDouble) {
+				l[nt] = candidate.id;
 				nt++;
 			}
 		}
 		if (nt != 0) {
-			preidx = l[GenerateRnd(nt)];
+			preidx = SelectNthAffix(l, nt, GenerateRnd(nt));
 			goe = ItemPrefixes[preidx].PLGOE;
 			prefixFound(ItemPrefixes[preidx]);
 		}
 	}
 	if (allocateSuffix) {
 		int nl = 0;
-		for (int j = 0, n = static_cast<int>(ItemSuffixes.size()); j < n; ++j) {
-			if (IsSuffixValidForItemType(j, flgs, hellfireItem)
-			    && ItemSuffixes[j].PLMinLvl >= minlvl && ItemSuffixes[j].PLMinLvl <= maxlvl
-			    && !((goe == GOE_GOOD && ItemSuffixes[j].PLGOE == GOE_EVIL) || (goe == GOE_EVIL && ItemSuffixes[j].PLGOE == GOE_GOOD))
-			    && (!onlygood || ItemSuffixes[j].PLOk)) {
-				l[nl] = j;
+		for (const AffixCandidate &candidate : GetAffixCandidatesInLevelRange(GetSuffixCandidates(flgs, hellfireItem), minlvl, maxlvl)) {
+			const PLStruct &suffix = ItemSuffixes[candidate.id];
+			if (!((goe == GOE_GOOD && suffix.PLGOE == GOE_EVIL) || (goe == GOE_EVIL && suffix.PLGOE == GOE_GOOD))
+			    && (!onlygood || suffix.PLOk)) {
+				l[nl] = candidate.id;
 				nl++;
 			}
 		}
 		if (nl != 0) {
-			sufidx = l[GenerateRnd(nl)];
+			sufidx = SelectNthAffix(l, nl, GenerateRnd(nl));
 			suffixFound(ItemSuffixes[sufidx]);
 		}
 	}
 }
 
-void GetItemPower(const Player &player, Item &item, int minlvl, int maxlvl, AffixItemType flgs, bool onlygood)
+namespace {
+
+void SetMagicItemName(Item &item, const PLStruct *pPrefix, const PLStruct *pSufix)
+{
+	CopyUtf8(item._iIName, GenerateMagicItemName(item._iName, pPrefix, pSufix, false), sizeof(item._iIName));
+	if (!StringInPanel(item._iIName)) {
+		CopyUtf8(item._iIName, GenerateMagicItemName(AllItemsList[item.IDidx].iSName, pPrefix, pSufix, false), sizeof(item._iIName));
+	}
+}
+
+void ApplyDeferredItemName(Item &item, const DeferredItemName &name)
+{
+	switch (name.kind) {
+	case DeferredItemName::Kind::None:
+		break;
+	case DeferredItemName::Kind::Magic:
+		SetMagicItemName(item, name.prefix, name.suffix);
+		break;
+	case DeferredItemName::Kind::Staff:
+		SetStaffItemName(item, name.staffPrefix);
+		break;
+	}
+}
+
+void GetItemPower(const Player &player, Item &item, int minlvl, int maxlvl, AffixItemType flgs, bool onlygood, DeferredItemName *deferredName = nullptr)
 {
 	const PLStruct *pPrefix = nullptr;
 	const PLStruct *pSufix = nullptr;
@@ -1264,18 +1322,21 @@ void GetItemPower(const Player &player, Item &item, int minlvl, int maxlvl, Affi
 		    pSufix = &suffix;
 	    });
 
-	CopyUtf8(item._iIName, GenerateMagicItemName(item._iName, pPrefix, pSufix, false), sizeof(item._iIName));
-	if (!StringInPanel(item._iIName)) {
-		CopyUtf8(item._iIName, GenerateMagicItemName(AllItemsList[item.IDidx].iSName, pPrefix, pSufix, false), sizeof(item._iIName));
+	if (deferredName != nullptr) {
+		deferredName->kind = DeferredItemName::Kind::Magic;
+		deferredName->prefix = pPrefix;
+		deferredName->suffix = pSufix;
+	} else {
+		SetMagicItemName(item, pPrefix, pSufix);
 	}
 	if (pPrefix != nullptr || pSufix != nullptr)
 		CalcItemValue(item);
 }
 
-void GetStaffSpell(const Player &player, Item &item, int lvl, bool onlygood)
+void GetStaffSpell(const Player &player, Item &item, int lvl, bool onlygood, DeferredItemName *deferredName = nullptr)
 {
 	if (!gbIsHellfire && FlipCoin(4)) {
-		GetItemPower(player, item, lvl / 2, lvl, AffixItemType::Staff, onlygood);
+		GetItemPower(player, item, lvl / 2, lvl, AffixItemType::Staff, onlygood, deferredName);
 		return;
 	}
 
@@ -1315,7 +1376,7 @@ void GetStaffSpell(const Player &player, Item &item, int lvl, bool onlygood)
 	int v = item._iCharges * GetSpellData(bs).staffCost() / 5;
 	item._ivalue += v;
 	item._iIvalue += v;
-	GetStaffPower(player, item, lvl, bs, onlygood);
+	GetStaffPower(player, item, lvl, bs, onlygood, deferredName);
 }
 
 void GetOilType(Item &item, int maxLvl)
@@ -1345,7 +1406,10 @@ void GetOilType(Item &item, int maxLvl)
 	item._iIvalue = OilValues[t];
 }
 
-void GetItemBonus(const Player &player, Item &item, int minlvl, int maxlvl, bool onlygood, bool allowspells)
+/**
+ * @param deferredName If set, receives the chosen affixes instead of the item being named, see DeferredItemName.
+ */
+void GetItemBonus(const Player &player, Item &item, int minlvl, int maxlvl, bool onlygood, bool allowspells, DeferredItemName *deferredName = nullptr)
 {
 	if (minlvl > 25)
 		minlvl = 25;
@@ -1354,29 +1418,29 @@ void GetItemBonus(const Player &player, Item &item, int minlvl, int maxlvl, bool
 	case ItemType::Sword:
 	case ItemType::Axe:
 	case ItemType::Mace:
-		GetItemPower(player, item, minlvl, maxlvl, AffixItemType::Weapon, onlygood);
+		GetItemPower(player, item, minlvl, maxlvl, AffixItemType::Weapon, onlygood, deferredName);
 		break;
 	case ItemType::Bow:
-		GetItemPower(player, item, minlvl, maxlvl, AffixItemType::Bow, onlygood);
+		GetItemPower(player, item, minlvl, maxlvl, AffixItemType::Bow, onlygood, deferredName);
 		break;
 	case ItemType::Shield:
-		GetItemPower(player, item, minlvl, maxlvl, AffixItemType::Shield, onlygood);
+		GetItemPower(player, item, minlvl, maxlvl, AffixItemType::Shield, onlygood, deferredName);
 		break;
 	case ItemType::LightArmor:
 	case ItemType::Helm:
 	case ItemType::MediumArmor:
 	case ItemType::HeavyArmor:
-		GetItemPower(player, item, minlvl, maxlvl, AffixItemType::Armor, onlygood);
+		GetItemPower(player, item, minlvl, maxlvl, AffixItemType::Armor, onlygood, deferredName);
 		break;
 	case ItemType::Staff:
 		if (allowspells)
-			GetStaffSpell(player, item, maxlvl, onlygood);
+			GetStaffSpell(player, item, maxlvl, onlygood, deferredName);
 		else
-			GetItemPower(player, item, minlvl, maxlvl, AffixItemType::Staff, onlygood);
+			GetItemPower(player, item, minlvl, maxlvl, AffixItemType::Staff, onlygood, deferredName);
 		break;
 	case ItemType::Ring:
 	case ItemType::Amulet:
-		GetItemPower(player, item, minlvl, maxlvl, AffixItemType::Misc, onlygood);
+		GetItemPower(player, item, minlvl, maxlvl, AffixItemType::Misc, onlygood, deferredName);
 		break;
 	case ItemType::None:
 	case ItemType::Misc:
@@ -1582,6 +1646,7 @@ void SetupBaseItem(Point position, _item_indexes idx, bool onlygood, bool sendms
 	int curlv = ItemsGetCurrlevel();
 
 	SetupAllItems(*MyPlayer, item, idx, AdvanceRndSeed(), 2 * curlv, 1, onlygood, false, delta);
+	LuaItemSpawnedEvent(item);
 
 	if (sendmsg)
 		NetSendCmdPItem(false, CMD_DROPITEM, item.position, item);
@@ -1993,6 +2058,46 @@ _item_indexes RndPremiumItem(const Player &player, int minlvl, int maxlvl)
 	return RndVendorItem<PremiumItemOk>(player, minlvl, maxlvl);
 }
 
+/**
+ * @brief Remembers the value of the player's most valuable item of each type while a vendor rerolls its stock.
+ */
+class MostValuablePlayerItemCache {
+public:
+	explicit MostValuablePlayerItemCache(const Player &player)
+	    : player_(player)
+	{
+	}
+
+	/**
+	 * @brief Returns the value of the player's most valuable item of the given type, or 0 if they have none.
+	 *
+	 * All body armor types are treated as one type.
+	 */
+	int GetValue(ItemType itemType)
+	{
+		const bool isArmor = IsAnyOf(itemType, ItemType::LightArmor, ItemType::MediumArmor, ItemType::HeavyArmor);
+		std::optional<int> &value = values_[static_cast<size_t>(isArmor ? ItemType::LightArmor : itemType)];
+		if (!value) {
+			const Item *mostValuableItem;
+			if (isArmor) {
+				mostValuableItem = player_.GetMostValuableItem(
+				    [](const Item &item) {
+					    return IsAnyOf(item._itype, ItemType::LightArmor, ItemType::MediumArmor, ItemType::HeavyArmor);
+				    });
+			} else {
+				mostValuableItem = player_.GetMostValuableItem(
+				    [itemType](const Item &item) { return item._itype == itemType; });
+			}
+			value = mostValuableItem == nullptr ? 0 : mostValuableItem->_iIvalue;
+		}
+		return *value;
+	}
+
+private:
+	const Player &player_;
+	std::array<std::optional<int>, static_cast<size_t>(ItemType::Amulet) + 1> values_;
+};
+
 void SpawnOnePremium(Item &premiumItem, int plvl, const Player &player)
 {
 	int strength = std::max(player.GetMaximumAttributeValue(CharacterAttribute::Strength), player._pStrength);
@@ -2004,6 +2109,8 @@ void SpawnOnePremium(Item &premiumItem, int plvl, const Player &player)
 
 	plvl = std::clamp(plvl, 1, 30);
 
+	MostValuablePlayerItemCache mostValuablePlayerItems { player };
+	DeferredItemName itemName;
 	int maxCount = 150;
 	const bool unlimited = !gbIsHellfire; // TODO: This could lead to an infinite loop if a suitable item can never be generated
 	for (int count = 0; unlimited || count < maxCount; count++) {
@@ -2012,7 +2119,8 @@ void SpawnOnePremium(Item &premiumItem, int plvl, const Player &player)
 		SetRndSeed(premiumItem._iSeed);
 		_item_indexes itemType = RndPremiumItem(player, plvl / 4, plvl);
 		GetItemAttrs(premiumItem, itemType, plvl);
-		GetItemBonus(player, premiumItem, plvl / 2, plvl, true, !gbIsHellfire);
+		itemName = {};
+		GetItemBonus(player, premiumItem, plvl / 2, plvl, true, !gbIsHellfire, &itemName);
 
 		if (!gbIsHellfire) {
 			if (premiumItem._iIvalue <= 140000) {
@@ -2023,15 +2131,7 @@ void SpawnOnePremium(Item &premiumItem, int plvl, const Player &player)
 			switch (premiumItem._itype) {
 			case ItemType::LightArmor:
 			case ItemType::MediumArmor:
-			case ItemType::HeavyArmor: {
-				const auto *const mostValuablePlayerArmor = player.GetMostValuableItem(
-				    [](const Item &item) {
-					    return IsAnyOf(item._itype, ItemType::LightArmor, ItemType::MediumArmor, ItemType::HeavyArmor);
-				    });
-
-				itemValue = mostValuablePlayerArmor == nullptr ? 0 : mostValuablePlayerArmor->_iIvalue;
-				break;
-			}
+			case ItemType::HeavyArmor:
 			case ItemType::Shield:
 			case ItemType::Axe:
 			case ItemType::Bow:
@@ -2040,13 +2140,9 @@ void SpawnOnePremium(Item &premiumItem, int plvl, const Player &player)
 			case ItemType::Helm:
 			case ItemType::Staff:
 			case ItemType::Ring:
-			case ItemType::Amulet: {
-				const auto *const mostValuablePlayerItem = player.GetMostValuableItem(
-				    [filterType = premiumItem._itype](const Item &item) { return item._itype == filterType; });
-
-				itemValue = mostValuablePlayerItem == nullptr ? 0 : mostValuablePlayerItem->_iIvalue;
+			case ItemType::Amulet:
+				itemValue = mostValuablePlayerItems.GetValue(premiumItem._itype);
 				break;
-			}
 			default:
 				itemValue = 0;
 				break;
@@ -2061,6 +2157,7 @@ void SpawnOnePremium(Item &premiumItem, int plvl, const Player &player)
 			}
 		}
 	}
+	ApplyDeferredItemName(premiumItem, itemName);
 	premiumItem._iCreateInfo = plvl | CF_SMITHPREMIUM;
 	premiumItem._iIdentified = true;
 	premiumItem._iStatFlag = player.CanUseItem(premiumItem);
@@ -2548,92 +2645,55 @@ void InitItems()
 	initItemGetRecords();
 }
 
-void CalcPlrItemVals(Player &player, bool loadgfx)
-{
-	int mind = 0; // min damage
-	int maxd = 0; // max damage
-	int tac = 0;  // accuracy
-
-	int bdam = 0;   // bonus damage
-	int btohit = 0; // bonus chance to hit
-	int bac = 0;    // bonus accuracy
-
-	ItemSpecialEffect iflgs = ItemSpecialEffect::None; // item_special_effect flags
+namespace {
 
-	ItemSpecialEffectHf pDamAcFlags = ItemSpecialEffectHf::None;
+/**
+ * @brief Derives the player's stats from the bonuses cached in equippedItemBonuses.
+ */
+void ApplyItemBonuses(Player &player, bool loadgfx)
+{
+	ItemBonuses bonuses;
+	for (const ItemBonuses &itemBonuses : player.equippedItemBonuses)
+		bonuses += itemBonuses;
 
-	int sadd = 0; // added strength
-	int madd = 0; // added magic
-	int dadd = 0; // added dexterity
-	int vadd = 0; // added vitality
+	int mind = bonuses.minDamage;
+	int maxd = bonuses.maxDamage;
+	const int tac = bonuses.armorClass;
 
-	uint64_t spl = 0; // bitarray for all enabled/active spells
+	const int bdam = bonuses.bonusDamage;
+	const int btohit = bonuses.bonusToHit;
+	const int bac = bonuses.bonusArmorClass;
 
-	int fr = 0; // fire resistance
-	int lr = 0; // lightning resistance
-	int mr = 0; // magic resistance
+	const ItemSpecialEffect iflgs = bonuses.flags;
 
-	int dmod = 0; // bonus damage mod?
-	int ghit = 0; // increased damage from enemies
+	const ItemSpecialEffectHf pDamAcFlags = bonuses.damAcFlags;
 
-	int lrad = 10; // light radius
+	int sadd = bonuses.strength;
+	int madd = bonuses.magic;
+	int dadd = bonuses.dexterity;
+	int vadd = bonuses.vitality;
 
-	int ihp = 0;   // increased HP
-	int imana = 0; // increased mana
+	const uint64_t spl = bonuses.spells;
 
-	int spllvladd = 0; // increased spell level
-	int enac = 0;      // enhanced accuracy
+	int fr = bonuses.fireResist;
+	int lr = bonuses.lightningResist;
+	int mr = bonuses.magicResist;
 
-	int fmin = 0; // minimum fire damage
-	int fmax = 0; // maximum fire damage
-	int lmin = 0; // minimum lightning damage
-	int lmax = 0; // maximum lightning damage
+	const int dmod = bonuses.damageMod;
+	const int ghit = bonuses.getHit;
 
-	for (auto &item : player.InvBody) {
-		if (!item.isEmpty() && item._iStatFlag) {
+	int lrad = 10 + bonuses.lightRadius; // light radius
 
-			mind += item._iMinDam;
-			maxd += item._iMaxDam;
-			tac += item._iAC;
+	int ihp = bonuses.hitPoints;
+	int imana = bonuses.mana;
 
-			if (IsValidSpell(item._iSpell)) {
-				spl |= GetSpellBitmask(item._iSpell);
-			}
+	const int spllvladd = bonuses.spellLevel;
+	const int enac = bonuses.enhancedAccuracy;
 
-			if (item._iMagical == ITEM_QUALITY_NORMAL || item._iIdentified) {
-				bdam += item._iPLDam;
-				btohit += item._iPLToHit;
-				if (item._iPLAC != 0) {
-					int tmpac = item._iAC;
-					tmpac *= item._iPLAC;
-					tmpac /= 100;
-					if (tmpac == 0)
-						tmpac = math::Sign(item._iPLAC);
-					bac += tmpac;
-				}
-				iflgs |= item._iFlags;
-				pDamAcFlags |= item._iDamAcFlags;
-				sadd += item._iPLStr;
-				madd += item._iPLMag;
-				dadd += item._iPLDex;
-				vadd += item._iPLVit;
-				fr += item._iPLFR;
-				lr += item._iPLLR;
-				mr += item._iPLMR;
-				dmod += item._iPLDamMod;
-				ghit += item._iPLGetHit;
-				lrad += item._iPLLight;
-				ihp += item._iPLHP;
-				imana += item._iPLMana;
-				spllvladd += item._iSplLvlAdd;
-				enac += item._iPLEnAc;
-				fmin += item._iFMinDam;
-				fmax += item._iFMaxDam;
-				lmin += item._iLMinDam;
-				lmax += item._iLMaxDam;
-			}
-		}
-	}
+	const int fmin = bonuses.fireMinDamage;
+	const int fmax = bonuses.fireMaxDamage;
+	const int lmin = bonuses.lightningMinDamage;
+	const int lmax = bonuses.lightningMaxDamage;
 
 	const uint8_t playerLevel = player.getCharacterLevel();
 
@@ -2897,6 +2957,115 @@ void CalcPlrItemVals(Player &player, bool loadgfx)
 	RedrawComponent(PanelDrawComponent::Health);
 }
 
+/**
+ * @brief Refreshes the stat flags of the carried items and everything depending on them after the player's stats changed.
+ */
+void UpdateCarriedItemStatFlags(Player &player)
+{
+	// Now that stat gains from equipped items have been calculated, mark unusable scrolls etc
+	for (Item &item : InventoryAndBeltPlayerItemsRange { player }) {
+		item.updateRequiredStatsCacheForPlayer(player);
+	}
+	player.CalcScrolls();
+	CalcPlrStaff(player);
+	if (IsStashOpen) {
+		// If stash is open, ensure the items are displayed correctly
+		Stash.RefreshItemStatFlags();
+	}
+	player.itemStatFlagsStats = { player._pStrength, player._pMagic, player._pDexterity };
+}
+
+} // namespace
+
+ItemBonuses &ItemBonuses::operator+=(const ItemBonuses &other)
+{
+	minDamage += other.minDamage;
+	maxDamage += other.maxDamage;
+	armorClass += other.armorClass;
+	bonusDamage += other.bonusDamage;
+	bonusToHit += other.bonusToHit;
+	bonusArmorClass += other.bonusArmorClass;
+	flags |= other.flags;
+	damAcFlags |= other.damAcFlags;
+	strength += other.strength;
+	magic += other.magic;
+	dexterity += other.dexterity;
+	vitality += other.vitality;
+	spells |= other.spells;
+	fireResist += other.fireResist;
+	lightningResist += other.lightningResist;
+	magicResist += other.magicResist;
+	damageMod += other.damageMod;
+	getHit += other.getHit;
+	lightRadius += other.lightRadius;
+	hitPoints += other.hitPoints;
+	mana += other.mana;
+	spellLevel += other.spellLevel;
+	enhancedAccuracy += other.enhancedAccuracy;
+	fireMinDamage += other.fireMinDamage;
+	fireMaxDamage += other.fireMaxDamage;
+	lightningMinDamage += other.lightningMinDamage;
+	lightningMaxDamage += other.lightningMaxDamage;
+	return *this;
+}
+
+ItemBonuses GetItemBonuses(const Item &item)
+{
+	ItemBonuses bonuses;
+	if (item.isEmpty() || !item._iStatFlag)
+		return bonuses;
+
+	bonuses.minDamage = item._iMinDam;
+	bonuses.maxDamage = item._iMaxDam;
+	bonuses.armorClass = item._iAC;
+
+	if (IsValidSpell(item._iSpell)) {
+		bonuses.spells = GetSpellBitmask(item._iSpell);
+	}
+
+	if (item._iMagical == ITEM_QUALITY_NORMAL || item._iIdentified) {
+		bonuses.bonusDamage = item._iPLDam;
+		bonuses.bonusToHit = item._iPLToHit;
+		if (item._iPLAC != 0) {
+			int tmpac = item._iAC;
+			tmpac *= item._iPLAC;
+			tmpac /= 100;
+			if (tmpac == 0)
+				tmpac = math::Sign(item._iPLAC);
+			bonuses.bonusArmorClass = tmpac;
+		}
+		bonuses.flags = item._iFlags;
+		bonuses.damAcFlags = item._iDamAcFlags;
+		bonuses.strength = item._iPLStr;
+		bonuses.magic = item._iPLMag;
+		bonuses.dexterity = item._iPLDex;
+		bonuses.vitality = item._iPLVit;
+		bonuses.fireResist = item._iPLFR;
+		bonuses.lightningResist = item._iPLLR;
+		bonuses.magicResist = item._iPLMR;
+		bonuses.damageMod = item._iPLDamMod;
+		bonuses.getHit = item._iPLGetHit;
+		bonuses.lightRadius = item._iPLLight;
+		bonuses.hitPoints = item._iPLHP;
+		bonuses.mana = item._iPLMana;
+		bonuses.spellLevel = item._iSplLvlAdd;
+		bonuses.enhancedAccuracy = item._iPLEnAc;
+		bonuses.fireMinDamage = item._iFMinDam;
+		bonuses.fireMaxDamage = item._iFMaxDam;
+		bonuses.lightningMinDamage = item._iLMinDam;
+		bonuses.lightningMaxDamage = item._iLMaxDam;
+	}
+	return bonuses;
+}
+
+void CalcPlrItemVals(Player &player, bool loadgfx)
+{
+	for (size_t i = 0; i < NUM_INVLOC; i++) {
+		player.equippedItemBonuses[i] = GetItemBonuses(player.InvBody[i]);
+	}
+	ApplyItemBonuses(player, loadgfx);
+}
+
 void CalcPlrInv(Player &player, bool loadgfx)
 {
 	// Determine the players current stats, this updates the statFlag on all equipped items that became unusable after
@@ -2911,15 +3080,38 @@ void CalcPlrInv(Player &player, bool loadgfx)
 	CalcPlrItemVals(player, loadgfx);
 
 	if (&player == MyPlayer) {
-		// Now that stat gains from equipped items have been calculated, mark unusable scrolls etc
-		for (Item &item : InventoryAndBeltPlayerItemsRange { player }) {
-			item.updateRequiredStatsCacheForPlayer(player);
-		}
-		player.CalcScrolls();
-		CalcPlrStaff(player);
-		if (IsStashOpen) {
-			// If stash is open, ensure the items are displayed correctly
-			Stash.RefreshItemStatFlags();
+		UpdateCarriedItemStatFlags(player);
+	}
+}
+
+void CalcPlrInvAfterEquip(Player &player, std::initializer_list<inv_body_loc> bodyLocations, bool loadgfx)
+{
+	std::array<bool, NUM_INVLOC> wasUsable;
+	for (size_t i = 0; i < NUM_INVLOC; i++) {
+		wasUsable[i] = player.InvBody[i]._iStatFlag;
+	}
+	CalcSelfItems(player);
+
+	// Only slots that changed or whose requirements flipped because of the new stats contribute something different
+	for (size_t i = 0; i < NUM_INVLOC; i++) {
+		if (player.InvBody[i]._iStatFlag != wasUsable[i])
+			player.equippedItemBonuses[i] = GetItemBonuses(player.InvBody[i]);
+	}
+	for (inv_body_loc bodyLocation : bodyLocations) {
+		player.equippedItemBonuses[bodyLocation] = GetItemBonuses(player.InvBody[bodyLocation]);
+	}
+
+	if (&player != MyPlayer && !player.isOnActiveLevel()) {
+		// Ensure we don't load graphics for players that aren't on our level
+		loadgfx = false;
+	}
+	ApplyItemBonuses(player, loadgfx);
+
+	if (&player == MyPlayer) {
+		if (player.itemStatFlagsStats != std::array<int, 3> { player._pStrength, player._pMagic, player._pDexterity }) {
+			UpdateCarriedItemStatFlags(player);
+		} else {
+			CalcPlrStaff(player);
 		}
 	}
 }
@@ -3000,6 +3192,7 @@ void CreatePlrItems(Player &player)
 	for (auto &item : player.InvBody) {
 		item.clear();
 	}
+	player.equippedItemBonuses = {};
 
 	// converting this to a for loop creates a `rep stosd` instruction,
 	// so this probably actually was a memset
@@ -3199,7 +3392,9 @@ void GetItemAttrs(Item &item, _item_indexes itemData, int lvl)
 
 			for (uint8_t manaPotion : manaPotions) {
 				if (manaPotion == item._iCurs) {
-					const int xed = (int)round(item._ivalue * 2 > initVal * 2.5 ? initVal * 2.5 - 50 : item._ivalue * 2);
+					// Capped at 2.5 times the base value minus 50, rounded half away from zero
+					const int cap = initVal * 5 - 100;
+					const int xed = item._ivalue * 4 > initVal * 5 ? (cap >= 0 ? cap + 1 : cap - 1) / 2 : item._ivalue * 2;
 					item._ivalue = xed;
 					item._iIvalue = xed;
 					break;
@@ -3269,6 +3464,7 @@ Item *SpawnUnique(_unique_items uid, Point position, std::optional<int> level /*
 		});
 		SetupAllItems(*MyPlayer, item, idx, AdvanceRndSeed(), curlv * 2, 15, true, false, false);
 	}
+	LuaItemSpawnedEvent(item);
 
 	if (sendmsg)
 		NetSendCmdPItem(false, CMD_SPAWNITEM, item.position, item);
@@ -3330,6 +3526,7 @@ void SpawnItem(Monster &monster, Point position, bool sendmsg, bool spawn /*= fa
 		mLevel -= 15;
 
 	SetupAllItems(*MyPlayer, item, idx, AdvanceRndSeed(), mLevel, uper, onlygood, false, false);
+	LuaItemSpawnedEvent(item);
 
 	if (sendmsg)
 		NetSendCmdPItem(false, CMD_DROPITEM, item.position, item);
@@ -3355,6 +3552,7 @@ void CreateRndUseful(Point position, bool sendmsg)
 	int curlv = ItemsGetCurrlevel();
 
 	SetupAllUseful(item, AdvanceRndSeed(), curlv);
+	LuaItemSpawnedEvent(item);
 	if (sendmsg)
 		NetSendCmdPItem(false, CMD_DROPITEM, item.position, item);
 }
@@ -3646,6 +3844,7 @@ void ProcessItems()
 
 void FreeItemGFX()
 {
+	ClearClxHitMaskCache();
 	for (auto &itemanim : itemanims) {
 		itemanim = std::nullopt;
 	}
@@ -4343,6 +4542,7 @@ void SpawnWitch(int lvl)
 			continue;
 		}
 
+		DeferredItemName itemName;
 		do {
 			item = {};
 			item._iSeed = AdvanceRndSeed();
@@ -4354,10 +4554,12 @@ void SpawnWitch(int lvl)
 				maxlvl = 2 * lvl;
 			if (maxlvl == -1 && item._iMiscId == IMISC_STAFF)
 				maxlvl = 2 * lvl;
+			itemName = {};
 			if (maxlvl != -1)
-				GetItemBonus(*MyPlayer, item, maxlvl / 2, maxlvl, true, true);
+				GetItemBonus(*MyPlayer, item, maxlvl / 2, maxlvl, true, true, &itemName);
 		} while (item._iIvalue > maxValue);
 
+		ApplyDeferredItemName(item, itemName);
 		item._iCreateInfo = lvl | CF_WITCH;
 		item._iIdentified = true;
 	}
@@ -4383,6 +4585,8 @@ void SpawnBoy(int lvl)
 
 	if (boylevel >= (lvl / 2) && !boyitem.isEmpty())
 		return;
+	MostValuablePlayerItemCache mostValuablePlayerItems { myPlayer };
+	DeferredItemName itemName;
 	do {
 		keepgoing = false;
 		boyitem = {};
@@ -4390,7 +4594,8 @@ void SpawnBoy(int lvl)
 		SetRndSeed(boyitem._iSeed);
 		_item_indexes itype = RndBoyItem(*MyPlayer, lvl);
 		GetItemAttrs(boyitem, itype, lvl);
-		GetItemBonus(*MyPlayer, boyitem, lvl, 2 * lvl, true, true);
+		itemName = {};
+		GetItemBonus(*MyPlayer, boyitem, lvl, 2 * lvl, true, true, &itemName);
 
 		if (!gbIsHellfire) {
 			if (boyitem._iIvalue > 90000) {
@@ -4407,15 +4612,7 @@ void SpawnBoy(int lvl)
 		switch (itemType) {
 		case ItemType::LightArmor:
 		case ItemType::MediumArmor:
-		case ItemType::HeavyArmor: {
-			const auto *const mostValuablePlayerArmor = myPlayer.GetMostValuableItem(
-			    [](const Item &item) {
-				    return IsAnyOf(item._itype, ItemType::LightArmor, ItemType::MediumArmor, ItemType::HeavyArmor);
-			    });
-
-			ivalue = mostValuablePlayerArmor == nullptr ? 0 : mostValuablePlayerArmor->_iIvalue;
-			break;
-		}
+		case ItemType::HeavyArmor:
 		case ItemType::Shield:
 		case ItemType::Axe:
 		case ItemType::Bow:
@@ -4424,13 +4621,9 @@ void SpawnBoy(int lvl)
 		case ItemType::Helm:
 		case ItemType::Staff:
 		case ItemType::Ring:
-		case ItemType::Amulet: {
-			const auto *const mostValuablePlayerItem = myPlayer.GetMostValuableItem(
-			    [itemType](const Item &item) { return item._itype == itemType; });
-
-			ivalue = mostValuablePlayerItem == nullptr ? 0 : mostValuablePlayerItem->_iIvalue;
+		case ItemType::Amulet:
+			ivalue = mostValuablePlayerItems.GetValue(itemType);
 			break;
-		}
 		default:
 			app_fatal("Invalid item spawn");
 		}
@@ -4474,6 +4667,7 @@ void SpawnBoy(int lvl)
 	            || boyitem._iMinDex > dexterity
 	            || boyitem._iIvalue < ivalue)
 	        && count < 250));
+	ApplyDeferredItemName(boyitem, itemName);
 	boyitem._iCreateInfo = lvl | CF_BOY;
 	boyitem._iIdentified = true;
 	boylevel = lvl / 2;
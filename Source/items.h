@@ -6,8 +6,11 @@
 #pragma once
 
 #include <cstdint>
+#include <initializer_list>
 #include <optional>
 
+#include <function_ref.hpp>
+
 #include "DiabloUI/ui_flags.hpp"
 #include "engine.h"
 #include "engine/animationinfo.h"
@@ -174,6 +177,7 @@ constexpr int ItemAnimWidth = 96;
 
 // Defined in player.h, forward declared here to allow for functions which operate in the context of a player.
 struct Player;
+enum inv_body_loc : uint8_t;
 
 struct Item {
 	/** Randomly generated identifier */
@@ -482,6 +486,48 @@ extern bool ShowUniqueItemInfoBox;
 extern CornerStoneStruct CornerStone;
 extern bool UniqueItemFlags[128];
 
+/**
+ * @brief Stat bonuses of a single equipped item, adding them up for all usable equipment gives the player's item bonuses.
+ */
+struct ItemBonuses {
+	int minDamage = 0;
+	int maxDamage = 0;
+	int armorClass = 0;
+	int bonusDamage = 0;
+	int bonusToHit = 0;
+	int bonusArmorClass = 0;
+	ItemSpecialEffect flags = ItemSpecialEffect::None;
+	ItemSpecialEffectHf damAcFlags = ItemSpecialEffectHf::None;
+	int strength = 0;
+	int magic = 0;
+	int dexterity = 0;
+	int vitality = 0;
+	/** @brief Bitmask of the spells the items grant */
+	uint64_t spells = 0;
+	int fireResist = 0;
+	int lightningResist = 0;
+	int magicResist = 0;
+	int damageMod = 0;
+	int getHit = 0;
+	int lightRadius = 0;
+	int hitPoints = 0;
+	int mana = 0;
+	int spellLevel = 0;
+	int enhancedAccuracy = 0;
+	int fireMinDamage = 0;
+	int fireMaxDamage = 0;
+	int lightningMinDamage = 0;
+	int lightningMaxDamage = 0;
+
+	ItemBonuses &operator+=(const ItemBonuses &other);
+	bool operator==(const ItemBonuses &other) const = default;
+};
+
+/**
+ * @brief Returns the bonuses an equipped item grants, nothing if it is empty or its requirements aren't met.
+ */
+ItemBonuses GetItemBonuses(const Item &item);
+
 uint8_t GetOutlineColor(const Item &item, bool checkReq);
 bool IsItemAvailable(int i);
 bool IsUniqueAvailable(int i);
@@ -489,6 +535,17 @@ void InitItemGFX();
 void InitItems();
 void CalcPlrItemVals(Player &player, bool Loadgfx);
 void CalcPlrInv(Player &player, bool Loadgfx);
+/**
+ * @brief Updates the player's stats after the items in some of the body slots changed.
+ *
+ * Same result as CalcPlrInv() as long as nothing else about the player's items changed since the last calculation, but
+ * only re-evaluates the given slots and the ones whose requirements are no longer met (or now are). The stat flags of the
+ * carried items are only refreshed if strength, magic or dexterity changed.
+ * @param player The player whose equipment changed
+ * @param bodyLocations Slots that have been equipped, cleared or swapped
+ * @param loadgfx Whether to load the graphics for a changed weapon or armor look
+ */
+void CalcPlrInvAfterEquip(Player &player, std::initializer_list<inv_body_loc> bodyLocations, bool loadgfx);
 void InitializeItem(Item &item, _item_indexes itemData);
 void GenerateNewSeed(Item &h);
 int GetGoldCursor(int value);
@@ -511,6 +568,17 @@ void PopItem(Item &item);
 uint8_t PlaceItemInWorld(Item &&item, WorldTilePosition position);
 Point GetSuperItemLoc(Point position);
 void GetItemAttrs(Item &item, _item_indexes itemData, int lvl);
+/**
+ * @brief Rolls a prefix and/or suffix for a magic item.
+ * @param minlvl Minimum affix level
+ * @param maxlvl Maximum affix level
+ * @param flgs Item types the affix must be valid for
+ * @param onlygood Only roll useful affixes
+ * @param hellfireItem Include affixes that only exist in Hellfire
+ * @param prefixFound Called with the chosen prefix, if any
+ * @param suffixFound Called with the chosen suffix, if any
+ */
+void GetItemPowerPrefixAndSuffix(int minlvl, int maxlvl, AffixItemType flgs, bool onlygood, bool hellfireItem, tl::function_ref<void(const PLStruct &prefix)> prefixFound, tl::function_ref<void(const PLStruct &suffix)> suffixFound);
 void SetupItem(Item &item);
 Item *SpawnUnique(_unique_items uid, Point position, std::optional<int> level = std::nullopt, bool sendmsg = true, bool exactPosition = false);
 void SpawnItem(Monster &monster, Point position, bool sendmsg, bool spawn = false);
@@ -1248,17 +1248,17 @@ void PlaceMiniSetRandom(const Miniset &miniset, int rndper)
 {
 	const WorldTileCoord sw = miniset.size.width;
 	const WorldTileCoord sh = miniset.size.height;
+	const WorldTileCoord endX = DMAXX - sw;
+	MinisetMatcher matcher(miniset, false);
 
 	for (WorldTileCoord sy = 0; sy < DMAXY - sh; sy++) {
-		for (WorldTileCoord sx = 0; sx < DMAXX - sw; sx++) {
-			if (!miniset.matches({ sx, sy }, false))
-				continue;
+		for (WorldTileCoord sx = matcher.nextMatch({ 0, sy }, endX); sx < endX; sx = matcher.nextMatch({ static_cast<WorldTileCoord>(sx + 1), sy }, endX)) {
 			// BUGFIX: This code is copied from Cave and should not be applied for crypt
 			if (!CanReplaceTile(miniset.replace[0][0], { sx, sy }))
 				continue;
 			if (GenerateRnd(100) >= rndper)
 				continue;
-			miniset.place({ sx, sy });
+			matcher.place({ sx, sy });
 		}
 	}
 }
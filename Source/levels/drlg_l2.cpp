@@ -1599,13 +1599,13 @@ void PlaceMiniSetRandom(const Miniset &miniset, int rndper)
 {
 	const WorldTileCoord sw = miniset.size.width;
 	const WorldTileCoord sh = miniset.size.height;
+	const WorldTileCoord endX = DMAXX - sw;
+	MinisetMatcher matcher(miniset);
 
 	for (WorldTileCoord sy = 0; sy < DMAXY - sh; sy++) {
-		for (WorldTileCoord sx = 0; sx < DMAXX - sw; sx++) {
+		for (WorldTileCoord sx = matcher.nextMatch({ 0, sy }, endX); sx < endX; sx = matcher.nextMatch({ static_cast<WorldTileCoord>(sx + 1), sy }, endX)) {
 			if (SetPieceRoom.contains(sx, sy))
 				continue;
-			if (!miniset.matches({ sx, sy }))
-				continue;
 			bool found = true;
 			for (int yy = std::max(sy - sh, 0); yy < std::min(sy + 2 * sh, DMAXY) && found; yy++) {
 				for (int xx = std::max(sx - sw, 0); xx < std::min(sx + 2 * sw, DMAXX); xx++) {
@@ -1619,7 +1619,7 @@ void PlaceMiniSetRandom(const Miniset &miniset, int rndper)
 				continue;
 			if (GenerateRnd(100) >= rndper)
 				continue;
-			miniset.place({ sx, sy });
+			matcher.place({ sx, sy });
 		}
 	}
 }
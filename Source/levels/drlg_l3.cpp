@@ -1392,18 +1392,18 @@ bool PlaceMiniSetRandom(const Miniset &miniset, int rndper)
 {
 	const WorldTileCoord sw = miniset.size.width;
 	const WorldTileCoord sh = miniset.size.height;
+	const WorldTileCoord endX = DMAXX - sw;
+	MinisetMatcher matcher(miniset);
 
 	bool placed = false;
 	for (WorldTileCoord sy = 0; sy < DMAXY - sh; sy++) {
-		for (WorldTileCoord sx = 0; sx < DMAXX - sw; sx++) {
-			if (!miniset.matches({ sx, sy }))
-				continue;
+		for (WorldTileCoord sx = matcher.nextMatch({ 0, sy }, endX); sx < endX; sx = matcher.nextMatch({ static_cast<WorldTileCoord>(sx + 1), sy }, endX)) {
 			// BUGFIX: This should not be applied to Nest levels
 			if (!CanReplaceTile(miniset.replace[0][0], { sx, sy }))
 				continue;
 			if (GenerateRnd(100) >= rndper)
 				continue;
-			miniset.place({ sx, sy });
+			matcher.place({ sx, sy });
 			placed = true;
 		}
 	}
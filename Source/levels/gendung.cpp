@@ -1,5 +1,7 @@
 #include "levels/gendung.h"
 
+#include <algorithm>
+#include <bit>
 #include <cstdint>
 #include <stack>
 #include <vector>
@@ -24,8 +26,9 @@ Bitset2d<DMAXX, DMAXY> Protected;
 WorldTileRectangle SetPieceRoom;
 WorldTileRectangle SetPiece;
 OptionalOwnedClxSpriteList pSpecialCels;
-std::unique_ptr<MegaTile[]> pMegaTiles;
-std::unique_ptr<std::byte[]> pDungeonCels;
+Arena LevelArena;
+MegaTile *pMegaTiles;
+std::byte *pDungeonCels;
 TileProperties SOLData[MAXTILES];
 WorldTilePosition dminPosition;
 WorldTilePosition dmaxPosition;
@@ -582,12 +585,93 @@ void Make_SetPC(WorldTileRectangle area)
 	}
 }
 
+MinisetMatcher::MinisetMatcher(const Miniset &miniset, bool respectProtected)
+    : miniset_(miniset)
+{
+	maskIndex_.fill(NoMask);
+	for (WorldTileCoord yy = 0; yy < miniset.size.height; yy++) {
+		for (WorldTileCoord xx = 0; xx < miniset.size.width; xx++) {
+			const uint8_t tile = miniset.search[yy][xx];
+			if (tile != 0 && maskIndex_[tile] == NoMask) {
+				maskIndex_[tile] = static_cast<uint8_t>(tileMasks_.size());
+				tileMasks_.emplace_back();
+			}
+		}
+	}
+
+	for (RowMasks &masks : tileMasks_)
+		masks.fill(0);
+	unprotected_.fill(0);
+	for (WorldTileCoord y = 0; y < DMAXY; y++) {
+		for (WorldTileCoord x = 0; x < DMAXX; x++) {
+			const uint64_t bit = uint64_t { 1 } << x;
+			const uint8_t index = maskIndex_[dungeon[x][y]];
+			if (index != NoMask)
+				tileMasks_[index][y] |= bit;
+			if (!respectProtected || !Protected.test(x, y))
+				unprotected_[y] |= bit;
+		}
+	}
+}
+
+uint64_t MinisetMatcher::matchesInRow(WorldTileCoord y) const
+{
+	// Only the columns where the miniset fits inside the dungeon
+	uint64_t result = (uint64_t { 1 } << (DMAXX - miniset_.size.width + 1)) - 1;
+	for (WorldTileCoord yy = 0; yy < miniset_.size.height; yy++) {
+		const WorldTileCoord row = y + yy;
+		for (WorldTileCoord xx = 0; xx < miniset_.size.width; xx++) {
+			uint64_t cells = unprotected_[row];
+			const uint8_t tile = miniset_.search[yy][xx];
+			if (tile != 0)
+				cells &= tileMasks_[maskIndex_[tile]][row];
+			result &= cells >> xx;
+		}
+	}
+	return result;
+}
+
+WorldTileCoord MinisetMatcher::nextMatch(WorldTilePosition position, WorldTileCoord endX) const
+{
+	if (position.x >= endX)
+		return endX;
+	const uint64_t candidates = matchesInRow(position.y) >> position.x;
+	if (candidates == 0)
+		return endX;
+	return std::min<WorldTileCoord>(position.x + std::countr_zero(candidates), endX);
+}
+
+void MinisetMatcher::place(WorldTilePosition position)
+{
+	for (WorldTileCoord y = 0; y < miniset_.size.height; y++) {
+		for (WorldTileCoord x = 0; x < miniset_.size.width; x++) {
+			const uint8_t tile = miniset_.replace[y][x];
+			if (tile == 0)
+				continue;
+			const WorldTileCoord row = position.y + y;
+			const uint64_t bit = uint64_t { 1 } << (position.x + x);
+			const uint8_t oldIndex = maskIndex_[dungeon[position.x + x][row]];
+			if (oldIndex != NoMask)
+				tileMasks_[oldIndex][row] &= ~bit;
+			const uint8_t newIndex = maskIndex_[tile];
+			if (newIndex != NoMask)
+				tileMasks_[newIndex][row] |= bit;
+		}
+	}
+	miniset_.place(position);
+}
+
 std::optional<Point> PlaceMiniSet(const Miniset &miniset, int tries, bool drlg1Quirk)
 {
 	int sw = miniset.size.width;
 	int sh = miniset.size.height;
 	Point position { GenerateRnd(DMAXX - sw), GenerateRnd(DMAXY - sh) };
 
+	const MinisetMatcher matcher(miniset);
+	std::array<uint64_t, DMAXY> matchingColumns;
+	for (WorldTileCoord y = 0; y < DMAXY - sh; y++)
+		matchingColumns[y] = matcher.matchesInRow(y);
+
 	for (int i = 0; i < tries; i++, position.x++) {
 		if (position.x == DMAXX - sw) {
 			position.x = 0;
@@ -615,7 +699,7 @@ std::optional<Point> PlaceMiniSet(const Miniset &miniset, int tries, bool drlg1Q
 
 		if (SetPieceRoom.contains(position))
 			continue;
-		if (!miniset.matches(position))
+		if ((matchingColumns[position.y] & (uint64_t { 1 } << position.x)) == 0)
 			continue;
 
 		miniset.place(position);
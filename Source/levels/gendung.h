@@ -5,9 +5,11 @@
  */
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include "engine/clx_sprite.hpp"
 #include "engine/point.hpp"
@@ -15,6 +17,7 @@
 #include "engine/render/scrollrt.h"
 #include "engine/world_tile.hpp"
 #include "levels/dun_tile.hpp"
+#include "utils/arena.hpp"
 #include "utils/attributes.h"
 #include "utils/bitset2d.hpp"
 #include "utils/enum_traits.h"
@@ -154,14 +157,22 @@ extern DVL_API_FOR_TEST uint8_t dungeon[DMAXX][DMAXY];
 /** Contains a backup of the tile IDs of the map. */
 extern uint8_t pdungeon[DMAXX][DMAXY];
 /** Tile that may not be overwritten by the level generator */
-extern Bitset2d<DMAXX, DMAXY> Protected;
+extern DVL_API_FOR_TEST Bitset2d<DMAXX, DMAXY> Protected;
 extern WorldTileRectangle SetPieceRoom;
 /** Specifies the active set quest piece in coordinate. */
 extern WorldTileRectangle SetPiece;
 extern OptionalOwnedClxSpriteList pSpecialCels;
 /** Specifies the tile definitions of the active dungeon type; (e.g. levels/l1data/l1.til). */
-extern DVL_API_FOR_TEST std::unique_ptr<MegaTile[]> pMegaTiles;
-extern std::unique_ptr<std::byte[]> pDungeonCels;
+/**
+ * @brief Owns the dungeon tile and monster graphics of the current level.
+ *
+ * Reset by FreeGameMem, which invalidates everything allocated from it.
+ */
+extern DVL_API_FOR_TEST Arena LevelArena;
+/** Allocated from LevelArena. */
+extern DVL_API_FOR_TEST MegaTile *pMegaTiles;
+/** Allocated from LevelArena. */
+extern std::byte *pDungeonCels;
 /**
  * List tile properties
  */
@@ -205,7 +216,7 @@ extern int8_t dPlayer[MAXDUNX][MAXDUNY];
  * (monsters array index) in the dungeon.
  * Negative id indicates monsters moving.
  */
-extern int16_t dMonster[MAXDUNX][MAXDUNY];
+extern DVL_API_FOR_TEST int16_t dMonster[MAXDUNX][MAXDUNY];
 /**
  * Contains the dead numbers (deads array indices) and dead direction of
  * the map, encoded as specified by the pseudo-code below.
@@ -332,6 +343,47 @@ struct Miniset {
 	}
 };
 
+/**
+ * @brief Finds where a miniset matches by intersecting one bitmask per dungeon row for each tile it searches for,
+ * instead of comparing the dungeon tile by tile.
+ *
+ * The masks are built from dungeon and Protected when the matcher is created, while it is in use the dungeon must only
+ * be changed through place().
+ */
+class MinisetMatcher {
+public:
+	/**
+	 * @param respectProtected Match bug from Crypt levels if false, see Miniset::matches
+	 */
+	explicit MinisetMatcher(const Miniset &miniset, bool respectProtected = true);
+
+	/**
+	 * @brief Bit x is set if the miniset matches at (x, y), y must leave room for the height of the miniset.
+	 */
+	[[nodiscard]] uint64_t matchesInRow(WorldTileCoord y) const;
+
+	/**
+	 * @brief Finds the first column from position.x up to but not including endX where the miniset matches.
+	 * @return The column of the match, or endX if there is none
+	 */
+	[[nodiscard]] WorldTileCoord nextMatch(WorldTilePosition position, WorldTileCoord endX) const;
+
+	/** @brief Places the miniset and updates the masks to match the new tiles. */
+	void place(WorldTilePosition position);
+
+private:
+	using RowMasks = std::array<uint64_t, DMAXY>;
+	static constexpr uint8_t NoMask = 0xFF;
+
+	const Miniset &miniset_;
+	/** @brief Index into tileMasks_ for each tile, NoMask for the tiles the miniset doesn't search for. */
+	std::array<uint8_t, 256> maskIndex_;
+	/** @brief Bit x of row y is set where dungeon[x][y] is the tile. */
+	std::vector<RowMasks> tileMasks_;
+	/** @brief Bit x of row y is set where the tile may be replaced. */
+	RowMasks unprotected_;
+};
+
 [[nodiscard]] DVL_ALWAYS_INLINE bool TileHasAny(int tileId, TileProperties property)
 {
 	return HasAnyOf(SOLData[tileId], property);
@@ -5,7 +5,11 @@
  */
 #include "levels/themes.h"
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <optional>
+#include <vector>
 
 #include <fmt/core.h>
 
@@ -41,10 +45,100 @@ int themex;
 int themey;
 size_t themeVar1;
 
+/**
+ * @brief Where each dTransVal region lies, shared by the theme fit checks so that they only look at the tiles of their
+ * own region instead of the whole map.
+ */
+class ThemeRegionMap {
+public:
+	/**
+	 * @brief Finds the bounds of every region, the map stays valid for as long as dTransVal and dPiece don't change.
+	 */
+	void Build()
+	{
+		std::array<Point, 256> min;
+		std::array<Point, 256> max;
+		min.fill({ MAXDUNX, MAXDUNY });
+		max.fill({ -1, -1 });
+		for (int y = 0; y < MAXDUNY; y++) {
+			for (int x = 0; x < MAXDUNX; x++) {
+				const auto regionId = static_cast<uint8_t>(dTransVal[x][y]);
+				min[regionId].x = std::min(min[regionId].x, x);
+				min[regionId].y = std::min(min[regionId].y, y);
+				max[regionId].x = std::max(max[regionId].x, x);
+				max[regionId].y = std::max(max[regionId].y, y);
+			}
+		}
+		for (size_t i = 0; i < bounds_.size(); i++) {
+			if (max[i].x < 0)
+				bounds_[i] = {};
+			else
+				bounds_[i] = { min[i], Size { max[i].x - min[i].x + 1, max[i].y - min[i].y + 1 } };
+		}
+		freeTilesRegion_ = std::nullopt;
+	}
+
+	/** @brief Smallest rectangle containing every tile of the region, empty if it has none. */
+	[[nodiscard]] Rectangle bounds(int8_t regionId) const
+	{
+		return bounds_[static_cast<uint8_t>(regionId)];
+	}
+
+	/** @brief Counts the tiles in the area that belong to the region and are not solid. */
+	int CountFreeTiles(int8_t regionId, Rectangle area)
+	{
+		const Rectangle regionBounds = bounds(regionId);
+		if (freeTilesRegion_ != regionId)
+			BuildFreeTiles(regionId, regionBounds);
+
+		// Tiles outside the bounds are never part of the region
+		const int left = std::max(area.position.x, regionBounds.position.x) - regionBounds.position.x;
+		const int top = std::max(area.position.y, regionBounds.position.y) - regionBounds.position.y;
+		const int right = std::min(area.position.x + area.size.width, regionBounds.position.x + regionBounds.size.width) - regionBounds.position.x;
+		const int bottom = std::min(area.position.y + area.size.height, regionBounds.position.y + regionBounds.size.height) - regionBounds.position.y;
+		if (left >= right || top >= bottom)
+			return 0;
+		const int stride = regionBounds.size.width + 1;
+		return freeTiles_[bottom * stride + right] - freeTiles_[bottom * stride + left]
+		    - freeTiles_[top * stride + right] + freeTiles_[top * stride + left];
+	}
+
+private:
+	void BuildFreeTiles(int8_t regionId, Rectangle regionBounds)
+	{
+		const int stride = regionBounds.size.width + 1;
+		freeTiles_.assign(static_cast<size_t>(stride) * (regionBounds.size.height + 1), 0);
+		for (int y = 0; y < regionBounds.size.height; y++) {
+			uint16_t rowFree = 0;
+			for (int x = 0; x < regionBounds.size.width; x++) {
+				const Point tile = regionBounds.position + Displacement { x, y };
+				if (dTransVal[tile.x][tile.y] == regionId && IsTileNotSolid(tile))
+					rowFree++;
+				freeTiles_[(y + 1) * stride + x + 1] = freeTiles_[y * stride + x + 1] + rowFree;
+			}
+		}
+		freeTilesRegion_ = regionId;
+	}
+
+	std::array<Rectangle, 256> bounds_;
+	/** @brief Region freeTiles_ was built for. */
+	std::optional<int8_t> freeTilesRegion_;
+	/** @brief Summed-area table over the bounds of freeTilesRegion_ of the tiles in the region that are not solid. */
+	std::vector<uint16_t> freeTiles_;
+};
+
+ThemeRegionMap ThemeRegions;
+
 bool TFit_Shrine(int i)
 {
-	int xp = 0;
-	int yp = 0;
+	// Tiles outside the region never fit, so the scan only has to cover its bounds
+	const Rectangle bounds = ThemeRegions.bounds(themes[i].ttval);
+	if (bounds.size.width == 0)
+		return false;
+	const int endX = bounds.position.x + bounds.size.width;
+	const int endY = bounds.position.y + bounds.size.height;
+	int xp = bounds.position.x;
+	int yp = bounds.position.y;
 	size_t found = 0;
 
 	while (found == 0) {
@@ -72,10 +166,10 @@ bool TFit_Shrine(int i)
 		}
 		if (found == 0) {
 			xp++;
-			if (xp == MAXDUNX) {
-				xp = 0;
+			if (xp == endX) {
+				xp = bounds.position.x;
 				yp++;
-				if (yp == MAXDUNY)
+				if (yp == endY)
 					return false;
 			}
 		}
@@ -111,15 +205,24 @@ bool TFit_Obj5(int t)
 		return true;
 	}
 
+	const int8_t regionId = themes[t].ttval;
+	const Rectangle bounds = ThemeRegions.bounds(regionId);
 	int candidatesFound = 0;
-	for (Point tile : PointsInRectangle(Rectangle { { 0, 0 }, { MAXDUNX, MAXDUNY } })) {
-		if (dTransVal[tile.x][tile.y] == themes[t].ttval && IsTileNotSolid(tile) && CheckThemeObj5(tile, themes[t].ttval)) {
-			// Use themex/y to keep track of the last candidate area found, in case we end up with fewer candidates than the target
-			themex = tile.x;
-			themey = tile.y;
-			candidatesFound++;
-			if (candidatesFound > targetCandidates)
-				return true;
+	for (int yp = bounds.position.y; yp < bounds.position.y + bounds.size.height; yp++) {
+		for (int xp = bounds.position.x; xp < bounds.position.x + bounds.size.width; xp++) {
+			const Point tile { xp, yp };
+			const Rectangle area { tile, 2 };
+			const bool fits = InDungeonBounds(area.position) && InDungeonBounds(area.position + Displacement { 4, 4 })
+			    ? ThemeRegions.CountFreeTiles(regionId, area) == 25
+			    : dTransVal[xp][yp] == regionId && IsTileNotSolid(tile) && CheckThemeObj5(tile, regionId);
+			if (fits) {
+				// Use themex/y to keep track of the last candidate area found, in case we end up with fewer candidates than the target
+				themex = xp;
+				themey = yp;
+				candidatesFound++;
+				if (candidatesFound > targetCandidates)
+					return true;
+			}
 		}
 	}
 	return candidatesFound > 0;
@@ -179,8 +282,12 @@ bool TFit_Obj3(int8_t regionId)
 {
 	constexpr unsigned objrnd[4] = { 4, 4, 3, 5 };
 
-	for (int yp = 1; yp < MAXDUNY - 1; yp++) {
-		for (int xp = 1; xp < MAXDUNX - 1; xp++) {
+	// CheckThemeObj3 stops at the top left tile without drawing random numbers unless it is part of the region
+	const Rectangle bounds = ThemeRegions.bounds(regionId);
+	const int endX = std::min(bounds.position.x + bounds.size.width + 1, MAXDUNX - 1);
+	const int endY = std::min(bounds.position.y + bounds.size.height + 1, MAXDUNY - 1);
+	for (int yp = std::max(bounds.position.y + 1, 1); yp < endY; yp++) {
+		for (int xp = std::max(bounds.position.x + 1, 1); xp < endX; xp++) {
 			if (CheckThemeObj3({ xp, yp }, regionId, objrnd[leveltype - 1])) {
 				themex = xp;
 				themey = yp;
@@ -307,9 +414,10 @@ bool CheckThemeRoom(int8_t tv)
 			return false;
 	}
 
+	const Rectangle bounds = ThemeRegions.bounds(tv);
 	int tarea = 0;
-	for (int j = 0; j < MAXDUNY; j++) {
-		for (int i = 0; i < MAXDUNX; i++) {
+	for (int j = bounds.position.y; j < bounds.position.y + bounds.size.height; j++) {
+		for (int i = bounds.position.x; i < bounds.position.x + bounds.size.width; i++) {
 			if (dTransVal[i][j] != tv)
 				continue;
 			if (TileContainsSetPiece({ i, j }))
@@ -322,8 +430,8 @@ bool CheckThemeRoom(int8_t tv)
 	if (leveltype == DTYPE_CATHEDRAL && (tarea < 9 || tarea > 100))
 		return false;
 
-	for (int j = 0; j < MAXDUNY; j++) {
-		for (int i = 0; i < MAXDUNX; i++) {
+	for (int j = bounds.position.y; j < bounds.position.y + bounds.size.height; j++) {
+		for (int i = bounds.position.x; i < bounds.position.x + bounds.size.width; i++) {
 			if (dTransVal[i][j] != tv || TileHasAny(dPiece[i][j], TileProperties::Solid))
 				continue;
 			if (dTransVal[i - 1][j] != tv && IsTileNotSolid({ i - 1, j }))
@@ -840,6 +948,8 @@ void InitThemes()
 		return;
 	}
 
+	ThemeRegions.Build();
+
 	/** Specifies the set of special theme IDs from which one will be selected at random. */
 	constexpr theme_id ThemeGood[4] = { THEME_GOATSHRINE, THEME_SHRINE, THEME_SKELROOM, THEME_LIBRARY };
 
@@ -916,6 +1026,9 @@ void CreateThemeRooms()
 		return;
 	}
 
+	// Objects placed by earlier theme rooms don't change the regions or which tiles are solid
+	ThemeRegions.Build();
+
 	for (int i = 0; i < numthemes; i++) {
 		themex = 0;
 		themey = 0;
@@ -980,4 +1093,21 @@ void CreateThemeRooms()
 	}
 }
 
+#ifdef BUILD_TESTING
+ThemeFits TestThemeFits(int t)
+{
+	ThemeRegions.Build();
+	const auto position = [](bool fits) -> std::optional<Point> {
+		if (!fits)
+			return std::nullopt;
+		return Point { themex, themey };
+	};
+	ThemeFits fits;
+	fits.shrine = position(TFit_Shrine(t));
+	fits.obj5 = position(TFit_Obj5(t));
+	fits.obj3 = position(TFit_Obj3(themes[t].ttval));
+	return fits;
+}
+#endif
+
 } // namespace devilution
@@ -6,7 +6,9 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
 
+#include "engine/point.hpp"
 #include "levels/gendung.h"
 #include "objdat.h"
 
@@ -35,4 +37,15 @@ void HoldThemeRooms();
  */
 void CreateThemeRooms();
 
+#ifdef BUILD_TESTING
+/** @brief Where the theme object checks find room in the region of a theme, if they do. */
+struct ThemeFits {
+	std::optional<Point> shrine;
+	std::optional<Point> obj5;
+	std::optional<Point> obj3;
+};
+
+ThemeFits TestThemeFits(int t);
+#endif
+
 } // namespace devilution
@@ -15,6 +15,7 @@
 #include "engine/points_in_rectangle_range.hpp"
 #include "player.h"
 #include "utils/attributes.h"
+#include "utils/math.h"
 
 namespace devilution {
 
@@ -371,27 +372,23 @@ void MakeLightTable()
 	LoadFileInMem("plrgfx\\stone.trn", StoneTable);
 	LoadFileInMem("gendata\\pause.trn", PauseTable);
 
-	// Generate light falloffs ranges
-	const float maxDarkness = 15;
-	const float maxBrightness = 0;
+	// Generate light falloffs ranges, in integers so every build produces the same light levels
+	constexpr int MaxDarkness = 15;
 	for (unsigned radius = 0; radius < NumLightRadiuses; radius++) {
 		const unsigned maxDistance = (radius + 1) * 8;
+		const int maxDistanceSquared = static_cast<int>(maxDistance * maxDistance);
 		for (unsigned distance = 0; distance < 128; distance++) {
 			if (distance > maxDistance) {
 				LightFalloffs[radius][distance] = 15;
+			} else if (IsAnyOf(leveltype, DTYPE_NEST, DTYPE_CRYPT)) {
+				// quardratic falloff with over exposure, (distance / maxDistance)^2 * brightness + (MaxDarkness - brightness)
+				// with a brightness of radius * 5 / 4, scaled by 4 * maxDistance^2
+				const int brightness = static_cast<int>(radius) * 5;
+				const int scaled = std::max(brightness * static_cast<int>(distance * distance) + (MaxDarkness * 4 - brightness) * maxDistanceSquared, 0);
+				LightFalloffs[radius][distance] = static_cast<uint8_t>((scaled * 2 + maxDistanceSquared * 4) / (maxDistanceSquared * 8)); // round up
 			} else {
-				const float factor = static_cast<float>(distance) / static_cast<float>(maxDistance);
-				float scaled;
-				if (IsAnyOf(leveltype, DTYPE_NEST, DTYPE_CRYPT)) {
-					// quardratic falloff with over exposure
-					const float brightness = static_cast<float>(radius) * 1.25F;
-					scaled = factor * factor * brightness + (maxDarkness - brightness);
-					scaled = std::max(maxBrightness, scaled);
-				} else {
-					// Leaner falloff
-					scaled = factor * maxDarkness;
-				}
-				LightFalloffs[radius][distance] = static_cast<uint8_t>(scaled + 0.5F); // round up
+				// Leaner falloff
+				LightFalloffs[radius][distance] = static_cast<uint8_t>((distance * MaxDarkness * 2 + maxDistance) / (maxDistance * 2)); // round up
 			}
 		}
 	}
@@ -403,7 +400,7 @@ void MakeLightTable()
 				for (int x = 0; x < 16; x++) {
 					int a = (8 * x - offsetY);
 					int b = (8 * y - offsetX);
-					LightConeInterpolations[offsetX][offsetY][x][y] = static_cast<uint8_t>(sqrt(a * a + b * b));
+					LightConeInterpolations[offsetX][offsetY][x][y] = static_cast<uint8_t>(math::IntegerSqrt(a * a + b * b));
 				}
 			}
 		}
@@ -2053,6 +2053,7 @@ void LoadStash()
 		filename = "mpstashitems";
 
 	Stash = {};
+	ClearStashSearch();
 
 	LoadHelper file(OpenStashArchive(), filename);
 	if (!file.IsValid())
@@ -2080,6 +2081,8 @@ void LoadStash()
 		LoadAndValidateItemData(file, Stash.stashList[i]);
 	}
 
+	Stash.RebuildSearchIndex();
+
 	Stash.SetPage(file.NextLE<uint32_t>());
 }
 
@@ -2329,13 +2332,25 @@ void SaveStash(SaveWriter &stashWriter)
 
 	const int itemSize = (gbIsHellfire ? HellfireItemSaveSize : DiabloItemSaveSize);
 
+	std::vector<unsigned> pagesToSave;
+	for (const auto &[page, grid] : Stash.stashGrids) {
+		if (c_any_of(grid, [](const auto &row) {
+			    return c_any_of(row, [](StashStruct::StashCell cell) {
+				    return cell > 0;
+			    });
+		    })) {
+			// found a page that contains at least one item
+			pagesToSave.push_back(page);
+		}
+	};
+
 	SaveHelper file(
 	    stashWriter,
 	    filename,
 	    sizeof(uint8_t)
 	        + sizeof(uint32_t)
 	        + sizeof(uint32_t)
-	        + (sizeof(uint32_t) + 10 * 10 * sizeof(uint16_t)) * Stash.stashGrids.size()
+	        + (sizeof(uint32_t) + 10 * 10 * sizeof(uint16_t)) * pagesToSave.size()
 	        + sizeof(uint32_t)
 	        + itemSize * Stash.stashList.size()
 	        + sizeof(uint32_t));
@@ -2344,23 +2359,11 @@ void SaveStash(SaveWriter &stashWriter)
 
 	file.WriteLE<uint32_t>(Stash.gold);
 
-	std::vector<unsigned> pagesToSave;
-	for (const auto &[page, grid] : Stash.stashGrids) {
-		if (c_any_of(grid, [](const auto &row) {
-			    return c_any_of(row, [](StashStruct::StashCell cell) {
-				    return cell > 0;
-			    });
-		    })) {
-			// found a page that contains at least one item
-			pagesToSave.push_back(page);
-		}
-	};
-
 	// Current stash size is 100 pages. Will definitely fit in a 32 bit value.
 	file.WriteLE<uint32_t>(static_cast<uint32_t>(pagesToSave.size()));
 	for (const auto &page : pagesToSave) {
 		file.WriteLE<uint32_t>(page);
-		for (const auto &row : Stash.stashGrids[page]) {
+		for (const auto &row : *Stash.FindGrid(page)) {
 			for (uint16_t cell : row) {
 				file.WriteLE<uint16_t>(cell);
 			}
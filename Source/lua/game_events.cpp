@@ -0,0 +1,174 @@
+#include "lua/game_events.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#include <sol/sol.hpp>
+
+#include "items.h"
+#include "lua/lua.hpp"
+#include "missiles.h"
+#include "monster.h"
+#include "multi.h"
+#include "player.h"
+
+namespace devilution {
+
+namespace detail {
+
+std::array<uint16_t, NumLuaGameEvents> LuaGameEventHandlerCounts;
+
+} // namespace detail
+
+namespace {
+
+constexpr std::array<std::string_view, NumLuaGameEvents> LuaGameEventNames = {
+	"MonsterKilled",
+	"ItemSpawned",
+	"PlayerLevelUp",
+	"MissileAdded",
+};
+
+/** @brief The `trigger` function of each event, only set while the event has handlers. */
+std::array<sol::protected_function, NumLuaGameEvents> Triggers;
+
+/**
+ * Monsters, items and players are passed to scripts by their index in the global arrays and are only read when a
+ * script accesses a field, so the fields always reflect the current state of the entity.
+ */
+struct LuaMonsterView {
+	size_t id;
+};
+
+struct LuaItemView {
+	size_t id;
+};
+
+struct LuaPlayerView {
+	size_t id;
+};
+
+/** @brief Missiles are removed from their list when they end, so scripts get a copy of the fields they can read. */
+struct LuaMissileView {
+	MissileID type;
+	mienemy_type caster;
+	int source;
+	WorldTilePosition position;
+	int damage;
+	int spellLevel;
+};
+
+void EventHandlersChanged(std::string_view name, size_t count, const sol::protected_function &trigger)
+{
+	const auto it = std::find(LuaGameEventNames.begin(), LuaGameEventNames.end(), name);
+	if (it == LuaGameEventNames.end())
+		return;
+	const size_t event = static_cast<size_t>(it - LuaGameEventNames.begin());
+	detail::LuaGameEventHandlerCounts[event] = static_cast<uint16_t>(std::min<size_t>(count, std::numeric_limits<uint16_t>::max()));
+	Triggers[event] = count != 0 ? trigger : sol::protected_function {};
+}
+
+template <typename... Args>
+void Trigger(LuaGameEvent event, Args &&...args)
+{
+	const sol::protected_function &trigger = Triggers[static_cast<size_t>(event)];
+	if (!trigger.valid())
+		return;
+	SafeCallResult(trigger(std::forward<Args>(args)...), /*optional=*/true);
+}
+
+void RegisterViewTypes(sol::state_view &lua)
+{
+	// Only getters are registered, so any assignment from a script fails.
+	sol::table types = lua.create_table();
+	types.new_usertype<LuaMonsterView>("Monster", sol::no_constructor,
+	    "id", sol::readonly_property([](const LuaMonsterView &view) { return view.id; }),
+	    "name", sol::readonly_property([](const LuaMonsterView &view) { return std::string(Monsters[view.id].name()); }),
+	    "type", sol::readonly_property([](const LuaMonsterView &view) { return static_cast<int>(Monsters[view.id].type().type); }),
+	    "x", sol::readonly_property([](const LuaMonsterView &view) { return Monsters[view.id].position.tile.x; }),
+	    "y", sol::readonly_property([](const LuaMonsterView &view) { return Monsters[view.id].position.tile.y; }),
+	    "hp", sol::readonly_property([](const LuaMonsterView &view) { return Monsters[view.id].hitPoints >> 6; }),
+	    "maxHp", sol::readonly_property([](const LuaMonsterView &view) { return Monsters[view.id].maxHitPoints >> 6; }),
+	    "level", sol::readonly_property([](const LuaMonsterView &view) { return Monsters[view.id].level(sgGameInitInfo.nDifficulty); }),
+	    "isUnique", sol::readonly_property([](const LuaMonsterView &view) { return Monsters[view.id].isUnique(); }));
+
+	types.new_usertype<LuaItemView>("Item", sol::no_constructor,
+	    "id", sol::readonly_property([](const LuaItemView &view) { return view.id; }),
+	    "name", sol::readonly_property([](const LuaItemView &view) { return std::string(Items[view.id].getName().str()); }),
+	    "type", sol::readonly_property([](const LuaItemView &view) { return static_cast<int>(Items[view.id]._itype); }),
+	    "quality", sol::readonly_property([](const LuaItemView &view) { return static_cast<int>(Items[view.id]._iMagical); }),
+	    "x", sol::readonly_property([](const LuaItemView &view) { return Items[view.id].position.x; }),
+	    "y", sol::readonly_property([](const LuaItemView &view) { return Items[view.id].position.y; }),
+	    "value", sol::readonly_property([](const LuaItemView &view) { return Items[view.id]._ivalue; }),
+	    "identified", sol::readonly_property([](const LuaItemView &view) { return Items[view.id]._iIdentified; }));
+
+	types.new_usertype<LuaPlayerView>("Player", sol::no_constructor,
+	    "id", sol::readonly_property([](const LuaPlayerView &view) { return view.id; }),
+	    "name", sol::readonly_property([](const LuaPlayerView &view) { return std::string(Players[view.id]._pName); }),
+	    "class", sol::readonly_property([](const LuaPlayerView &view) { return static_cast<int>(Players[view.id]._pClass); }),
+	    "level", sol::readonly_property([](const LuaPlayerView &view) { return Players[view.id].getCharacterLevel(); }),
+	    "x", sol::readonly_property([](const LuaPlayerView &view) { return Players[view.id].position.tile.x; }),
+	    "y", sol::readonly_property([](const LuaPlayerView &view) { return Players[view.id].position.tile.y; }),
+	    "hp", sol::readonly_property([](const LuaPlayerView &view) { return Players[view.id]._pHitPoints >> 6; }),
+	    "maxHp", sol::readonly_property([](const LuaPlayerView &view) { return Players[view.id]._pMaxHP >> 6; }),
+	    "mana", sol::readonly_property([](const LuaPlayerView &view) { return Players[view.id]._pMana >> 6; }),
+	    "experience", sol::readonly_property([](const LuaPlayerView &view) { return Players[view.id]._pExperience; }));
+
+	types.new_usertype<LuaMissileView>("Missile", sol::no_constructor,
+	    "type", sol::readonly_property([](const LuaMissileView &view) { return static_cast<int>(view.type); }),
+	    "caster", sol::readonly_property([](const LuaMissileView &view) { return static_cast<int>(view.caster); }),
+	    "source", sol::readonly_property([](const LuaMissileView &view) { return view.source; }),
+	    "x", sol::readonly_property([](const LuaMissileView &view) { return view.position.x; }),
+	    "y", sol::readonly_property([](const LuaMissileView &view) { return view.position.y; }),
+	    "damage", sol::readonly_property([](const LuaMissileView &view) { return view.damage; }),
+	    "spellLevel", sol::readonly_property([](const LuaMissileView &view) { return view.spellLevel; }));
+}
+
+} // namespace
+
+namespace detail {
+
+void TriggerLuaMonsterKilled(const Monster &monster, const Player &player)
+{
+	Trigger(LuaGameEvent::MonsterKilled, LuaMonsterView { monster.getId() }, LuaPlayerView { player.getId() });
+}
+
+void TriggerLuaItemSpawned(const Item &item)
+{
+	Trigger(LuaGameEvent::ItemSpawned, LuaItemView { static_cast<size_t>(&item - &Items[0]) });
+}
+
+void TriggerLuaPlayerLevelUp(const Player &player)
+{
+	Trigger(LuaGameEvent::PlayerLevelUp, LuaPlayerView { player.getId() });
+}
+
+void TriggerLuaMissileAdded(const Missile &missile)
+{
+	Trigger(LuaGameEvent::MissileAdded, LuaMissileView {
+	                                        missile._mitype,
+	                                        missile._micaster,
+	                                        missile._misource,
+	                                        missile.position.tile,
+	                                        missile._midam,
+	                                        missile._mispllvl,
+	                                    });
+}
+
+} // namespace detail
+
+void LuaInitializeGameEvents(sol::state_view &lua)
+{
+	RegisterViewTypes(lua);
+	lua["eventHandlersChanged"] = EventHandlersChanged;
+}
+
+void LuaShutdownGameEvents()
+{
+	detail::LuaGameEventHandlerCounts = {};
+	Triggers = {};
+}
+
+} // namespace devilution
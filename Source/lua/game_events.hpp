@@ -0,0 +1,80 @@
+/**
+ * @file game_events.hpp
+ *
+ * Gameplay events for Lua scripts. Checking for handlers is inlined so that events nobody listens to cost a single load.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <sol/forward.hpp>
+
+namespace devilution {
+
+struct Item;
+struct Missile;
+struct Monster;
+struct Player;
+
+enum class LuaGameEvent : uint8_t {
+	MonsterKilled,
+	ItemSpawned,
+	PlayerLevelUp,
+	MissileAdded,
+
+	LAST = MissileAdded
+};
+
+constexpr size_t NumLuaGameEvents = static_cast<size_t>(LuaGameEvent::LAST) + 1;
+
+namespace detail {
+
+/** @brief Number of handlers registered for each event, kept up to date by `devilutionx.events`. */
+extern std::array<uint16_t, NumLuaGameEvents> LuaGameEventHandlerCounts;
+
+void TriggerLuaMonsterKilled(const Monster &monster, const Player &player);
+void TriggerLuaItemSpawned(const Item &item);
+void TriggerLuaPlayerLevelUp(const Player &player);
+void TriggerLuaMissileAdded(const Missile &missile);
+
+} // namespace detail
+
+inline bool HasLuaGameEventHandlers(LuaGameEvent event)
+{
+	return detail::LuaGameEventHandlerCounts[static_cast<size_t>(event)] != 0;
+}
+
+inline void LuaMonsterKilledEvent(const Monster &monster, const Player &player)
+{
+	if (HasLuaGameEventHandlers(LuaGameEvent::MonsterKilled))
+		detail::TriggerLuaMonsterKilled(monster, player);
+}
+
+/** @param item Must be an element of `Items` */
+inline void LuaItemSpawnedEvent(const Item &item)
+{
+	if (HasLuaGameEventHandlers(LuaGameEvent::ItemSpawned))
+		detail::TriggerLuaItemSpawned(item);
+}
+
+inline void LuaPlayerLevelUpEvent(const Player &player)
+{
+	if (HasLuaGameEventHandlers(LuaGameEvent::PlayerLevelUp))
+		detail::TriggerLuaPlayerLevelUp(player);
+}
+
+inline void LuaMissileAddedEvent(const Missile &missile)
+{
+	if (HasLuaGameEventHandlers(LuaGameEvent::MissileAdded))
+		detail::TriggerLuaMissileAdded(missile);
+}
+
+/** @brief Registers the event payload types and the callback `devilutionx.events` reports handlers with. */
+void LuaInitializeGameEvents(sol::state_view &lua);
+
+/** @brief Forgets all handlers, must be called before the Lua state is destroyed. */
+void LuaShutdownGameEvents();
+
+} // namespace devilution
@@ -1,8 +1,11 @@
 #include "lua/lua.hpp"
 
+#include <algorithm>
 #include <optional>
+#include <string>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
 
 #include <sol/sol.hpp>
 
@@ -10,10 +13,12 @@
 
 #include "appfat.h"
 #include "engine/assets.hpp"
+#include "lua/game_events.hpp"
 #include "lua/modules/audio.hpp"
 #include "lua/modules/log.hpp"
 #include "lua/modules/render.hpp"
 #include "plrmsg.h"
+#include "utils/algorithm/container.hpp"
 #include "utils/console.h"
 #include "utils/log.hpp"
 #include "utils/str_cat.hpp"
@@ -27,12 +32,30 @@ namespace devilution {
 
 namespace {
 
+struct LuaEventHandler {
+	/** @brief Keeps the function alive so its address stays unique. */
+	sol::protected_function function;
+	LuaEventHandlerStats stats;
+};
+
+struct UntrustedScript {
+	/** @brief The chunk name of the top-level chunk, the `source` of the functions it defines. */
+	std::string chunkName;
+	sol::environment sandbox;
+};
+
 struct LuaState {
 	sol::state sol = {};
 	sol::table commonPackages = {};
 	std::unordered_map<std::string, sol::bytecode> compiledScripts = {};
 	sol::environment sandbox = {};
 	sol::table events = {};
+	/** @brief Event handlers by the address of their function. */
+	std::unordered_map<const void *, LuaEventHandler> eventHandlers = {};
+	/** @brief Scripts loaded with LuaLoadUntrustedScript, by name. */
+	std::unordered_map<std::string, UntrustedScript> untrustedScripts = {};
+	/** @brief Set by the instruction count hook when the running handler exceeds its budget. */
+	bool budgetExceeded = false;
 };
 
 std::optional<LuaState> CurrentLuaState;
@@ -129,6 +152,128 @@ sol::object RunScript(std::optional<sol::environment> env, std::string_view pack
 	return SafeCallResult(fn(), optional);
 }
 
+void LuaBudgetExceeded(lua_State *state, lua_Debug * /*debug*/)
+{
+	CurrentLuaState->budgetExceeded = true;
+	// Fail on every instruction from now on, so that the handler can't catch the error and carry on
+	lua_sethook(state, LuaBudgetExceeded, LUA_MASKCOUNT, 1);
+	luaL_error(state, "exceeded the budget of %d instructions", LuaEventHandlerInstructionBudget);
+}
+
+/**
+ * @brief Calls a function that may only run LuaEventHandlerInstructionBudget instructions.
+ *
+ * @param budgetExceeded Set if the function was stopped because it exceeded the budget.
+ */
+template <typename... Args>
+sol::protected_function_result CallWithInstructionBudget(const sol::protected_function &function, bool &budgetExceeded, Args &&...args)
+{
+	// Handlers may trigger events themselves, so restore the hook of the outer handler afterwards
+	lua_State *state = function.lua_state();
+	const lua_Hook outerHook = lua_gethook(state);
+	const int outerHookMask = lua_gethookmask(state);
+	const int outerHookCount = lua_gethookcount(state);
+	const bool outerBudgetExceeded = CurrentLuaState->budgetExceeded;
+	CurrentLuaState->budgetExceeded = false;
+	lua_sethook(state, LuaBudgetExceeded, LUA_MASKCOUNT, LuaEventHandlerInstructionBudget);
+
+	sol::protected_function_result result = function(std::forward<Args>(args)...);
+
+	lua_sethook(state, outerHook, outerHookMask, outerHookCount);
+	budgetExceeded = CurrentLuaState->budgetExceeded;
+	CurrentLuaState->budgetExceeded = outerBudgetExceeded;
+	return result;
+}
+
+LuaEventHandler &GetEventHandler(const sol::protected_function &function)
+{
+	lua_State *state = function.lua_state();
+	function.push();
+	auto [it, inserted] = CurrentLuaState->eventHandlers.try_emplace(lua_topointer(state, -1));
+	if (!inserted) {
+		lua_pop(state, 1);
+		return it->second;
+	}
+
+	lua_Debug debug;
+	lua_getinfo(state, ">S", &debug);
+	it->second.function = function;
+	it->second.stats.name = StrCat(debug.short_src, ":", debug.linedefined);
+	return it->second;
+}
+
+/**
+ * @brief Calls a single event handler, called by `trigger` in `devilutionx.events`.
+ */
+void CallEventHandler(const sol::protected_function &function, sol::variadic_args args)
+{
+	LuaEventHandler &handler = GetEventHandler(function);
+	LuaEventHandlerStats &stats = handler.stats;
+	if (stats.disabled)
+		return;
+
+	bool budgetExceeded;
+	const auto start = std::chrono::steady_clock::now();
+	const sol::protected_function_result result = CallWithInstructionBudget(function, budgetExceeded, args);
+	const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+	stats.calls++;
+	stats.totalTime += elapsed;
+	stats.maxTime = std::max(stats.maxTime, elapsed);
+
+	if (result.valid())
+		return;
+	const std::string error = result.get_type() == sol::type::string ? result.get<std::string>() : "Unknown Lua error";
+	if (budgetExceeded) {
+		stats.disabled = true;
+		LogError("Lua event handler {} was disabled: {}", stats.name, error);
+	} else {
+		LogError("Lua error in event handler {}: {}", stats.name, error);
+	}
+}
+
+/**
+ * @brief Whether a function was defined by the given untrusted script or by a package it required.
+ */
+bool IsFromScript(const sol::object &object, const UntrustedScript &script)
+{
+	if (object.get_type() != sol::type::function)
+		return false;
+	lua_State *state = object.lua_state();
+	object.push();
+
+	// Functions that access globals share the `_ENV` upvalue of the chunk, which is the sandbox.
+	const void *env = nullptr;
+	const char *upvalueName;
+	for (int i = 1; (upvalueName = lua_getupvalue(state, -1, i)) != nullptr; ++i) {
+		if (std::string_view(upvalueName) == "_ENV")
+			env = lua_topointer(state, -1);
+		lua_pop(state, 1);
+	}
+
+	lua_Debug debug;
+	lua_getinfo(state, ">S", &debug);
+	return env == script.sandbox.pointer() || script.chunkName == debug.source;
+}
+
+bool RunUntrustedScript(std::string_view name, std::string chunkName, sol::protected_function fn)
+{
+	LuaUnloadUntrustedScript(name);
+	UntrustedScript &script = CurrentLuaState->untrustedScripts[std::string(name)];
+	script.chunkName = std::move(chunkName);
+	script.sandbox = CreateUntrustedLuaSandbox();
+	sol::set_environment(script.sandbox, fn);
+
+	bool budgetExceeded;
+	const sol::protected_function_result result = CallWithInstructionBudget(fn, budgetExceeded);
+	if (result.valid())
+		return true;
+	const std::string error = result.get_type() == sol::type::string ? result.get<std::string>() : "Unknown Lua error";
+	LogError("Lua script {} was unloaded: {}", name, error);
+	LuaUnloadUntrustedScript(name);
+	return false;
+}
+
 void LuaPanic(sol::optional<std::string> message)
 {
 	LogError("Lua is in a panic state and will now abort() the application:\n{}",
@@ -193,6 +338,75 @@ sol::environment CreateLuaSandbox()
 	return sandbox;
 }
 
+sol::environment CreateUntrustedLuaSandbox()
+{
+	sol::state &lua = CurrentLuaState->sol;
+	sol::environment sandbox = CreateLuaSandbox();
+	for (const std::string_view global : { "os", "debug", "coroutine", "rawequal", "rawget", "rawset", "setmetatable" }) {
+		sandbox[global] = sol::lua_nil;
+	}
+
+	// Untrusted scripts get their own set of loaded packages without the development tools.
+	sol::table packages = lua.create_table();
+	for (const auto &[name, package] : CurrentLuaState->commonPackages) {
+		if (name.as<std::string_view>() != "devilutionx.dev")
+			packages[name] = package;
+	}
+	sandbox["require"] = lua["requireGen"](sandbox, packages, LuaLoadScriptFromAssets);
+
+	return sandbox;
+}
+
+bool LuaLoadUntrustedScript(std::string_view name, std::string_view code)
+{
+	// The `=` prefix makes Lua use the name as is in error messages.
+	std::string chunkName = StrCat("=", name);
+	sol::load_result result = CurrentLuaState->sol.load(code, chunkName, sol::load_mode::text);
+	if (!result.valid()) {
+		LogError("Lua error when loading {}: {}", name, result.get<std::string>());
+		return false;
+	}
+	return RunUntrustedScript(name, std::move(chunkName), result.get<sol::protected_function>());
+}
+
+void LuaUnloadUntrustedScript(std::string_view name)
+{
+	LuaState &luaState = *CurrentLuaState;
+	const auto it = luaState.untrustedScripts.find(std::string(name));
+	if (it == luaState.untrustedScripts.end())
+		return;
+	const UntrustedScript &script = it->second;
+	const auto removeHandler = [&](const sol::object &fn) {
+		if (!IsFromScript(fn, script))
+			return false;
+		luaState.eventHandlers.erase(fn.pointer());
+		return true;
+	};
+
+	for (const auto &[_, event] : luaState.events) {
+		if (event.get_type() != sol::type::table)
+			continue;
+		const sol::object removeIf = event.as<sol::table>()["__removeIf"];
+		if (removeIf.get_type() == sol::type::function)
+			SafeCallResult(removeIf.as<sol::protected_function>()(removeHandler), /*optional=*/true);
+	}
+	// Handlers that the script already took out of their events with `remove`
+	std::erase_if(luaState.eventHandlers, [&](const auto &entry) { return IsFromScript(entry.second.function, script); });
+	luaState.untrustedScripts.erase(it);
+}
+
+std::vector<LuaEventHandlerStats> GetLuaEventHandlerStats()
+{
+	std::vector<LuaEventHandlerStats> result;
+	for (const auto &[_, handler] : CurrentLuaState->eventHandlers) {
+		result.push_back(handler.stats);
+	}
+	c_sort(result, [](const LuaEventHandlerStats &a, const LuaEventHandlerStats &b) {
+		return a.totalTime > b.totalTime;
+	});
+	return result;
+}
+
 void LuaInitialize()
 {
 	CurrentLuaState.emplace(LuaState { .sol = { sol::c_call<decltype(&LuaPanic), &LuaPanic> } });
@@ -211,6 +425,8 @@ void LuaInitialize()
 
 	// Registering devilutionx object table
 	SafeCallResult(lua.safe_script(RequireGenSrc), /*optional=*/false);
+	lua["callEventHandler"] = CallEventHandler;
+	LuaInitializeGameEvents(lua);
 
 	// Loaded without a sandbox.
 	CurrentLuaState->events = RunScript(/*env=*/std::nullopt, "devilutionx.events", /*optional=*/false);
@@ -231,7 +447,16 @@ void LuaInitialize()
 	// Used by the custom require implementation.
 	lua["setEnvironment"] = [](const sol::environment &env, const sol::function &fn) { sol::set_environment(env, fn); };
 
-	RunScript(CreateLuaSandbox(), "user", /*optional=*/true);
+	// The user script is trusted, only its top-level chunk gets the instruction budget so that it can't hang the game.
+	const sol::object userScript = LuaLoadScriptFromAssets("user");
+	if (userScript.get_type() == sol::type::string) {
+		LogError("{}", userScript.as<std::string>());
+	} else {
+		auto fn = userScript.as<sol::protected_function>();
+		sol::set_environment(CreateLuaSandbox(), fn);
+		bool budgetExceeded;
+		SafeCallResult(CallWithInstructionBudget(fn, budgetExceeded), /*optional=*/true);
+	}
 
 	LuaEvent("GameBoot");
 }
@@ -241,6 +466,8 @@ void LuaShutdown()
 #ifdef _DEBUG
 	LuaReplShutdown();
 #endif
+	ClearLuaRenderCommands();
+	LuaShutdownGameEvents();
 	CurrentLuaState = std::nullopt;
 }
 
@@ -1,17 +1,59 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include <expected.hpp>
 #include <sol/forward.hpp>
 
 namespace devilution {
 
+struct Surface;
+
+/** @brief Lua instructions an event handler may run per call, handlers that need more are stopped and disabled. */
+constexpr int LuaEventHandlerInstructionBudget = 1000000;
+
+struct LuaEventHandlerStats {
+	/** @brief Where the handler is defined, as `source:line`. */
+	std::string name;
+	uint32_t calls;
+	std::chrono::microseconds totalTime;
+	std::chrono::microseconds maxTime;
+	/** @brief Set once the handler exceeded its instruction budget, it is not called anymore. */
+	bool disabled;
+};
+
 void LuaInitialize();
 void LuaShutdown();
 void LuaEvent(std::string_view name);
+/** @brief Draws the commands that scripts recorded through `devilutionx.render`, called once per frame. */
+void DrawLuaRenderCommands(const Surface &out);
 sol::state &GetLuaState();
 sol::environment CreateLuaSandbox();
+/**
+ * @brief Creates a sandbox for scripts that are not trusted, such as mods.
+ *
+ * Compared to CreateLuaSandbox it lacks `os`, `debug`, `coroutine`, the raw access functions and
+ * `setmetatable`, so scripts cannot escape the instruction budget through finalizers or coroutines.
+ */
+sol::environment CreateUntrustedLuaSandbox();
+/**
+ * @brief Runs a script that is not trusted, such as a mod, in its own sandbox from CreateUntrustedLuaSandbox.
+ *
+ * The top-level chunk has the same instruction budget as an event handler.
+ * A script that fails to load or run is unloaded again.
+ *
+ * @param name Identifies the script for LuaUnloadUntrustedScript, also used as its chunk name.
+ * @return Whether the script ran successfully.
+ */
+bool LuaLoadUntrustedScript(std::string_view name, std::string_view code);
+/** @brief Removes the event handlers that an untrusted script added, along with their statistics. */
+void LuaUnloadUntrustedScript(std::string_view name);
+/** @brief Returns the statistics of all event handlers that were called so far. */
+std::vector<LuaEventHandlerStats> GetLuaEventHandlerStats();
 sol::object SafeCallResult(sol::protected_function_result result, bool optional);
 
 } // namespace devilution
@@ -1,8 +1,11 @@
 #ifdef _DEBUG
 #include "lua/modules/dev.hpp"
 
+#include <string>
+
 #include <sol/sol.hpp>
 
+#include "lua/lua.hpp"
 #include "lua/metadoc.hpp"
 #include "lua/modules/dev/display.hpp"
 #include "lua/modules/dev/items.hpp"
@@ -12,13 +15,34 @@
 #include "lua/modules/dev/quests.hpp"
 #include "lua/modules/dev/search.hpp"
 #include "lua/modules/dev/towners.hpp"
+#include "utils/str_cat.hpp"
 
 namespace devilution {
 
+namespace {
+
+std::string DebugCmdEventStats()
+{
+	std::string ret;
+	for (const LuaEventHandlerStats &stats : GetLuaEventHandlerStats()) {
+		if (!ret.empty())
+			ret += '\n';
+		const long long average = stats.calls != 0 ? stats.totalTime.count() / stats.calls : 0;
+		StrAppend(ret, stats.name, ": ", stats.calls, " calls, ", average, "us average, ",
+		    static_cast<long long>(stats.maxTime.count()), "us max", stats.disabled ? ", disabled" : "");
+	}
+	if (ret.empty())
+		return "No event handlers were called yet.";
+	return ret;
+}
+
+} // namespace
+
 sol::table LuaDevModule(sol::state_view &lua)
 {
 	sol::table table = lua.create_table();
 	SetDocumented(table, "display", "", "Debugging HUD and rendering commands.", LuaDevDisplayModule(lua));
+	SetDocumented(table, "eventStats", "()", "Show call counts and timings of Lua event handlers.", &DebugCmdEventStats);
 	SetDocumented(table, "items", "", "Item-related commands.", LuaDevItemsModule(lua));
 	SetDocumented(table, "level", "", "Level-related commands.", LuaDevLevelModule(lua));
 	SetDocumented(table, "monsters", "", "Monster-related commands.", LuaDevMonstersModule(lua));
@@ -1,16 +1,108 @@
 #include "lua/modules/render.hpp"
 
+#include <optional>
+
 #include <sol/sol.hpp>
 
 #include "engine/dx.h"
+#include "engine/render/draw_commands.hpp"
 #include "engine/render/text_render.hpp"
+#include "lua/lua.hpp"
+#include "lua/metadoc.hpp"
+#include "utils/log.hpp"
 
 namespace devilution {
 
-sol::table LuaRenderModule(sol::state_view &lua)
+namespace {
+
+/** @brief Commands recorded by scripts, drawn every frame until a script clears them. */
+DrawCommandList LuaDrawCommands;
+
+/** @brief Keeps a script that records every frame without clearing from growing the list forever. */
+constexpr size_t MaxLuaDrawCommands = 4096;
+bool LoggedDrawCommandLimit = false;
+
+bool CanRecordDrawCommand()
+{
+	if (LuaDrawCommands.size() < MaxLuaDrawCommands)
+		return true;
+	if (!LoggedDrawCommandLimit) {
+		LogError("Lua scripts recorded {} draw commands without clearing them, further commands are dropped", MaxLuaDrawCommands);
+		LoggedDrawCommandLimit = true;
+	}
+	return false;
+}
+
+sol::table LuaRenderUiFlags(sol::state_view &lua)
 {
 	return lua.create_table_with(
-	    "string", [](std::string_view text, int x, int y) { DrawString(GlobalBackBuffer(), text, { x, y }); });
+	    "FontSize12", static_cast<uint32_t>(UiFlags::FontSize12),
+	    "FontSize24", static_cast<uint32_t>(UiFlags::FontSize24),
+	    "FontSize30", static_cast<uint32_t>(UiFlags::FontSize30),
+	    "ColorWhite", static_cast<uint32_t>(UiFlags::ColorWhite),
+	    "ColorGold", static_cast<uint32_t>(UiFlags::ColorGold),
+	    "ColorRed", static_cast<uint32_t>(UiFlags::ColorRed),
+	    "ColorBlue", static_cast<uint32_t>(UiFlags::ColorBlue),
+	    "ColorOrange", static_cast<uint32_t>(UiFlags::ColorOrange),
+	    "ColorYellow", static_cast<uint32_t>(UiFlags::ColorYellow),
+	    "AlignCenter", static_cast<uint32_t>(UiFlags::AlignCenter),
+	    "AlignRight", static_cast<uint32_t>(UiFlags::AlignRight),
+	    "Outlined", static_cast<uint32_t>(UiFlags::Outlined));
+}
+
+} // namespace
+
+sol::table LuaRenderModule(sol::state_view &lua)
+{
+	sol::table table = lua.create_table();
+	SetDocumented(table, "string", "(text: string, x: integer, y: integer)", "Renders a string at the given coordinates right away.",
+	    [](std::string_view text, int x, int y) { DrawString(GlobalBackBuffer(), text, { x, y }); });
+	SetDocumented(table, "clear", "()", "Removes all recorded draw commands.",
+	    []() { LuaDrawCommands.Clear(); });
+	SetDocumented(table, "clip", "(x: integer = nil, y: integer = nil, width: integer = nil, height: integer = nil)", "Limits the following draw commands to an area, or removes the limit without arguments. Returns false if too many commands were recorded.",
+	    [](std::optional<int> x, std::optional<int> y, std::optional<int> width, std::optional<int> height) {
+		    if (!CanRecordDrawCommand())
+			    return false;
+		    LuaDrawCommands.SetClip({ { x.value_or(0), y.value_or(0) }, { width.value_or(0), height.value_or(0) } });
+		    return true;
+	    });
+	SetDocumented(table, "rect", "(x: integer, y: integer, width: integer, height: integer, color: integer)", "Records a filled rectangle in the given palette color, returns false if too many commands were recorded.",
+	    [](int x, int y, int width, int height, uint8_t color) {
+		    if (!CanRecordDrawCommand())
+			    return false;
+		    LuaDrawCommands.AddRect({ { x, y }, { width, height } }, color);
+		    return true;
+	    });
+	SetDocumented(table, "line", "(x1: integer, y1: integer, x2: integer, y2: integer, color: integer)", "Records a line in the given palette color, returns false if too many commands were recorded.",
+	    [](int x1, int y1, int x2, int y2, uint8_t color) {
+		    if (!CanRecordDrawCommand())
+			    return false;
+		    LuaDrawCommands.AddLine({ x1, y1 }, { x2, y2 }, color);
+		    return true;
+	    });
+	SetDocumented(table, "sprite", "(path: string, frame: integer, x: integer, y: integer)", "Records a frame of a CLX sprite, returns false if it doesn't exist or too many commands were recorded.",
+	    [](std::string_view path, uint16_t frame, int x, int y) { return CanRecordDrawCommand() && LuaDrawCommands.AddSprite(path, frame, { x, y }); });
+	SetDocumented(table, "text", "(text: string, x: integer, y: integer, flags: integer = nil, width: integer = nil)", "Records text, flags are a combination of render.UiFlags. Returns false if too many commands were recorded.",
+	    [](std::string_view text, int x, int y, std::optional<uint32_t> flags, std::optional<int> width) {
+		    if (!CanRecordDrawCommand())
+			    return false;
+		    LuaDrawCommands.AddText(text, { { x, y }, { width.value_or(0), 0 } }, static_cast<UiFlags>(flags.value_or(0)));
+		    return true;
+	    });
+	SetDocumented(table, "UiFlags", "", "Flags for render.text, combine them with `|`.", LuaRenderUiFlags(lua));
+	return table;
+}
+
+void DrawLuaRenderCommands(const Surface &out)
+{
+	LuaDrawCommands.Draw(out);
+}
+
+void ClearLuaRenderCommands()
+{
+	LuaDrawCommands.Clear();
+	ClearDrawCommandSprites();
+	LoggedDrawCommandLimit = false;
 }
 
 } // namespace devilution
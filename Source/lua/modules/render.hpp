@@ -6,4 +6,7 @@ namespace devilution {
 
 sol::table LuaRenderModule(sol::state_view &lua);
 
+/** @brief Removes the draw commands recorded by scripts and unloads their sprites. */
+void ClearLuaRenderCommands();
+
 } // namespace devilution
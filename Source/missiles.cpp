@@ -5,9 +5,13 @@
  */
 #include "missiles.h"
 
+#include <algorithm>
+#include <array>
 #include <climits>
 #include <cmath>
 #include <cstdint>
+#include <limits>
+#include <utility>
 
 #include "control.h"
 #include "controls/plrctrls.h"
@@ -24,8 +28,10 @@
 #include "inv.h"
 #include "levels/trigs.h"
 #include "lighting.h"
+#include "lua/game_events.hpp"
 #include "monster.h"
 #include "spells.h"
+#include "utils/soft_float.hpp"
 #include "utils/str_cat.hpp"
 
 namespace devilution {
@@ -80,18 +86,76 @@ bool CheckBlock(Point from, Point to)
 	return false;
 }
 
+/** @brief Largest radius FindClosest supports, same as FindClosestValidPosition. */
+constexpr int MaxFindClosestRadius = 50;
+
+/**
+ * @brief Position of each displacement in the order DoCrawl visits them.
+ */
+struct CrawlOrderTable {
+	static constexpr int Size = 2 * MaxFindClosestRadius + 1;
+
+	std::array<std::array<uint16_t, Size>, Size> index;
+	/** @brief Index of the first displacement visited for each radius, the last entry marks the end of the table. */
+	std::array<uint16_t, MaxFindClosestRadius + 2> radiusStart;
+};
+
+const CrawlOrderTable &GetCrawlOrder()
+{
+	static const CrawlOrderTable Table = [] {
+		CrawlOrderTable table {};
+		for (auto &column : table.index)
+			column.fill(std::numeric_limits<uint16_t>::max());
+		uint16_t index = 0;
+		for (int radius = 0; radius <= MaxFindClosestRadius; radius++) {
+			table.radiusStart[radius] = index;
+			DoCrawl(radius, [&](Displacement displacement) {
+				table.index[displacement.deltaX + MaxFindClosestRadius][displacement.deltaY + MaxFindClosestRadius] = index++;
+				return true;
+			});
+		}
+		table.radiusStart[MaxFindClosestRadius + 1] = index;
+		return table;
+	}();
+	return Table;
+}
+
+/**
+ * @brief Finds the first monster in line of sight that a crawl from radius 1 to rad around source would reach.
+ *
+ * Only tiles marked in dMonster can match and a monster only ever marks its tile, old or future position, so instead of
+ * crawling every tile in range this sorts those few positions of the active monsters into crawl order.
+ */
 Monster *FindClosest(Point source, int rad)
 {
-	std::optional<Point> monsterPosition = FindClosestValidPosition(
-	    [&source](Point target) {
-		    // search for a monster with clear line of sight
-		    return InDungeonBounds(target) && dMonster[target.x][target.y] > 0 && !CheckBlock(source, target);
-	    },
-	    source, 1, rad);
+	rad = std::min(rad, MaxFindClosestRadius);
+	const CrawlOrderTable &crawlOrder = GetCrawlOrder();
+	const uint16_t first = crawlOrder.radiusStart[1];
+	const uint16_t end = crawlOrder.radiusStart[rad + 1];
+
+	std::array<std::pair<uint16_t, Point>, MaxMonsters * 3> candidates;
+	size_t candidateCount = 0;
+	for (size_t i = 0; i < ActiveMonsterCount; i++) {
+		const Monster &monster = Monsters[ActiveMonsters[i]];
+		for (Point position : { monster.position.tile, monster.position.old, monster.position.future }) {
+			const Displacement offset = position - source;
+			if (std::abs(offset.deltaX) > rad || std::abs(offset.deltaY) > rad)
+				continue;
+			if (!InDungeonBounds(position) || dMonster[position.x][position.y] <= 0)
+				continue;
+			const uint16_t order = crawlOrder.index[offset.deltaX + MaxFindClosestRadius][offset.deltaY + MaxFindClosestRadius];
+			if (order < first || order >= end)
+				continue;
+			candidates[candidateCount++] = { order, position };
+		}
+	}
+	std::sort(candidates.begin(), candidates.begin() + candidateCount, [](const auto &a, const auto &b) { return a.first < b.first; });
 
-	if (monsterPosition) {
-		int mid = dMonster[monsterPosition->x][monsterPosition->y];
-		return &Monsters[mid - 1];
+	for (size_t i = 0; i < candidateCount; i++) {
+		const Point position = candidates[i].second;
+		// search for a monster with clear line of sight
+		if (!CheckBlock(source, position))
+			return &Monsters[dMonster[position.x][position.y] - 1];
 	}
 
 	return nullptr;
@@ -474,6 +538,15 @@ void CheckMissileCol(Missile &missile, DamageType damageType, int minDamage, int
 		PlaySfxLoc(missileData.miSFX, missile.position.tile);
 }
 
+/**
+ * @brief Scales a velocity component the way `static_cast<int>(delta * factor)` with a float factor would.
+ */
+int ScaleVelocity(int delta, SoftFloat factor)
+{
+	const int value = static_cast<int>((SoftFloat::FromInt(static_cast<uint32_t>(std::abs(delta))) * factor).truncate());
+	return delta < 0 ? -value : value;
+}
+
 bool MoveMissile(Missile &missile, tl::function_ref<bool(Point)> checkTile, bool ifCheckTileFailsDontMoveToTile = false)
 {
 	Point prevTile = missile.position.tile;
@@ -492,8 +565,9 @@ bool MoveMissile(Missile &missile, tl::function_ref<bool(Point)> checkTile, bool
 	// Did the missile skip a tile?
 	if (possibleVisitTiles > 1) {
 		auto speed = abs(missile.position.velocity);
-		const auto denominator = static_cast<float>((2 * speed.deltaY >= speed.deltaX) ? 2 * speed.deltaY : speed.deltaX);
-		auto incVelocity = missile.position.velocity * ((32 << 16) / denominator);
+		const int denominator = (2 * speed.deltaY >= speed.deltaX) ? 2 * speed.deltaY : speed.deltaX;
+		const SoftFloat factor = SoftFloat::FromInt(32 << 16) / SoftFloat::FromInt(static_cast<uint32_t>(denominator));
+		const Displacement incVelocity { ScaleVelocity(missile.position.velocity.deltaX, factor), ScaleVelocity(missile.position.velocity.deltaY, factor) };
 		auto traveled = missile.position.traveled - missile.position.velocity;
 		// Adjust the traveled vector to start on the next smallest multiple of incVelocity
 		if (incVelocity.deltaY != 0)
@@ -768,6 +842,11 @@ void TestRotateBlockedMissile(Missile &missile)
 {
 	RotateBlockedMissile(missile);
 }
+
+Monster *TestFindClosest(Point source, int rad)
+{
+	return FindClosest(source, rad);
+}
 #endif
 
 bool IsMissileBlockedByTile(Point tile)
@@ -2761,6 +2840,7 @@ Missile *AddMissile(WorldTilePosition src, WorldTilePosition dst, Direction midi
 		return nullptr;
 	}
 
+	LuaMissileAddedEvent(missile);
 	return &missile;
 }
 
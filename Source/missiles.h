@@ -459,6 +459,7 @@ void RedoMissileFlags();
 
 #ifdef BUILD_TESTING
 void TestRotateBlockedMissile(Missile &missile);
+Monster *TestFindClosest(Point source, int rad);
 #endif
 
 } // namespace devilution
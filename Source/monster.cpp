@@ -32,6 +32,7 @@
 #include "levels/themes.h"
 #include "levels/trigs.h"
 #include "lighting.h"
+#include "lua/game_events.hpp"
 #include "minitext.h"
 #include "missiles.h"
 #include "movie.h"
@@ -847,7 +848,7 @@ void DiabloDeath(Monster &diablo, bool sendmsg)
 		dist = 20;
 	diablo.var3 = ViewPosition.x << 16;
 	diablo.position.temp.x = ViewPosition.y << 16;
-	diablo.position.temp.y = (int)((diablo.var3 - (diablo.position.tile.x << 16)) / (double)dist);
+	diablo.position.temp.y = (diablo.var3 - (diablo.position.tile.x << 16)) / std::max(dist, 1);
 	if (!gbIsMultiplayer) {
 		Player &myPlayer = *MyPlayer;
 		myPlayer.pDiabloKillLevel = std::max(myPlayer.pDiabloKillLevel, static_cast<uint8_t>(sgGameInitInfo.nDifficulty + 1));
@@ -3102,13 +3103,20 @@ MonsterSpritesData LoadMonsterSpritesData(const MonsterData &monsterData)
 	const size_t numAnims = GetNumAnims(monsterData);
 
 	MonsterSpritesData result;
+#ifdef UNPACKED_MPQS
 	result.data = MultiFileLoader<MonsterSpritesData::MaxAnims> {}(
+	    LevelArena, numAnims,
+	    FileNameWithCharAffixGenerator({ "monsters\\", monsterData.spritePath() }, DEVILUTIONX_CL2_EXT, Animletter),
+	    result.offsets.data(),
+	    [&monsterData](size_t index) { return monsterData.hasAnim(index); });
+#else
+	// The CL2 files are only needed until they are converted, so they stay out of the level arena.
+	const std::unique_ptr<std::byte[]> cl2Data = MultiFileLoader<MonsterSpritesData::MaxAnims> {}(
 	    numAnims,
 	    FileNameWithCharAffixGenerator({ "monsters\\", monsterData.spritePath() }, DEVILUTIONX_CL2_EXT, Animletter),
 	    result.offsets.data(),
 	    [&monsterData](size_t index) { return monsterData.hasAnim(index); });
 
-#ifndef UNPACKED_MPQS
 	// Convert CL2 to CLX:
 	std::vector<std::vector<uint8_t>> clxData;
 	size_t accumulatedSize = 0;
@@ -3118,15 +3126,14 @@ MonsterSpritesData LoadMonsterSpritesData(const MonsterData &monsterData)
 		const uint32_t begin = result.offsets[j];
 		const uint32_t end = result.offsets[j + 1];
 		clxData.emplace_back();
-		Cl2ToClx(reinterpret_cast<uint8_t *>(&result.data[begin]), end - begin,
+		Cl2ToClx(reinterpret_cast<uint8_t *>(&cl2Data[begin]), end - begin,
 		    PointerOrValue<uint16_t> { monsterData.width }, clxData.back());
 		result.offsets[j] = static_cast<uint32_t>(accumulatedSize);
 		accumulatedSize += clxData.back().size();
 		++j;
 	}
 	result.offsets[clxData.size()] = static_cast<uint32_t>(accumulatedSize);
-	result.data = nullptr;
-	result.data = std::unique_ptr<std::byte[]>(new std::byte[accumulatedSize]);
+	result.data = LevelArena.allocate<std::byte>(accumulatedSize);
 	for (size_t i = 0; i < clxData.size(); ++i) {
 		memcpy(&result.data[result.offsets[i]], clxData[i].data(), clxData[i].size());
 	}
@@ -3421,7 +3428,7 @@ void InitMonsterGFX(CMonster &monsterType, MonsterSpritesData &&spritesData)
 	const MonsterData &monsterData = MonstersData[mtype];
 	if (spritesData.data == nullptr)
 		spritesData = LoadMonsterSpritesData(monsterData);
-	monsterType.animData = std::move(spritesData.data);
+	monsterType.animData = spritesData.data;
 
 	const size_t numAnims = GetNumAnims(monsterData);
 	for (size_t i = 0, j = 0; i < numAnims; ++i) {
@@ -3505,8 +3512,8 @@ void InitAllMonsterGFX()
 		MonsterSpritesData spritesData = LoadMonsterSpritesData(firstMonster.data());
 		const size_t spritesDataSize = spritesData.offsets[GetNumAnimsWithGraphics(firstMonster.data())];
 		for (size_t i = 1; i < monsterTypes.size(); ++i) {
-			MonsterSpritesData spritesDataCopy { std::unique_ptr<std::byte[]> { new std::byte[spritesDataSize] }, spritesData.offsets };
-			memcpy(spritesDataCopy.data.get(), spritesData.data.get(), spritesDataSize);
+			MonsterSpritesData spritesDataCopy { LevelArena.allocate<std::byte>(spritesDataSize), spritesData.offsets };
+			memcpy(spritesDataCopy.data, spritesData.data, spritesDataSize);
 			InitMonsterGFX(LevelMonsterTypes[monsterTypes[i]], std::move(spritesDataCopy));
 		}
 		LogVerbose("Loaded monster graphics: {:15s} {:>4d} KiB   x{:d}", firstMonster.data().spritePath(), spritesDataSize / 1024, monsterTypes.size());
@@ -3860,6 +3867,7 @@ void StartMonsterDeath(Monster &monster, const Player &player, bool sendmsg)
 	monster.tag(player);
 	Direction md = GetDirection(monster.position.tile, player.position.tile);
 	MonsterDeath(monster, md, sendmsg);
+	LuaMonsterKilledEvent(monster, player);
 }
 
 void KillMyGolem()
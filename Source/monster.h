@@ -177,12 +177,14 @@ enum class MonsterSound : uint8_t {
 
 struct MonsterSpritesData {
 	static constexpr size_t MaxAnims = 6;
-	std::unique_ptr<std::byte[]> data;
+	/** Allocated from LevelArena. */
+	std::byte *data = nullptr;
 	std::array<uint32_t, MaxAnims + 1> offsets;
 };
 
 struct CMonster {
-	std::unique_ptr<std::byte[]> animData;
+	/** Allocated from LevelArena, so it must not outlive the current level. */
+	std::byte *animData = nullptr;
 	AnimStruct anims[6];
 	std::unique_ptr<TSnd> sounds[4][2];
 
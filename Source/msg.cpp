@@ -178,6 +178,7 @@ std::string_view CmdIdString(_cmd_id cmd)
 	case CMD_OPENHIVE: return "CMD_OPENHIVE";
 	case CMD_OPENGRAVE: return "CMD_OPENGRAVE";
 	case CMD_SPAWNMONSTER: return "CMD_SPAWNMONSTER";
+	case CMD_STATEHASH: return "CMD_STATEHASH";
 	case FAKE_CMD_SETID: return "FAKE_CMD_SETID";
 	case FAKE_CMD_DROPID: return "FAKE_CMD_DROPID";
 	case CMD_INVALID: return "CMD_INVALID";
@@ -2393,6 +2394,19 @@ size_t OnSpawnMonster(const TCmd *pCmd, const Player &player)
 	return sizeof(message);
 }
 
+size_t OnStateHash(const TCmd *pCmd, const Player &player)
+{
+	const auto &message = *reinterpret_cast<const TCmdStateHash *>(pCmd);
+	if (gbBufferMsgs == 1)
+		return sizeof(message);
+
+	GameStateHash hash;
+	for (size_t i = 0; i < NumGameStateCategories; i++)
+		hash.categories[i] = SDL_SwapLE32(message.hashes[i]);
+	DesyncCheckReceive(player, SDL_SwapLE32(message.tick), message.level, message.isSetLevel != 0, hash);
+	return sizeof(message);
+}
+
 } // namespace
 
 void PrepareItemForNetwork(const Item &item, TItem &messageItem)
@@ -2842,6 +2856,19 @@ void NetSendCmdSpawnMonster(Point position, Direction dir, uint16_t typeIndex, u
 	NetSendHiPri(MyPlayerId, (std::byte *)&cmd, sizeof(cmd));
 }
 
+void NetSendCmdStateHash(uint32_t tick, uint8_t level, bool isSetLevel, const GameStateHash &hash)
+{
+	TCmdStateHash cmd;
+
+	cmd.bCmd = CMD_STATEHASH;
+	cmd.tick = SDL_SwapLE32(tick);
+	cmd.level = level;
+	cmd.isSetLevel = isSetLevel ? 1 : 0;
+	for (size_t i = 0; i < NumGameStateCategories; i++)
+		cmd.hashes[i] = SDL_SwapLE32(hash.categories[i]);
+	NetSendLoPri(MyPlayerId, (std::byte *)&cmd, sizeof(cmd));
+}
+
 void NetSendCmdLoc(uint8_t playerId, bool bHiPri, _cmd_id bCmd, Point position)
 {
 	if (playerId == MyPlayerId && WasPlayerCmdAlreadyRequested(bCmd, position))
@@ -3352,6 +3379,8 @@ size_t ParseCmd(uint8_t pnum, const TCmd *pCmd)
 		return OnOpenGrave(pCmd);
 	case CMD_SPAWNMONSTER:
 		return OnSpawnMonster(pCmd, player);
+	case CMD_STATEHASH:
+		return OnStateHash(pCmd, player);
 	default:
 		break;
 	}
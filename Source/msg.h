@@ -7,6 +7,7 @@
 
 #include <cstdint>
 
+#include "desync.h"
 #include "engine/point.hpp"
 #include "items.h"
 #include "monster.h"
@@ -420,6 +421,10 @@ enum _cmd_id : uint8_t {
 	//
 	// body (TCmdSpawnMonster)
 	CMD_SPAWNMONSTER,
+	// Game state hash of the sender for a game tick, used to detect desyncs.
+	//
+	// body (TCmdStateHash)
+	CMD_STATEHASH,
 	// Fake command; set current player for succeeding mega pkt buffer messages.
 	//
 	// body (TFakeCmdPlr)
@@ -528,6 +533,14 @@ struct TCmdSpawnMonster {
 	uint32_t seed;
 };
 
+struct TCmdStateHash {
+	_cmd_id bCmd;
+	uint32_t tick;
+	uint8_t level;
+	uint8_t isSetLevel;
+	uint32_t hashes[NumGameStateCategories];
+};
+
 struct TCmdQuest {
 	_cmd_id bCmd;
 	int8_t q;
@@ -753,6 +766,7 @@ void ClearLastSentPlayerCmd();
 void NetSendCmd(bool bHiPri, _cmd_id bCmd);
 void NetSendCmdGolem(uint8_t mx, uint8_t my, Direction dir, uint8_t menemy, int hp, uint8_t cl);
 void NetSendCmdSpawnMonster(Point position, Direction dir, uint16_t typeIndex, uint16_t monsterId, uint32_t seed);
+void NetSendCmdStateHash(uint32_t tick, uint8_t level, bool isSetLevel, const GameStateHash &hash);
 void NetSendCmdLoc(uint8_t playerId, bool bHiPri, _cmd_id bCmd, Point position);
 void NetSendCmdLocParam1(bool bHiPri, _cmd_id bCmd, Point position, uint16_t wParam1);
 void NetSendCmdLocParam2(bool bHiPri, _cmd_id bCmd, Point position, uint16_t wParam1, uint16_t wParam2);
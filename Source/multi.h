@@ -55,6 +55,8 @@ extern std::string GameName;
 extern std::string GamePassword;
 extern bool PublicGame;
 extern uint8_t gbDeltaSender;
+/** @brief Game tick counter that is kept in step between all players. */
+extern uint32_t sgdwGameLoops;
 extern uint32_t player_state[MAX_PLRS];
 extern bool IsLoopback;
 
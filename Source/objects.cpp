@@ -24,6 +24,7 @@
 #include "engine/load_file.hpp"
 #include "engine/points_in_rectangle_range.hpp"
 #include "engine/random.hpp"
+#include "engine/render/clx_hit_mask.hpp"
 #include "init.h"
 #include "inv.h"
 #include "inv_iterators.hpp"
@@ -251,6 +252,98 @@ bool IsAreaOk(Rectangle rect)
 	return c_all_of(PointsInRectangle(rect), &RndLocOk);
 }
 
+/**
+ * @brief Summed-area table of the tiles RndLocOk rejects, so a rectangle can be checked without looking at every tile.
+ *
+ * Only stays valid while the level is changed by nothing but the objects reported to MarkObjectAdded.
+ */
+class RndLocMap {
+public:
+	RndLocMap()
+	    : blocked_((MAXDUNX + 1) * (MAXDUNY + 1), 0)
+	{
+		for (int y = 0; y < MAXDUNY; y++) {
+			uint16_t rowBlocked = 0;
+			for (int x = 0; x < MAXDUNX; x++) {
+				if (!RndLocOk({ x, y }))
+					rowBlocked++;
+				blocked_[Index(x + 1, y + 1)] = blocked_[Index(x + 1, y)] + rowBlocked;
+			}
+		}
+	}
+
+	bool IsAreaOk(Rectangle rect) const
+	{
+		const Point end = rect.position + Displacement { rect.size };
+		if (rect.position.x < 0 || rect.position.y < 0 || end.x > MAXDUNX || end.y > MAXDUNY)
+			return devilution::IsAreaOk(rect);
+		for (const Rectangle &changed : changed_) {
+			if (Overlaps(rect, changed))
+				return devilution::IsAreaOk(rect);
+		}
+		const int blocked = blocked_[Index(end.x, end.y)] - blocked_[Index(rect.position.x, end.y)]
+		    - blocked_[Index(end.x, rect.position.y)] + blocked_[Index(rect.position.x, rect.position.y)];
+		return blocked == 0;
+	}
+
+	/**
+	 * @brief Makes checks near a new object look at the tiles again.
+	 *
+	 * Objects only place themselves in dObject next to their position, see AddSarcophagus and AddLargeFountain.
+	 */
+	void MarkObjectAdded(Point position)
+	{
+		changed_.push_back({ position - Displacement { 1, 1 }, Size { 3, 3 } });
+	}
+
+private:
+	static size_t Index(int x, int y)
+	{
+		return static_cast<size_t>(y) * (MAXDUNX + 1) + x;
+	}
+
+	static bool Overlaps(Rectangle a, Rectangle b)
+	{
+		return a.position.x < b.position.x + b.size.width && b.position.x < a.position.x + a.size.width
+		    && a.position.y < b.position.y + b.size.height && b.position.y < a.position.y + a.size.height;
+	}
+
+	/** @brief Number of rejected tiles above and to the left of each tile. */
+	std::vector<uint16_t> blocked_;
+	std::vector<Rectangle> changed_;
+};
+
+/**
+ * @brief Checks the candidates of a random placement loop, switching to a RndLocMap once the loop has rejected enough
+ * candidates for building one to pay off.
+ *
+ * The candidates and the random numbers drawn for them are the same either way.
+ */
+class RndLocSampler {
+public:
+	bool IsAreaOk(Rectangle rect)
+	{
+		if (!map_ && ++checks_ > RndLocMapThreshold)
+			map_.emplace();
+		if (map_)
+			return map_->IsAreaOk(rect);
+		return devilution::IsAreaOk(rect);
+	}
+
+	void ObjectAdded(Point position)
+	{
+		if (map_)
+			map_->MarkObjectAdded(position);
+	}
+
+private:
+	/** @brief Building the map costs about as much as checking this many 3x3 candidates. */
+	static constexpr int RndLocMapThreshold = 1024;
+
+	int checks_ = 0;
+	std::optional<RndLocMap> map_;
+};
+
 bool CanPlaceWallTrap(int xp, int yp)
 {
 	if (dObject[xp][yp] != 0)
@@ -265,12 +358,14 @@ void InitRndLocObj(int min, int max, _object_id objtype)
 {
 	int numobjs = GenerateRnd(max - min) + min;
 
+	RndLocSampler sampler;
 	for (int i = 0; i < numobjs; i++) {
 		while (true) {
 			int xp = GenerateRnd(80) + 16;
 			int yp = GenerateRnd(80) + 16;
-			if (IsAreaOk(Rectangle { { xp - 1, yp - 1 }, { 3, 3 } })) {
+			if (sampler.IsAreaOk(Rectangle { { xp - 1, yp - 1 }, { 3, 3 } })) {
 				AddObject(objtype, { xp, yp });
+				sampler.ObjectAdded({ xp, yp });
 				break;
 			}
 		}
@@ -280,29 +375,32 @@ void InitRndLocObj(int min, int max, _object_id objtype)
 void InitRndLocBigObj(int min, int max, _object_id objtype)
 {
 	int numobjs = GenerateRnd(max - min) + min;
+	RndLocSampler sampler;
 	for (int i = 0; i < numobjs; i++) {
 		while (true) {
 			int xp = GenerateRnd(80) + 16;
 			int yp = GenerateRnd(80) + 16;
-			if (IsAreaOk(Rectangle { { xp - 1, yp - 2 }, { 3, 4 } })) {
+			if (sampler.IsAreaOk(Rectangle { { xp - 1, yp - 2 }, { 3, 4 } })) {
 				AddObject(objtype, { xp, yp });
+				sampler.ObjectAdded({ xp, yp });
 				break;
 			}
 		}
 	}
 }
 
-bool CanPlaceRandomObject(Point position, Displacement standoff)
+bool CanPlaceRandomObject(Point position, Displacement standoff, RndLocSampler &sampler)
 {
-	return IsAreaOk(Rectangle { position - standoff,
+	return sampler.IsAreaOk(Rectangle { position - standoff,
 	    Size { standoff.deltaX * 2 + 1, standoff.deltaY * 2 + 1 } });
 }
 
 std::optional<Point> GetRandomObjectPosition(Displacement standoff)
 {
+	RndLocSampler sampler;
 	for (int i = 0; i <= 20000; i++) {
 		Point position = Point { GenerateRnd(80), GenerateRnd(80) } + Displacement { 16, 16 };
-		if (CanPlaceRandomObject(position, standoff))
+		if (CanPlaceRandomObject(position, standoff, sampler))
 			return position;
 	}
 	return {};
@@ -745,10 +843,11 @@ void AddCryptStoryBook(int s)
 
 void AddNakrulLever()
 {
+	RndLocSampler sampler;
 	while (true) {
 		int xp = GenerateRnd(80) + 16;
 		int yp = GenerateRnd(80) + 16;
-		if (IsAreaOk(Rectangle { { xp - 1, yp - 1 }, { 3, 3 } })) {
+		if (sampler.IsAreaOk(Rectangle { { xp - 1, yp - 1 }, { 3, 3 } })) {
 			break;
 		}
 	}
@@ -864,11 +963,12 @@ void AddLazStand()
 	int cnt = 0;
 	int xp;
 	int yp;
+	RndLocSampler sampler;
 	while (true) {
 		xp = GenerateRnd(80) + 16;
 		yp = GenerateRnd(80) + 16;
 
-		if (!IsAreaOk(Rectangle { { xp - 2, yp - 3 }, { 6, 7 } })) {
+		if (!sampler.IsAreaOk(Rectangle { { xp - 2, yp - 3 }, { 6, 7 } })) {
 			cnt++;
 			if (cnt > 10000) {
 				InitRndLocObj(1, 1, OBJ_LAZSTAND);
@@ -1413,13 +1513,14 @@ Point GetRndObjLoc(int randarea)
 	int tries = 0;
 	int x;
 	int y;
+	RndLocSampler sampler;
 	while (true) {
 		tries++;
 		if (tries > 1000 && randarea > 1)
 			randarea--;
 		x = GenerateRnd(MAXDUNX);
 		y = GenerateRnd(MAXDUNY);
-		if (IsAreaOk(Rectangle { { x, y }, { randarea, randarea } }))
+		if (sampler.IsAreaOk(Rectangle { { x, y }, { randarea, randarea } }))
 			break;
 	}
 	return { x, y };
@@ -1437,7 +1538,7 @@ void AddMushPatch()
 	}
 }
 
-bool IsLightVisible(Object &light, int lightRadius)
+bool IsLightVisible(const Object &light, int lightRadius)
 {
 #ifdef _DEBUG
 	if (DisableLighting)
@@ -1459,13 +1560,108 @@ bool IsLightVisible(Object &light, int lightRadius)
 	return false;
 }
 
+/**
+ * @brief Remembers which object lights are within reach of a player. Player movement is tracked on a coarse grid, so
+ * the distances only have to be measured again for lights near a player that moved.
+ */
+class ObjectLightTracker {
+public:
+	/** @brief Notes where players arrived or left since the last tick, call once per tick before IsVisible. */
+	void BeginTick()
+	{
+		tick_++;
+
+		bool everythingChanged = players_.size() != Players.size();
+#ifdef _DEBUG
+		everythingChanged = everythingChanged || lightingDisabled_ != DisableLighting;
+		lightingDisabled_ = DisableLighting;
+#endif
+		if (everythingChanged) {
+			players_.resize(Players.size());
+			for (auto &column : cellChanged_)
+				column.fill(tick_);
+		}
+
+		for (size_t i = 0; i < Players.size(); i++) {
+			const Player &player = Players[i];
+			const PlayerState state { player.plractive && player.isOnActiveLevel(), player.position.tile };
+			PlayerState &previous = players_[i];
+			if (state.present == previous.present && (!state.present || state.tile == previous.tile))
+				continue;
+			if (previous.present)
+				MarkChanged(previous.tile);
+			if (state.present)
+				MarkChanged(state.tile);
+			previous = state;
+		}
+	}
+
+	/** @brief Same result as IsLightVisible. */
+	bool IsVisible(const Object &light, int lightRadius)
+	{
+		CachedVisibility &cached = cache_[light.GetId()];
+		const Point cell = CellOf(light.position);
+		if (cached.tick == 0 || cached.tick < cellChanged_[cell.x][cell.y] || cached.position != light.position || cached.radius != lightRadius) {
+			cached = { tick_, light.position, lightRadius, IsLightVisible(light, lightRadius) };
+		}
+		return cached.visible;
+	}
+
+private:
+	static constexpr int CellSize = 8;
+	static constexpr int GridWidth = (MAXDUNX + CellSize - 1) / CellSize;
+	static constexpr int GridHeight = (MAXDUNY + CellSize - 1) / CellSize;
+	/** @brief Distance from a player at which lights can change, the largest radius passed to UpdateObjectLight plus 10. */
+	static constexpr int MaxReach = 8 + 10;
+
+	struct PlayerState {
+		bool present;
+		Point tile;
+	};
+
+	struct CachedVisibility {
+		/** @brief Tick the visibility was measured in, 0 if it never was. */
+		uint32_t tick;
+		Point position;
+		int radius;
+		bool visible;
+	};
+
+	static Point CellOf(Point tile)
+	{
+		return { std::clamp(tile.x, 0, MAXDUNX - 1) / CellSize, std::clamp(tile.y, 0, MAXDUNY - 1) / CellSize };
+	}
+
+	/** @brief Invalidates the lights a player on the tile could reach. */
+	void MarkChanged(Point tile)
+	{
+		const Point first = CellOf(tile - Displacement { MaxReach, MaxReach });
+		const Point last = CellOf(tile + Displacement { MaxReach, MaxReach });
+		for (int x = first.x; x <= last.x; x++) {
+			for (int y = first.y; y <= last.y; y++)
+				cellChanged_[x][y] = tick_;
+		}
+	}
+
+	uint32_t tick_ = 0;
+	std::vector<PlayerState> players_;
+#ifdef _DEBUG
+	bool lightingDisabled_ = false;
+#endif
+	/** @brief Last tick a player arrived at or left the reach of the lights in each cell. */
+	std::array<std::array<uint32_t, GridHeight>, GridWidth> cellChanged_ {};
+	std::array<CachedVisibility, MAXOBJECTS> cache_ {};
+};
+
+ObjectLightTracker ObjectLights;
+
 void UpdateObjectLight(Object &light, int lightRadius)
 {
 	if (light._oVar1 == -1) {
 		return;
 	}
 
-	if (IsLightVisible(light, lightRadius)) {
+	if (ObjectLights.IsVisible(light, lightRadius)) {
 		if (light._oVar1 == 0)
 			light._olid = AddLight(light.position, lightRadius);
 		light._oVar1 = 1;
@@ -2835,7 +3031,7 @@ void OperateShrineGlowing(Player &player)
 
 	// Take 5% of the players experience to offset the bonus, unless they're very low level in which case take all their experience.
 	if (player._pExperience > 5000)
-		player._pExperience = static_cast<uint32_t>(player._pExperience * 0.95);
+		player._pExperience = static_cast<uint32_t>(static_cast<uint64_t>(player._pExperience) * 95 / 100);
 	else
 		player._pExperience = 0;
 
@@ -3725,6 +3921,7 @@ void InitObjectGFX()
 
 void FreeObjectGFX()
 {
+	ClearClxHitMaskCache();
 	for (int i = 0; i < numobjfiles; i++) {
 		pObjCels[i] = std::nullopt;
 	}
@@ -4172,6 +4369,7 @@ void OperateTrap(Object &trap)
 
 void ProcessObjects()
 {
+	ObjectLights.BeginTick();
 	for (int i = 0; i < ActiveObjectCount; ++i) {
 		Object &object = Objects[ActiveObjects[i]];
 		switch (object._otype) {
@@ -4899,4 +5097,21 @@ void SyncNakrulRoom()
 	dPiece[UberRow][UberCol + 1] = 298;
 }
 
+#ifdef BUILD_TESTING
+bool TestIsLightVisible(const Object &light, int lightRadius)
+{
+	return IsLightVisible(light, lightRadius);
+}
+
+Point TestGetRndObjLoc(int randarea)
+{
+	return GetRndObjLoc(randarea);
+}
+
+std::optional<Point> TestGetRandomObjectPosition(Displacement standoff)
+{
+	return GetRandomObjectPosition(standoff);
+}
+#endif
+
 } // namespace devilution
@@ -7,6 +7,7 @@
 
 #include <cmath>
 #include <cstdint>
+#include <optional>
 
 #include "engine/clx_sprite.hpp"
 #include "engine/point.hpp"
@@ -354,4 +355,11 @@ void SyncObjectAnim(Object &object);
 void GetObjectStr(const Object &object);
 void SyncNakrulRoom();
 
+#ifdef BUILD_TESTING
+/** @brief Whether a light is in reach of a player, measured against every player like before ObjectLightTracker. */
+bool TestIsLightVisible(const Object &light, int lightRadius);
+Point TestGetRndObjLoc(int randarea);
+std::optional<Point> TestGetRandomObjectPosition(Displacement standoff);
+#endif
+
 } // namespace devilution
@@ -1148,12 +1148,16 @@ std::vector<OptionEntryBase *> ControllerOptions::GetEntries()
 NetworkOptions::NetworkOptions()
     : OptionCategoryBase("Network", N_("Network"), N_("Network Settings"))
     , port("Port", OptionEntryFlags::Invisible, "Port", "What network port to use.", 6112)
+    , desyncCheckInterval("DesyncCheckInterval", OptionEntryFlags::Invisible, "Desync Check Interval", "Number of game ticks between comparing game state hashes with the other players, 0 to disable.", 0)
+    , desyncDump("DesyncDump", OptionEntryFlags::Invisible, "Desync Dump", "Write the entity hashes to a file when the game state differs from another player.", false)
 {
 }
 std::vector<OptionEntryBase *> NetworkOptions::GetEntries()
 {
 	return {
 		&port,
+		&desyncCheckInterval,
+		&desyncDump,
 	};
 }
 
@@ -628,6 +628,10 @@ struct NetworkOptions : OptionCategoryBase {
 	char szPreviousHost[129];
 	/** @brief What network port to use. */
 	OptionEntryInt<uint16_t> port;
+	/** @brief Number of game ticks between comparing game state hashes with the other players, 0 to disable. */
+	OptionEntryInt<uint16_t> desyncCheckInterval;
+	/** @brief Write the entity hashes to a file when the game state differs from another player. */
+	OptionEntryBoolean desyncDump;
 };
 
 struct ChatOptions : OptionCategoryBase {
@@ -21,6 +21,7 @@
 #include "engine/load_file.hpp"
 #include "engine/points_in_rectangle_range.hpp"
 #include "engine/random.hpp"
+#include "engine/render/clx_hit_mask.hpp"
 #include "engine/render/clx_render.hpp"
 #include "engine/trn.hpp"
 #include "engine/world_tile.hpp"
@@ -31,6 +32,7 @@
 #include "levels/trigs.h"
 #include "lighting.h"
 #include "loadsave.h"
+#include "lua/game_events.hpp"
 #include "minitext.h"
 #include "missiles.h"
 #include "nthread.h"
@@ -45,6 +47,7 @@
 #include "towners.h"
 #include "utils/language.h"
 #include "utils/log.hpp"
+#include "utils/soft_float.hpp"
 #include "utils/str_cat.hpp"
 #include "utils/utf8.hpp"
 
@@ -2238,6 +2241,7 @@ void InitPlayerGFX(Player &player)
 
 void ResetPlayerGFX(Player &player)
 {
+	ClearClxHitMaskCache();
 	player.AnimInfo.sprites = std::nullopt;
 	for (PlayerAnimationData &animData : player.AnimationData) {
 		animData.sprites = std::nullopt;
@@ -2455,6 +2459,7 @@ void NextPlrLevel(Player &player)
 	CalcPlrInv(player, true);
 	PlaySFX(SfxID::ItemArmor);
 	PlaySFX(SfxID::ItemSign);
+	LuaPlayerLevelUpEvent(player);
 }
 
 void Player::_addExperience(uint32_t experience, int levelDelta)
@@ -2466,8 +2471,9 @@ void Player::_addExperience(uint32_t experience, int levelDelta)
 		return;
 	}
 
-	// Adjust xp based on difference between the players current level and the target level (usually a monster level)
-	uint32_t clampedExp = static_cast<uint32_t>(std::clamp<int64_t>(static_cast<int64_t>(experience * (1 + levelDelta / 10.0)), 0, std::numeric_limits<uint32_t>::max()));
+	// Adjust xp based on difference between the players current level and the target level (usually a monster level), +/-10% per level.
+	// Monster levels stay far below the difference of 600000 levels that the double emulation supports.
+	uint32_t clampedExp = static_cast<uint32_t>(std::min<int64_t>(MultiplyByTenthsLikeDouble(experience, std::min(levelDelta, 600000)), std::numeric_limits<uint32_t>::max()));
 
 	// Prevent power leveling
 	if (gbIsMultiplayer) {
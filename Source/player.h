@@ -364,6 +364,10 @@ public:
 	uint8_t pDiabloKillLevel;
 	uint16_t wReflections;
 	ItemSpecialEffectHf pDamAcFlags;
+	/** @brief Bonuses of each body slot as of the last stat calculation, see CalcPlrItemVals() */
+	std::array<ItemBonuses, NUM_INVLOC> equippedItemBonuses;
+	/** @brief Strength, magic and dexterity the stat flags of the carried items were last updated for */
+	std::array<int, 3> itemStatFlagsStats = { -1, -1, -1 };
 
 	/**
 	 * @brief Convenience function to get the base stats/bonuses for this player's class
@@ -1,43 +1,68 @@
 #include "floatingnumbers.h"
 
+#include <array>
 #include <cstdint>
 #include <ctime>
-#include <deque>
 #include <fmt/format.h>
-#include <string>
+#include <string_view>
 
 #include "engine/render/text_render.hpp"
 #include "options.h"
-#include "utils/str_cat.hpp"
 
 namespace devilution {
 
 namespace {
 
+/** @brief Most numbers shown at once, when there are more the oldest ones are dropped early. */
+constexpr size_t MaxFloatingNumbers = 256;
+
 struct FloatingNumber {
 	Point startPos;
 	Displacement startOffset;
 	Displacement endOffset;
-	std::string text;
 	uint32_t time;
 	uint32_t lastMerge;
 	UiFlags style;
 	DamageType type;
 	int value;
 	size_t index;
+	/** @brief Width of the text in pixels, -1 until it is drawn. */
+	int lineWidth;
+	/** @brief Fits any int as well as the two decimals shown for damage below 1. */
+	std::array<char, 12> text;
+	uint8_t textLength;
 	bool reverseDirection;
+
+	[[nodiscard]] std::string_view getText() const
+	{
+		return { text.data(), textLength };
+	}
 };
 
-std::deque<FloatingNumber> FloatingQueue;
+/** @brief Numbers on screen, oldest first, stored as a ring buffer starting at FloatingHead. */
+std::array<FloatingNumber, MaxFloatingNumbers> FloatingNumberRing;
+size_t FloatingHead;
+size_t FloatingCount;
+
+FloatingNumber &GetFloatingNumber(size_t i)
+{
+	return FloatingNumberRing[(FloatingHead + i) % MaxFloatingNumbers];
+}
+
+void PopFloatingNumber()
+{
+	FloatingHead = (FloatingHead + 1) % MaxFloatingNumbers;
+	FloatingCount--;
+}
 
 void ClearExpiredNumbers()
 {
-	while (!FloatingQueue.empty()) {
-		FloatingNumber &num = FloatingQueue.front();
+	while (FloatingCount != 0) {
+		FloatingNumber &num = GetFloatingNumber(0);
 		if (num.time > SDL_GetTicks())
 			break;
 
-		FloatingQueue.pop_front();
+		PopFloatingNumber();
 	}
 }
 
@@ -63,11 +88,14 @@ UiFlags GetFontSizeByDamage(int value)
 
 void UpdateFloatingData(FloatingNumber &num)
 {
+	fmt::format_to_n_result<char *> result;
 	if (num.value > 0 && num.value < 64) {
-		num.text = fmt::format("{:.2f}", num.value / 64.0);
+		result = fmt::format_to_n(num.text.data(), num.text.size(), "{:.2f}", num.value / 64.0);
 	} else {
-		num.text = StrCat(num.value >> 6);
+		result = fmt::format_to_n(num.text.data(), num.text.size(), "{}", num.value >> 6);
 	}
+	num.textLength = static_cast<uint8_t>(result.out - num.text.data());
+	num.lineWidth = -1;
 
 	num.style &= ~(UiFlags::FontSize12 | UiFlags::FontSize24 | UiFlags::FontSize30);
 	num.style |= GetFontSizeByDamage(num.value);
@@ -110,7 +138,8 @@ void AddFloatingNumber(Point pos, Displacement offset, DamageType type, int valu
 	if (damageToPlayer)
 		endOffset = -endOffset;
 
-	for (auto &num : FloatingQueue) {
+	for (size_t i = 0; i < FloatingCount; i++) {
+		FloatingNumber &num = GetFloatingNumber(i);
 		if (num.reverseDirection == damageToPlayer && num.type == type && num.index == index && (SDL_GetTicks() - static_cast<int>(num.lastMerge)) <= 100) {
 			num.value += value;
 			num.lastMerge = SDL_GetTicks();
@@ -118,11 +147,15 @@ void AddFloatingNumber(Point pos, Displacement offset, DamageType type, int valu
 			return;
 		}
 	}
-	FloatingNumber num {
-		pos, offset, endOffset, "", SDL_GetTicks() + 2500, SDL_GetTicks(), UiFlags::Outlined, type, value, index, damageToPlayer
+
+	if (FloatingCount == MaxFloatingNumbers)
+		PopFloatingNumber();
+	FloatingNumber &num = GetFloatingNumber(FloatingCount);
+	FloatingCount++;
+	num = FloatingNumber {
+		pos, offset, endOffset, SDL_GetTicks() + 2500, SDL_GetTicks(), UiFlags::Outlined, type, value, index, -1, {}, 0, damageToPlayer
 	};
 	UpdateFloatingData(num);
-	FloatingQueue.push_back(num);
 }
 
 } // namespace
@@ -174,7 +207,8 @@ void DrawFloatingNumbers(const Surface &out, Point viewPosition, Displacement of
 	if (*sgOptions.Gameplay.enableFloatingNumbers == FloatingNumbers::Off)
 		return;
 
-	for (auto &floatingNum : FloatingQueue) {
+	for (size_t i = 0; i < FloatingCount; i++) {
+		FloatingNumber &floatingNum = GetFloatingNumber(i);
 		Displacement worldOffset = viewPosition - floatingNum.startPos;
 		worldOffset = worldOffset.worldToScreen() + offset + Displacement { TILE_WIDTH / 2, -TILE_HEIGHT / 2 } + floatingNum.startOffset;
 
@@ -184,13 +218,16 @@ void DrawFloatingNumbers(const Surface &out, Point viewPosition, Displacement of
 
 		Point screenPosition { worldOffset.deltaX, worldOffset.deltaY };
 
-		int lineWidth = GetLineWidth(floatingNum.text, GetGameFontSizeByDamage(floatingNum.value));
+		// Only measure the text again when the value changed
+		if (floatingNum.lineWidth == -1)
+			floatingNum.lineWidth = GetLineWidth(floatingNum.getText(), GetGameFontSizeByDamage(floatingNum.value));
+		const int lineWidth = floatingNum.lineWidth;
 		screenPosition.x -= lineWidth / 2;
 		uint32_t timeLeft = floatingNum.time - SDL_GetTicks();
-		float mul = 1 - (timeLeft / 2500.0f);
-		screenPosition += floatingNum.endOffset * mul;
+		const float mul = 1 - (timeLeft / 2500.0f);
+		screenPosition += Displacement { static_cast<int>(floatingNum.endOffset.deltaX * mul), static_cast<int>(floatingNum.endOffset.deltaY * mul) };
 
-		DrawString(out, floatingNum.text, Rectangle { screenPosition, { lineWidth, 0 } },
+		DrawString(out, floatingNum.getText(), Rectangle { screenPosition, { lineWidth, 0 } },
 		    { .flags = floatingNum.style });
 	}
 
@@ -201,7 +238,8 @@ void ClearFloatingNumbers()
 {
 	srand(static_cast<unsigned int>(time(nullptr)));
 
-	FloatingQueue.clear();
+	FloatingHead = 0;
+	FloatingCount = 0;
 }
 
 } // namespace devilution
@@ -1,6 +1,7 @@
 #include "qol/stash.h"
 
 #include <algorithm>
+#include <bit>
 #include <cstdint>
 #include <utility>
 
@@ -21,6 +22,7 @@
 #include "inv.h"
 #include "minitext.h"
 #include "stores.h"
+#include "utils/algorithm/container.hpp"
 #include "utils/format_int.hpp"
 #include "utils/language.h"
 #include "utils/str_cat.hpp"
@@ -34,7 +36,6 @@ bool IsWithdrawGoldOpen;
 
 namespace {
 
-constexpr unsigned CountStashPages = 100;
 constexpr unsigned LastStashPage = CountStashPages - 1;
 
 char GoldWithdrawText[21];
@@ -70,6 +71,33 @@ void AddItemToStashGrid(unsigned page, Point position, uint16_t stashListIndex,
 	for (Point point : PointsInRectangle(Rectangle { position, itemSize })) {
 		Stash.stashGrids[page][point.x][point.y] = stashListIndex + 1;
 	}
+	Stash.PageChanged(page);
+	Stash.searchIndex.Update(stashListIndex, Stash.stashList[stashListIndex], page);
+}
+
+std::optional<StashSearchQuery> StashSearch;
+/** @brief Matching items of StashSearch by stash list index, valid for StashSearchGeneration of the search index. */
+std::vector<bool> StashSearchMatches;
+uint32_t StashSearchGeneration;
+
+/** @return The stash list indexes of all matches, ordered by page. */
+std::vector<uint16_t> RefreshStashSearchMatches()
+{
+	std::vector<uint16_t> matches = Stash.searchIndex.Find(*StashSearch);
+	StashSearchMatches.assign(Stash.searchIndex.size(), false);
+	for (uint16_t stashIndex : matches)
+		StashSearchMatches[stashIndex] = true;
+	StashSearchGeneration = Stash.searchIndex.generation();
+	return matches;
+}
+
+bool IsStashSearchMatch(StashStruct::StashCell stashIndex)
+{
+	if (!StashSearch)
+		return false;
+	if (StashSearchGeneration != Stash.searchIndex.generation())
+		RefreshStashSearchMatches();
+	return stashIndex < StashSearchMatches.size() && StashSearchMatches[stashIndex];
 }
 
 std::optional<Point> FindTargetSlotUnderItemCursor(Point cursorPosition, Size itemSize)
@@ -163,8 +191,8 @@ void CheckStashPaste(Point cursorPosition)
 	} else {
 		// swap the held item and whatever was in the stash at this position
 		std::swap(Stash.stashList[stashIndex], player.HoldItem);
-		// then clear the space occupied by the old item
-		for (auto &row : Stash.GetCurrentGrid()) {
+		// then clear the space occupied by the old item, which was found on the current page so its grid exists
+		for (auto &row : *Stash.FindGrid(Stash.GetPage())) {
 			for (auto &itemId : row) {
 				if (itemId - 1 == stashIndex)
 					itemId = 0;
@@ -390,6 +418,8 @@ void DrawStash(const Surface &out)
 		if (pcursstashitem == itemId) {
 			uint8_t color = GetOutlineColor(item, true);
 			ClxDrawOutline(out, color, position, sprite);
+		} else if (IsStashSearchMatch(itemId)) {
+			ClxDrawOutline(out, ICOL_YELLOW, position, sprite);
 		}
 
 		DrawItem(item, out, position, sprite);
@@ -518,12 +548,15 @@ bool UseStashItem(uint16_t c)
 void StashStruct::RemoveStashItem(StashStruct::StashCell iv)
 {
 	// Iterate through stashGrid and remove every reference to item
-	for (auto &row : Stash.GetCurrentGrid()) {
-		for (StashStruct::StashCell &itemId : row) {
-			if (itemId - 1 == iv) {
-				itemId = 0;
+	if (StashGrid *grid = FindGrid(GetPage()); grid != nullptr) {
+		for (auto &row : *grid) {
+			for (StashStruct::StashCell &itemId : row) {
+				if (itemId - 1 == iv) {
+					itemId = 0;
+				}
 			}
 		}
+		PageChanged(GetPage());
 	}
 
 	if (stashList.empty()) {
@@ -546,9 +579,102 @@ void StashStruct::RemoveStashItem(StashStruct::StashCell iv)
 		}
 	}
 	stashList.pop_back();
+	searchIndex.Remove(iv);
 	Stash.dirty = true;
 }
 
+void StashStruct::ItemChanged(StashCell iv)
+{
+	searchIndex.Update(iv, stashList[iv], searchIndex.GetPage(iv));
+	dirty = true;
+}
+
+std::optional<std::pair<unsigned, Point>> StashStruct::FindFreeArea(Size itemSize, unsigned startPage)
+{
+	if (itemSize.width > StashGridSize.width || itemSize.height > StashGridSize.height)
+		return {};
+
+	for (unsigned pageIndex = 0; pageIndex < CountStashPages; pageIndex++) {
+		if (!occupancyValid.test(pageIndex))
+			UpdateOccupancy(pageIndex);
+	}
+
+	const bool isSummarized = itemSize.width <= MaxSummarizedSize.width && itemSize.height <= MaxSummarizedSize.height;
+	const std::bitset<CountStashPages> *candidatePages = nullptr;
+	if (isSummarized) {
+		candidatePages = &pagesWithRoom[(itemSize.height - 1) * MaxSummarizedSize.width + itemSize.width - 1];
+		if (candidatePages->none())
+			return {};
+	}
+
+	for (unsigned pageCounter = 0; pageCounter < CountStashPages; pageCounter++) {
+		unsigned pageIndex = startPage + pageCounter;
+		// Wrap around if needed
+		if (pageIndex >= CountStashPages)
+			pageIndex -= CountStashPages;
+		if (candidatePages != nullptr && !candidatePages->test(pageIndex))
+			continue;
+		for (int y = 0; y <= StashGridSize.height - itemSize.height; y++) {
+			const uint16_t columns = FittingColumns(pageIndex, y, itemSize);
+			if (columns != 0)
+				return std::make_pair(pageIndex, Point { std::countr_zero(columns), y });
+		}
+	}
+
+	return {};
+}
+
+void StashStruct::UpdateOccupancy(unsigned gridPage)
+{
+	const StashGrid *grid = FindGrid(gridPage);
+	for (int y = 0; y < StashGridSize.height; y++) {
+		FreeRow row = 0;
+		for (int x = 0; x < StashGridSize.width; x++) {
+			if (grid == nullptr || (*grid)[x][y] == 0)
+				row |= 1 << x;
+		}
+		freeRows[gridPage][y] = row;
+	}
+	occupancyValid.set(gridPage);
+
+	for (int height = 1; height <= MaxSummarizedSize.height; height++) {
+		for (int width = 1; width <= MaxSummarizedSize.width; width++) {
+			bool hasRoom = false;
+			for (int y = 0; y <= StashGridSize.height - height && !hasRoom; y++)
+				hasRoom = FittingColumns(gridPage, y, { width, height }) != 0;
+			pagesWithRoom[(height - 1) * MaxSummarizedSize.width + width - 1][gridPage] = hasRoom;
+		}
+	}
+}
+
+uint16_t StashStruct::FittingColumns(unsigned gridPage, int row, Size itemSize) const
+{
+	// Columns that are free in all rows the item covers...
+	uint16_t free = (1 << StashGridSize.width) - 1;
+	for (int y = row; y < row + itemSize.height; y++)
+		free &= freeRows[gridPage][y];
+	// ...and have enough free columns to their right
+	uint16_t fitting = free;
+	for (int x = 1; x < itemSize.width; x++)
+		fitting &= free >> x;
+	return fitting;
+}
+
+void StashStruct::RebuildSearchIndex()
+{
+	searchIndex.Clear();
+	for (const auto &[gridPage, grid] : stashGrids) {
+		for (const auto &column : grid) {
+			for (StashCell cell : column) {
+				if (cell == 0 || cell > stashList.size())
+					continue;
+				const StashCell stashIndex = cell - 1;
+				searchIndex.Update(stashIndex, stashList[stashIndex], gridPage);
+			}
+		}
+	}
+}
+
 void StashStruct::SetPage(unsigned newPage)
 {
 	page = std::min(newPage, LastStashPage);
@@ -679,6 +805,51 @@ bool HandleGoldWithdrawTextInputEvent(const SDL_Event &event)
 	return HandleNumberInputEvent(event, *GoldWithdrawInputState);
 }
 
+size_t SetStashSearch(const StashSearchQuery &query)
+{
+	StashSearch = query;
+	const std::vector<uint16_t> matches = RefreshStashSearchMatches();
+	const bool isMatchOnPage = c_any_of(matches, [](uint16_t stashIndex) {
+		return Stash.searchIndex.GetPage(stashIndex) == Stash.GetPage();
+	});
+	if (!isMatchOnPage)
+		JumpToNextStashSearchMatch();
+	return matches.size();
+}
+
+void ClearStashSearch()
+{
+	StashSearch = std::nullopt;
+	StashSearchMatches.clear();
+}
+
+const StashSearchQuery *GetStashSearch()
+{
+	return StashSearch ? &*StashSearch : nullptr;
+}
+
+bool JumpToNextStashSearchMatch()
+{
+	if (!StashSearch)
+		return false;
+
+	const unsigned currentPage = Stash.GetPage();
+	std::optional<unsigned> nextPage;
+	for (uint16_t stashIndex : Stash.searchIndex.Find(*StashSearch)) {
+		const unsigned matchPage = Stash.searchIndex.GetPage(stashIndex);
+		if (matchPage == currentPage)
+			continue;
+		// Pages are in ascending order, so the first page after the current one is the next page and the first page overall is where it wraps around to
+		if (!nextPage || (*nextPage < currentPage && matchPage > currentPage))
+			nextPage = matchPage;
+	}
+	if (!nextPage)
+		return false;
+
+	Stash.SetPage(*nextPage);
+	return true;
+}
+
 bool AutoPlaceItemInStash(Player &player, const Item &item, bool persistItem)
 {
 	if (!IsItemAllowedInStash(item))
@@ -697,36 +868,19 @@ bool AutoPlaceItemInStash(Player &player, const Item &item, bool persistItem)
 	Size itemSize = GetInventorySize(item);
 
 	// Try to add the item to the current active page and if it's not possible move forward
-	for (unsigned pageCounter = 0; pageCounter < CountStashPages; pageCounter++) {
-		unsigned pageIndex = Stash.GetPage() + pageCounter;
-		// Wrap around if needed
-		if (pageIndex >= CountStashPages)
-			pageIndex -= CountStashPages;
-		// Search all possible position in stash grid
-		for (auto stashPosition : PointsInRectangle(Rectangle { { 0, 0 }, Size { 10 - (itemSize.width - 1), 10 - (itemSize.height - 1) } })) {
-			// Check that all needed slots are free
-			bool isSpaceFree = true;
-			for (auto itemPoint : PointsInRectangle(Rectangle { stashPosition, itemSize })) {
-				uint16_t iv = Stash.stashGrids[pageIndex][itemPoint.x][itemPoint.y];
-				if (iv != 0) {
-					isSpaceFree = false;
-					break;
-				}
-			}
-			if (!isSpaceFree)
-				continue;
-			if (persistItem) {
-				Stash.stashList.push_back(item);
-				uint16_t stashIndex = static_cast<uint16_t>(Stash.stashList.size() - 1);
-				Stash.stashList[stashIndex].position = stashPosition + Displacement { 0, itemSize.height - 1 };
-				AddItemToStashGrid(pageIndex, stashPosition, stashIndex, itemSize);
-				Stash.dirty = true;
-			}
-			return true;
-		}
-	}
+	std::optional<std::pair<unsigned, Point>> freeArea = Stash.FindFreeArea(itemSize, Stash.GetPage());
+	if (!freeArea)
+		return false;
 
-	return false;
+	if (persistItem) {
+		const auto [pageIndex, stashPosition] = *freeArea;
+		Stash.stashList.push_back(item);
+		uint16_t stashIndex = static_cast<uint16_t>(Stash.stashList.size() - 1);
+		Stash.stashList[stashIndex].position = stashPosition + Displacement { 0, itemSize.height - 1 };
+		AddItemToStashGrid(pageIndex, stashPosition, stashIndex, itemSize);
+		Stash.dirty = true;
+	}
+	return true;
 }
 
 } // namespace devilution
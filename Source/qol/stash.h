@@ -5,15 +5,22 @@
  */
 #pragma once
 
+#include <array>
+#include <bitset>
 #include <cstdint>
 #include <map>
+#include <optional>
 #include <vector>
 
 #include "engine/point.hpp"
+#include "engine/size.hpp"
 #include "items.h"
+#include "qol/stash_search.h"
 
 namespace devilution {
 
+constexpr unsigned CountStashPages = 100;
+
 class StashStruct {
 public:
 	using StashCell = uint16_t;
@@ -21,8 +28,13 @@ public:
 	static constexpr StashCell EmptyCell = -1;
 
 	void RemoveStashItem(StashCell iv);
+	/** @brief Updates the search index after the item was changed in place, e.g. identified or repaired. */
+	void ItemChanged(StashCell iv);
+	/** @brief Pages that held an item at some point, call PageChanged() after modifying a grid directly. */
 	std::map<unsigned, StashGrid> stashGrids;
 	std::vector<Item> stashList;
+	/** @brief Kept up to date with stashList by the stash functions. */
+	StashSearchIndex searchIndex;
 	int gold;
 	bool dirty = false;
 
@@ -31,9 +43,20 @@ public:
 		return page;
 	}
 
-	StashGrid &GetCurrentGrid()
+	/**
+	 * @brief Returns the grid of the given page without creating it
+	 * @return nullptr if the page never held an item
+	 */
+	const StashGrid *FindGrid(unsigned gridPage) const
+	{
+		auto it = stashGrids.find(gridPage);
+		return it != stashGrids.end() ? &it->second : nullptr;
+	}
+
+	StashGrid *FindGrid(unsigned gridPage)
 	{
-		return stashGrids[GetPage()];
+		auto it = stashGrids.find(gridPage);
+		return it != stashGrids.end() ? &it->second : nullptr;
 	}
 
 	/**
@@ -41,17 +64,34 @@ public:
 	 * @param gridPosition x,y coordinate of the current stash page
 	 * @return a value which can be used to index into stashList or StashStruct::EmptyCell
 	 */
-	StashCell GetItemIdAtPosition(Point gridPosition)
+	StashCell GetItemIdAtPosition(Point gridPosition) const
 	{
+		const StashGrid *grid = FindGrid(GetPage());
+		if (grid == nullptr)
+			return EmptyCell;
 		// Because StashCell is an unsigned type we can let this underflow
-		return GetCurrentGrid()[gridPosition.x][gridPosition.y] - 1;
+		return (*grid)[gridPosition.x][gridPosition.y] - 1;
 	}
 
-	bool IsItemAtPosition(Point gridPosition)
+	bool IsItemAtPosition(Point gridPosition) const
 	{
 		return GetItemIdAtPosition(gridPosition) != EmptyCell;
 	}
 
+	/** @brief Marks the free space summary of a page as outdated, needs to be called whenever cells of the page are changed. */
+	void PageChanged(unsigned gridPage)
+	{
+		if (gridPage < CountStashPages)
+			occupancyValid.reset(gridPage);
+	}
+
+	/**
+	 * @brief Finds the first free area that fits an item, searching the pages from startPage onwards and wrapping around after the last one.
+	 * Areas on a page are tried row by row. Pages are not created by the search.
+	 * @return Page and top left cell of the area, or nothing if the stash is full
+	 */
+	std::optional<std::pair<unsigned, Point>> FindFreeArea(Size itemSize, unsigned startPage);
+
 	void SetPage(unsigned newPage);
 	void NextPage(unsigned offset = 1);
 	void PreviousPage(unsigned offset = 1);
@@ -59,9 +99,26 @@ public:
 	/** @brief Updates _iStatFlag for all stash items. */
 	void RefreshItemStatFlags();
 
+	/** @brief Indexes all stash items from scratch, used after loading the stash. */
+	void RebuildSearchIndex();
+
 private:
+	/** @brief Largest item size that the page summary keeps track of, bigger items are checked against the cells of each page. */
+	static constexpr Size MaxSummarizedSize { 2, 3 };
+
+	/** @brief One bit per cell of a row, set for cells that are free. */
+	using FreeRow = uint16_t;
+
+	void UpdateOccupancy(unsigned gridPage);
+	/** @brief Returns one bit per column, set if an item of the given size fits with its top left cell in that column of the row. */
+	uint16_t FittingColumns(unsigned gridPage, int row, Size itemSize) const;
+
 	/** Current Page */
 	unsigned page;
+	std::array<std::array<FreeRow, 10>, CountStashPages> freeRows;
+	std::bitset<CountStashPages> occupancyValid;
+	/** @brief For every item size up to MaxSummarizedSize, the pages that have room for it. */
+	std::array<std::bitset<CountStashPages>, MaxSummarizedSize.width * MaxSummarizedSize.height> pagesWithRoom;
 };
 
 constexpr Point InvalidStashPoint { -1, -1 };
@@ -86,6 +143,20 @@ uint16_t CheckStashHLight(Point mousePosition);
 void CheckStashButtonRelease(Point mousePosition);
 void CheckStashButtonPress(Point mousePosition);
 
+/**
+ * @brief Highlights the stash items matching the query, switching to the first page with a match if the current page has none.
+ * @return Number of matching items
+ */
+size_t SetStashSearch(const StashSearchQuery &query);
+void ClearStashSearch();
+/** @brief Returns the stash search that is currently highlighted, if any. */
+const StashSearchQuery *GetStashSearch();
+/**
+ * @brief Switches to the next page after the current one that holds an item matching the stash search, wrapping around after the last page.
+ * @return False if no other page has a match
+ */
+bool JumpToNextStashSearchMatch();
+
 void StartGoldWithdraw();
 void WithdrawGoldKeyPress(SDL_Keycode vkey);
 void DrawGoldWithdraw(const Surface &out);
@@ -0,0 +1,96 @@
+/**
+ * @file qol/stash_search.cpp
+ *
+ * Implementation of the index used to search the player stash.
+ */
+#include "qol/stash_search.h"
+
+#include <algorithm>
+
+#include "utils/str_case.hpp"
+
+namespace devilution {
+
+void StashSearchIndex::Clear()
+{
+	entries_.clear();
+	generation_++;
+}
+
+void StashSearchIndex::Update(uint16_t stashIndex, const Item &item, unsigned page)
+{
+	if (stashIndex >= entries_.size())
+		entries_.resize(stashIndex + 1);
+
+	Entry &entry = entries_[stashIndex];
+	entry.name = AsciiStrToLower(item.getName().str());
+	entry.page = page;
+	entry.value = item._iIdentified ? item._iIvalue : item._ivalue;
+	entry.type = item._itype;
+	entry.quality = item._iMagical;
+	entry.prefix = item._iIdentified ? item._iPrePower : IPL_INVALID;
+	entry.suffix = item._iIdentified ? item._iSufPower : IPL_INVALID;
+	entry.minStrength = item._iMinStr;
+	entry.minMagic = item._iMinMag;
+	entry.minDexterity = item._iMinDex;
+	entry.present = true;
+	generation_++;
+}
+
+void StashSearchIndex::Remove(uint16_t stashIndex)
+{
+	if (stashIndex >= entries_.size())
+		return;
+
+	if (stashIndex != entries_.size() - 1)
+		entries_[stashIndex] = std::move(entries_.back());
+	entries_.pop_back();
+	generation_++;
+}
+
+bool StashSearchIndex::Matches(uint16_t stashIndex, const StashSearchQuery &query) const
+{
+	if (stashIndex >= entries_.size())
+		return false;
+	return EntryMatches(entries_[stashIndex], query, AsciiStrToLower(query.text));
+}
+
+bool StashSearchIndex::EntryMatches(const Entry &entry, const StashSearchQuery &query, std::string_view lowerCaseText)
+{
+	if (!entry.present)
+		return false;
+	if (query.type && entry.type != *query.type)
+		return false;
+	if (query.quality && entry.quality != *query.quality)
+		return false;
+	if (query.affix && entry.prefix != *query.affix && entry.suffix != *query.affix)
+		return false;
+	if (query.maxStrength && entry.minStrength > *query.maxStrength)
+		return false;
+	if (query.maxMagic && entry.minMagic > *query.maxMagic)
+		return false;
+	if (query.maxDexterity && entry.minDexterity > *query.maxDexterity)
+		return false;
+	if (entry.value < query.minValue)
+		return false;
+	if (!lowerCaseText.empty() && entry.name.find(lowerCaseText) == std::string::npos)
+		return false;
+	return true;
+}
+
+std::vector<uint16_t> StashSearchIndex::Find(const StashSearchQuery &query) const
+{
+	const std::string lowerCaseText = AsciiStrToLower(query.text);
+
+	std::vector<uint16_t> result;
+	for (size_t i = 0; i < entries_.size(); i++) {
+		if (EntryMatches(entries_[i], query, lowerCaseText))
+			result.push_back(static_cast<uint16_t>(i));
+	}
+	std::stable_sort(result.begin(), result.end(), [this](uint16_t a, uint16_t b) {
+		return entries_[a].page < entries_[b].page;
+	});
+	return result;
+}
+
+} // namespace devilution
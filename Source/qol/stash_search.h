@@ -0,0 +1,93 @@
+/**
+ * @file qol/stash_search.h
+ *
+ * Interface of the index used to search the player stash.
+ */
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "items.h"
+
+namespace devilution {
+
+/**
+ * @brief Criteria of a stash search, criteria that are not set match every item.
+ */
+struct StashSearchQuery {
+	/** @brief Part of the item name as shown to the player, not case sensitive. */
+	std::string text;
+	std::optional<ItemType> type;
+	std::optional<item_quality> quality;
+	/** @brief Effect of the prefix or suffix, only matches identified items. */
+	std::optional<item_effect_type> affix;
+	/** @brief Only match items that need at most this much strength, magic and dexterity. */
+	std::optional<int> maxStrength;
+	std::optional<int> maxMagic;
+	std::optional<int> maxDexterity;
+	int minValue = 0;
+
+	bool operator==(const StashSearchQuery &other) const = default;
+};
+
+/**
+ * @brief Searchable attributes of the items in StashStruct::stashList, kept in the same order as the list.
+ */
+class StashSearchIndex {
+public:
+	void Clear();
+
+	/** @brief Adds or replaces the entry of the item at the given position of the stash list. */
+	void Update(uint16_t stashIndex, const Item &item, unsigned page);
+
+	/** @brief Removes an entry the same way StashStruct::RemoveStashItem removes the item, by moving the last entry into its place. */
+	void Remove(uint16_t stashIndex);
+
+	[[nodiscard]] bool Matches(uint16_t stashIndex, const StashSearchQuery &query) const;
+
+	/** @brief Returns the stash list indexes of all matching items, ordered by page. */
+	[[nodiscard]] std::vector<uint16_t> Find(const StashSearchQuery &query) const;
+
+	[[nodiscard]] unsigned GetPage(uint16_t stashIndex) const
+	{
+		return entries_[stashIndex].page;
+	}
+
+	[[nodiscard]] size_t size() const
+	{
+		return entries_.size();
+	}
+
+	/** @brief Changes every time an entry is changed, used to tell whether search results are outdated. */
+	[[nodiscard]] uint32_t generation() const
+	{
+		return generation_;
+	}
+
+private:
+	struct Entry {
+		/** @brief Lower case name. */
+		std::string name;
+		unsigned page;
+		int value;
+		ItemType type;
+		item_quality quality;
+		item_effect_type prefix;
+		item_effect_type suffix;
+		int minStrength;
+		int minMagic;
+		int minDexterity;
+		bool present;
+	};
+
+	static bool EntryMatches(const Entry &entry, const StashSearchQuery &query, std::string_view lowerCaseText);
+
+	std::vector<Entry> entries_;
+	uint32_t generation_ = 0;
+};
+
+} // namespace devilution
@@ -15,10 +15,12 @@
 #include "engine/dx.h"
 #include "engine/palette.h"
 #include "options.h"
+#include "storm/storm_svid_queue.hpp"
 #include "utils/aulib.hpp"
 #include "utils/display.h"
 #include "utils/log.hpp"
 #include "utils/sdl_compat.h"
+#include "utils/sdl_indexed_converter.hpp"
 #include "utils/sdl_wrap.h"
 
 namespace devilution {
@@ -28,17 +30,54 @@ namespace {
 std::optional<Aulib::Stream> SVidAudioStream;
 PushAulibDecoder *SVidAudioDecoder;
 std::uint8_t SVidAudioDepth;
-std::unique_ptr<int16_t[]> SVidAudioBuffer;
 #endif
 
+/** Number of frames that the decode thread may run ahead of playback. */
+constexpr size_t SVidDecodeAheadFrames = 4;
+
 uint32_t SVidWidth, SVidHeight;
-double SVidFrameEnd;
+double SVidStartTime;
 double SVidFrameLength;
 bool SVidLoop;
 SmackerHandle SVidHandle;
-std::unique_ptr<uint8_t[]> SVidFrameBuffer;
 SDLPaletteUniquePtr SVidPalette;
 SDLSurfaceUniquePtr SVidSurface;
+IndexedSurfaceConverter SVidConverter;
+
+/**
+ * @brief Feeds frames from `SVidHandle` to the decode queue.
+ *
+ * The Smacker handle is only accessed from the decode thread while the queue is running.
+ */
+class SmackerFrameSource final : public SVidFrameSource {
+public:
+	bool DecodeNextFrame(SVidFrame &frame) override
+	{
+		if (frame.sequence != 0 && Smacker_GetCurrentFrameNum(SVidHandle) >= Smacker_GetNumFrames(SVidHandle)) {
+			if (!SVidLoop) {
+				return false;
+			}
+
+			Smacker_Rewind(SVidHandle);
+		}
+
+		Smacker_GetNextFrame(SVidHandle);
+		Smacker_GetFrame(SVidHandle, frame.pixels.get());
+
+		if (frame.sequence == 0 || Smacker_DidPaletteChange(SVidHandle)) {
+			Smacker_GetPalette(SVidHandle, frame.palette.data());
+			frame.paletteChanged = true;
+		}
+
+		if (frame.audio != nullptr)
+			frame.audioLength = Smacker_GetAudioData(SVidHandle, 0, frame.audio.get());
+
+		return true;
+	}
+};
+
+SmackerFrameSource SVidSmackerSource;
+std::optional<SVidDecodeQueue> SVidQueue;
 
 bool IsLandscapeFit(unsigned long srcW, unsigned long srcH, unsigned long dstW, unsigned long dstH)
 {
@@ -116,29 +155,9 @@ bool HasAudio()
 }
 #endif
 
-bool SVidLoadNextFrame()
-{
-	if (Smacker_GetCurrentFrameNum(SVidHandle) >= Smacker_GetNumFrames(SVidHandle)) {
-		if (!SVidLoop) {
-			return false;
-		}
-
-		Smacker_Rewind(SVidHandle);
-	}
-
-	SVidFrameEnd += SVidFrameLength;
-
-	Smacker_GetNextFrame(SVidHandle);
-	Smacker_GetFrame(SVidHandle, SVidFrameBuffer.get());
-
-	return true;
-}
-
-void UpdatePalette()
+void UpdatePalette(const uint8_t *paletteData)
 {
 	constexpr size_t NumColors = 256;
-	uint8_t paletteData[NumColors * 3];
-	Smacker_GetPalette(SVidHandle, paletteData);
 
 	SDL_Color *colors = SVidPalette->colors;
 	for (unsigned i = 0; i < NumColors; ++i) {
@@ -207,12 +226,9 @@ bool BlitFrame()
 		} else {
 			// The source surface is always 8-bit, and the output surface is never 8-bit in this branch.
 			// We must convert to the output format before calling SDL_BlitScaled.
-#ifdef USE_SDL1
-			SDLSurfaceUniquePtr converted = SDLWrap::ConvertSurface(SVidSurface.get(), ghMainWnd->format, 0);
-#else
-			SDLSurfaceUniquePtr converted = SDLWrap::ConvertSurfaceFormat(SVidSurface.get(), wndFormat, 0);
-#endif
-			if (SDL_BlitScaled(converted.get(), nullptr, outputSurface, &outputRect) <= -1) {
+			// The converted surface is reused across frames and only re-created when the video size or output format changes.
+			SDL_Surface *converted = SVidConverter.Convert(SVidSurface.get(), outputSurface->format);
+			if (SDL_BlitScaled(converted, nullptr, outputSurface, &outputRect) <= -1) {
 				Log("{}", SDL_GetError());
 				return false;
 			}
@@ -223,6 +239,14 @@ bool BlitFrame()
 	return true;
 }
 
+#ifndef NOSOUND
+void SVidCloseAudio()
+{
+	SVidAudioStream = std::nullopt;
+	SVidAudioDecoder = nullptr;
+}
+#endif
+
 } // namespace
 
 bool SVidPlayBegin(const char *filename, int flags)
@@ -247,6 +271,7 @@ bool SVidPlayBegin(const char *filename, int flags)
 		return false;
 	}
 
+	size_t audioBufferSize = 0;
 #ifndef NOSOUND
 	const bool enableAudio = (flags & 0x1000000) == 0;
 
@@ -257,7 +282,7 @@ bool SVidPlayBegin(const char *filename, int flags)
 		sound_stop(); // Stop in-progress music and sound effects
 
 		SVidAudioDepth = audioInfo.bitsPerSample;
-		SVidAudioBuffer = std::unique_ptr<int16_t[]> { new int16_t[audioInfo.idealBufferSize] };
+		audioBufferSize = audioInfo.idealBufferSize;
 		auto decoder = std::make_unique<PushAulibDecoder>(audioInfo.nChannels, audioInfo.sampleRate);
 		SVidAudioDecoder = decoder.get();
 		SVidAudioStream.emplace(/*rwops=*/nullptr, std::move(decoder), CreateAulibResampler(audioInfo.sampleRate), /*closeRw=*/false);
@@ -267,13 +292,10 @@ bool SVidPlayBegin(const char *filename, int flags)
 			SVidMute();
 		if (!SVidAudioStream->open()) {
 			LogError(LogCategory::Audio, "Aulib::Stream::open (from SVidPlayBegin): {}", SDL_GetError());
-			SVidAudioStream = std::nullopt;
-			SVidAudioDecoder = nullptr;
-		}
-		if (!SVidAudioStream->play()) {
+			SVidCloseAudio();
+		} else if (!SVidAudioStream->play()) {
 			LogError(LogCategory::Audio, "Aulib::Stream::play (from SVidPlayBegin): {}", SDL_GetError());
-			SVidAudioStream = std::nullopt;
-			SVidAudioDecoder = nullptr;
+			SVidCloseAudio();
 		}
 	}
 #endif
@@ -297,18 +319,26 @@ bool SVidPlayBegin(const char *filename, int flags)
 	// Set the background to black.
 	SDL_FillRect(GetOutputSurface(), nullptr, 0x000000);
 
-	// The buffer for the frame. It is not the same as the SDL surface because the SDL surface also has pitch padding.
-	SVidFrameBuffer = std::unique_ptr<uint8_t[]> { new uint8_t[static_cast<size_t>(SVidWidth * SVidHeight)] };
+	// Frames are decoded ahead of time on a separate thread, each one into its own buffer.
+	SVidQueue.emplace(SVidSmackerSource, SVidDecodeAheadFrames, static_cast<size_t>(SVidWidth * SVidHeight), audioBufferSize, SVidFrameLength);
+	SVidQueue->Start();
 
-	// Decode first frame.
-	Smacker_GetNextFrame(SVidHandle);
-	Smacker_GetFrame(SVidHandle, SVidFrameBuffer.get());
+	// Wait for the first frame so that we have something to create the surface from.
+	SVidFrame *frame = SVidQueue->Front();
+	if (frame == nullptr) {
+		SVidQueue = std::nullopt;
+#ifndef NOSOUND
+		SVidCloseAudio();
+#endif
+		Smacker_Close(SVidHandle);
+		return false;
+	}
 
-	// Create the surface from the frame buffer data.
+	// Create the surface on top of the frame buffer data.
 	// It will be rendered in `SVidPlayContinue`, called immediately after this function.
-	// Subsequents frames will also be copied to this surface.
+	// Subsequent frames are rendered by pointing the surface at their buffer.
 	SVidSurface = SDLWrap::CreateRGBSurfaceWithFormatFrom(
-	    reinterpret_cast<void *>(SVidFrameBuffer.get()),
+	    reinterpret_cast<void *>(frame->pixels.get()),
 	    static_cast<int>(SVidWidth),
 	    static_cast<int>(SVidHeight),
 	    8,
@@ -316,27 +346,34 @@ bool SVidPlayBegin(const char *filename, int flags)
 	    SDL_PIXELFORMAT_INDEX8);
 
 	SVidPalette = SDLWrap::AllocPalette();
-	UpdatePalette();
 
-	SVidFrameEnd = SDL_GetTicks() * 1000.0 + SVidFrameLength;
+	SVidStartTime = SDL_GetTicks() * 1000.0;
 
 	return true;
 }
 
 bool SVidPlayContinue()
 {
-	if (Smacker_DidPaletteChange(SVidHandle)) {
-		UpdatePalette();
+	SVidFrame *frame = SVidQueue->Front();
+	if (frame == nullptr)
+		return false;
+
+	// Palette changes are applied even for skipped frames, later frames rely on them.
+	if (frame->paletteChanged) {
+		UpdatePalette(frame->palette.data());
 	}
 
-	if (SDL_GetTicks() * 1000.0 >= SVidFrameEnd) {
-		return SVidLoadNextFrame(); // Skip video and audio if the system is to slow
+	const double frameEnd = SVidStartTime + frame->frameEnd;
+
+	if (SDL_GetTicks() * 1000.0 >= frameEnd) {
+		SVidQueue->Pop(/*presented=*/false); // Skip video and audio if the system is to slow
+		return true;
 	}
 
 #ifndef NOSOUND
-	if (HasAudio()) {
-		std::int16_t *buf = SVidAudioBuffer.get();
-		const auto len = Smacker_GetAudioData(SVidHandle, 0, buf);
+	if (HasAudio() && frame->audio != nullptr) {
+		const std::int16_t *buf = frame->audio.get();
+		const auto len = static_cast<unsigned>(frame->audioLength);
 		if (SVidAudioDepth == 16) {
 			SVidAudioDecoder->PushSamples(buf, len / 2);
 		} else {
@@ -345,29 +382,34 @@ bool SVidPlayContinue()
 	}
 #endif
 
-	if (SDL_GetTicks() * 1000.0 >= SVidFrameEnd) {
-		return SVidLoadNextFrame(); // Skip video if the system is to slow
+	if (SDL_GetTicks() * 1000.0 >= frameEnd) {
+		SVidQueue->Pop(/*presented=*/false); // Skip video if the system is to slow
+		return true;
 	}
 
+	SVidSurface->pixels = frame->pixels.get();
 	if (!BlitFrame())
 		return false;
 
 	double now = SDL_GetTicks() * 1000.0;
-	if (now < SVidFrameEnd) {
-		SDL_Delay(static_cast<Uint32>((SVidFrameEnd - now) / 1000.0)); // wait with next frame if the system is too fast
+	if (now < frameEnd) {
+		SDL_Delay(static_cast<Uint32>((frameEnd - now) / 1000.0)); // wait with next frame if the system is too fast
 	}
 
-	return SVidLoadNextFrame();
+	SVidQueue->Pop(/*presented=*/true);
+	return true;
 }
 
 void SVidPlayEnd()
 {
-#ifndef NOSOUND
-	if (HasAudio()) {
-		SVidAudioStream = std::nullopt;
-		SVidAudioDecoder = nullptr;
-		SVidAudioBuffer = nullptr;
+	if (SVidQueue) {
+		SVidQueue->Stop();
+		LogVerbose("SVid: {} frames presented, {} frames dropped", SVidQueue->PresentedFrames(), SVidQueue->DroppedFrames());
+		SVidQueue = std::nullopt;
 	}
+
+#ifndef NOSOUND
+	SVidCloseAudio();
 #endif
 
 	if (SVidHandle.isValid)
@@ -375,7 +417,7 @@ void SVidPlayEnd()
 
 	SVidPalette = nullptr;
 	SVidSurface = nullptr;
-	SVidFrameBuffer = nullptr;
+	SVidConverter.Reset();
 
 #ifndef USE_SDL1
 	if (renderer != nullptr) {
@@ -0,0 +1,106 @@
+#include "storm/storm_svid_queue.hpp"
+
+#include <mutex>
+
+namespace devilution {
+
+SVidDecodeQueue::SVidDecodeQueue(SVidFrameSource &source, size_t capacity, size_t frameSize, size_t audioBufferSize, double frameLength)
+    : source_(source)
+    , frameLength_(frameLength)
+    , frames_(capacity)
+{
+	for (SVidFrame &frame : frames_) {
+		frame.pixels = std::unique_ptr<uint8_t[]> { new uint8_t[frameSize] };
+		if (audioBufferSize != 0)
+			frame.audio = std::unique_ptr<int16_t[]> { new int16_t[audioBufferSize] };
+	}
+}
+
+SVidDecodeQueue::~SVidDecodeQueue()
+{
+	Stop();
+}
+
+void SVidDecodeQueue::Start()
+{
+	thread_ = SdlThread { ThreadProc, this };
+}
+
+void SVidDecodeQueue::Stop()
+{
+	{
+		std::lock_guard<SdlMutex> lock(mutex_);
+		stopRequested_ = true;
+	}
+	slotFree_.notify_all();
+	frameReady_.notify_all();
+	thread_.join();
+}
+
+SVidFrame *SVidDecodeQueue::Front()
+{
+	std::unique_lock<SdlMutex> lock(mutex_);
+	frameReady_.wait(lock, [this]() { return count_ != 0 || finished_ || stopRequested_; });
+	if (count_ == 0 || stopRequested_)
+		return nullptr;
+	return &frames_[head_];
+}
+
+void SVidDecodeQueue::Pop(bool presented)
+{
+	{
+		std::lock_guard<SdlMutex> lock(mutex_);
+		if (count_ == 0)
+			return;
+		head_ = (head_ + 1) % frames_.size();
+		count_--;
+		if (presented)
+			presentedFrames_++;
+		else
+			droppedFrames_++;
+	}
+	slotFree_.notify_one();
+}
+
+int SDLCALL SVidDecodeQueue::ThreadProc(void *data)
+{
+	static_cast<SVidDecodeQueue *>(data)->Run();
+	return 0;
+}
+
+void SVidDecodeQueue::Run()
+{
+	uint32_t sequence = 0;
+	while (true) {
+		size_t tail;
+		{
+			std::unique_lock<SdlMutex> lock(mutex_);
+			slotFree_.wait(lock, [this]() { return count_ < frames_.size() || stopRequested_; });
+			if (stopRequested_)
+				return;
+			tail = (head_ + count_) % frames_.size();
+		}
+
+		// The consumer never touches a slot outside of [head_, head_ + count_), so we can decode without holding the lock.
+		SVidFrame &frame = frames_[tail];
+		frame.sequence = sequence;
+		frame.frameEnd = (sequence + 1) * frameLength_;
+		frame.paletteChanged = false;
+		frame.audioLength = 0;
+		const bool decoded = source_.DecodeNextFrame(frame);
+
+		{
+			std::lock_guard<SdlMutex> lock(mutex_);
+			if (decoded)
+				count_++;
+			else
+				finished_ = true;
+		}
+		frameReady_.notify_one();
+		if (!decoded)
+			return;
+		sequence++;
+	}
+}
+
+} // namespace devilution
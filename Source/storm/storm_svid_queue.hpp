@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "utils/sdl_cond.h"
+#include "utils/sdl_mutex.h"
+#include "utils/sdl_thread.h"
+
+namespace devilution {
+
+/**
+ * @brief A decoded video frame together with the palette and audio that belong to it.
+ */
+struct SVidFrame {
+	/** @brief Position of the frame in the playback sequence, keeps counting up when looping. */
+	uint32_t sequence;
+	/** @brief Deadline for presenting this frame, in microseconds since the start of playback. */
+	double frameEnd;
+	/** @brief Palettized pixels, one byte per pixel without any pitch padding. */
+	std::unique_ptr<uint8_t[]> pixels;
+	/** @brief Whether `palette` must be applied before this frame is shown. */
+	bool paletteChanged;
+	std::array<uint8_t, 256 * 3> palette;
+	/** @brief Audio samples for this frame, or nullptr if audio is not being decoded. */
+	std::unique_ptr<int16_t[]> audio;
+	/** @brief Length of the audio data in bytes. */
+	size_t audioLength;
+};
+
+/**
+ * @brief Source of frames for SVidDecodeQueue, only ever called from the decode thread.
+ */
+class SVidFrameSource {
+public:
+	virtual ~SVidFrameSource() = default;
+
+	/**
+	 * @brief Decodes the next frame into the pre-allocated buffers of `frame`.
+	 * @return false when there are no more frames.
+	 */
+	virtual bool DecodeNextFrame(SVidFrame &frame) = 0;
+};
+
+/**
+ * @brief Bounded queue of frames that are decoded ahead of time on a worker thread.
+ *
+ * Frames are handed to the consumer strictly in decode order, so audio chunks and
+ * palette changes stay attached to the frame they were decoded with.
+ */
+class SVidDecodeQueue {
+public:
+	/**
+	 * @param source Frame source, must outlive the queue
+	 * @param capacity Maximum number of frames decoded ahead
+	 * @param frameSize Size of a frame in bytes
+	 * @param audioBufferSize Number of audio samples per frame, 0 to skip audio
+	 * @param frameLength Duration of a frame in microseconds
+	 */
+	SVidDecodeQueue(SVidFrameSource &source, size_t capacity, size_t frameSize, size_t audioBufferSize, double frameLength);
+	~SVidDecodeQueue();
+
+	SVidDecodeQueue(const SVidDecodeQueue &) = delete;
+	SVidDecodeQueue &operator=(const SVidDecodeQueue &) = delete;
+
+	void Start();
+
+	/** @brief Stops and joins the decode thread, any frames still queued are discarded. */
+	void Stop();
+
+	/**
+	 * @brief Waits for the next frame to be decoded.
+	 * @return The oldest queued frame, or nullptr once the source is exhausted.
+	 */
+	SVidFrame *Front();
+
+	/**
+	 * @brief Hands the front frame back to the decoder.
+	 * @param presented false if the frame was skipped because playback fell behind
+	 */
+	void Pop(bool presented);
+
+	uint32_t PresentedFrames() const
+	{
+		return presentedFrames_;
+	}
+
+	uint32_t DroppedFrames() const
+	{
+		return droppedFrames_;
+	}
+
+private:
+	static int SDLCALL ThreadProc(void *data);
+	void Run();
+
+	SVidFrameSource &source_;
+	double frameLength_;
+	std::vector<SVidFrame> frames_;
+	size_t head_ = 0;
+	size_t count_ = 0;
+	bool finished_ = false;
+	bool stopRequested_ = false;
+	uint32_t presentedFrames_ = 0;
+	uint32_t droppedFrames_ = 0;
+
+	SdlMutex mutex_;
+	SdlCond frameReady_;
+	SdlCond slotFree_;
+	SdlThread thread_;
+};
+
+} // namespace devilution
@@ -7,6 +7,7 @@
 #include "engine/load_cel.hpp"
 #include "engine/load_file.hpp"
 #include "engine/random.hpp"
+#include "engine/render/clx_hit_mask.hpp"
 #include "inv.h"
 #include "minitext.h"
 #include "stores.h"
@@ -841,6 +842,7 @@ void InitTowners()
 
 void FreeTownerGFX()
 {
+	ClearClxHitMaskCache();
 	for (Towner &towner : Towners) {
 		towner.ownedAnim = std::nullopt;
 	}
@@ -0,0 +1,127 @@
+#include "utils/arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__SANITIZE_ADDRESS__)
+#define DEVILUTIONX_ARENA_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define DEVILUTIONX_ARENA_ASAN
+#endif
+#endif
+
+#ifdef DEVILUTIONX_ARENA_ASAN
+#include <sanitizer/asan_interface.h>
+#endif
+
+namespace devilution {
+
+namespace {
+
+void Poison([[maybe_unused]] const std::byte *begin, [[maybe_unused]] size_t size)
+{
+#ifdef DEVILUTIONX_ARENA_ASAN
+	ASAN_POISON_MEMORY_REGION(begin, size);
+#endif
+}
+
+void Unpoison([[maybe_unused]] const std::byte *begin, [[maybe_unused]] size_t size)
+{
+#ifdef DEVILUTIONX_ARENA_ASAN
+	ASAN_UNPOISON_MEMORY_REGION(begin, size);
+#endif
+}
+
+size_t AlignUp(size_t value, size_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+Arena::Arena(size_t chunkSize)
+    : chunkSize_(chunkSize)
+{
+}
+
+Arena::~Arena()
+{
+	release();
+}
+
+void Arena::addChunk(size_t size)
+{
+	Chunk &chunk = chunks_.emplace_back(Chunk { std::unique_ptr<std::byte[]> { new std::byte[size] }, size, 0 });
+	Poison(chunk.data.get(), chunk.size);
+}
+
+void *Arena::allocateBytes(size_t size, size_t alignment)
+{
+	size = std::max<size_t>(size, 1);
+	for (int attempt = 0; attempt < 2; attempt++) {
+		if (!chunks_.empty()) {
+			Chunk &chunk = chunks_.back();
+			const auto base = reinterpret_cast<uintptr_t>(chunk.data.get());
+			const size_t offset = AlignUp(base + chunk.used, alignment) - base;
+			if (offset <= chunk.size && size <= chunk.size - offset) {
+				std::byte *result = chunk.data.get() + offset;
+				Unpoison(result, size);
+				paddingBytes_ += offset - chunk.used;
+				usedBytes_ += offset + size - chunk.used;
+				peakUsedBytes_ = std::max(peakUsedBytes_, usedBytes_);
+				chunk.used = offset + size;
+				numAllocations_++;
+				return result;
+			}
+		}
+		addChunk(std::max(chunkSize_, size + alignment - 1));
+	}
+	return nullptr;
+}
+
+void Arena::reset()
+{
+	if (chunks_.empty())
+		return;
+	if (chunks_.size() > 1) {
+		// Replace the chunks with one block that would have held the whole fill.
+		const size_t size = AlignUp(usedBytes_, chunkSize_);
+		release();
+		addChunk(size);
+	} else {
+		Chunk &chunk = chunks_.back();
+		chunk.used = 0;
+		Poison(chunk.data.get(), chunk.size);
+	}
+	usedBytes_ = 0;
+	paddingBytes_ = 0;
+	numAllocations_ = 0;
+}
+
+void Arena::release()
+{
+	for (Chunk &chunk : chunks_)
+		Unpoison(chunk.data.get(), chunk.size);
+	chunks_.clear();
+	usedBytes_ = 0;
+	paddingBytes_ = 0;
+	numAllocations_ = 0;
+}
+
+ArenaStats Arena::stats() const
+{
+	ArenaStats stats {};
+	stats.usedBytes = usedBytes_;
+	stats.peakUsedBytes = peakUsedBytes_;
+	stats.numAllocations = numAllocations_;
+	stats.numChunks = chunks_.size();
+	stats.wastedBytes = paddingBytes_;
+	for (const Chunk &chunk : chunks_)
+		stats.reservedBytes += chunk.size;
+	if (!chunks_.empty())
+		stats.wastedBytes += stats.reservedBytes - chunks_.back().size - (usedBytes_ - chunks_.back().used);
+	return stats;
+}
+
+} // namespace devilution
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace devilution {
+
+struct ArenaStats {
+	/** @brief Bytes handed out since the last reset, including alignment padding. */
+	size_t usedBytes;
+	/** @brief Bytes currently reserved from the heap. */
+	size_t reservedBytes;
+	/** @brief Highest `usedBytes` seen over the arena's lifetime. */
+	size_t peakUsedBytes;
+	/** @brief Bytes lost to alignment padding and to chunk tails too small for the next allocation. */
+	size_t wastedBytes;
+	size_t numAllocations;
+	size_t numChunks;
+};
+
+/**
+ * @brief A bump allocator for data that is freed all at once.
+ *
+ * Memory is carved out of large chunks and is only returned by `reset()` or `release()`.
+ * `reset()` merges the chunks into a single block sized for the last fill, so an arena that is filled
+ * and reset repeatedly (e.g. once per dungeon level) settles on one heap allocation.
+ *
+ * Under AddressSanitizer the unused and reset parts of every chunk are poisoned.
+ */
+class Arena {
+public:
+	static constexpr size_t DefaultChunkSize = 1024 * 1024;
+
+	explicit Arena(size_t chunkSize = DefaultChunkSize);
+	~Arena();
+
+	Arena(const Arena &) = delete;
+	Arena &operator=(const Arena &) = delete;
+
+	/**
+	 * @brief Allocates uninitialized storage for `count` objects of type `T`.
+	 *
+	 * The memory stays valid until the next `reset()` or `release()`. No destructors are run.
+	 */
+	template <typename T>
+	[[nodiscard]] T *allocate(size_t count)
+	{
+		static_assert(std::is_trivially_destructible_v<T>, "Arena does not run destructors");
+		return static_cast<T *>(allocateBytes(count * sizeof(T), alignof(T)));
+	}
+
+	[[nodiscard]] void *allocateBytes(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	/** @brief Invalidates all allocations but keeps the memory for reuse. */
+	void reset();
+
+	/** @brief Invalidates all allocations and returns all memory to the heap. */
+	void release();
+
+	[[nodiscard]] ArenaStats stats() const;
+
+private:
+	struct Chunk {
+		std::unique_ptr<std::byte[]> data;
+		size_t size;
+		size_t used;
+	};
+
+	void addChunk(size_t size);
+
+	std::vector<Chunk> chunks_;
+	size_t chunkSize_;
+	size_t usedBytes_ = 0;
+	size_t peakUsedBytes_ = 0;
+	size_t paddingBytes_ = 0;
+	size_t numAllocations_ = 0;
+};
+
+} // namespace devilution
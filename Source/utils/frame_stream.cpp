@@ -0,0 +1,225 @@
+#include "utils/frame_stream.hpp"
+
+#include <cstring>
+
+#include "utils/endian.hpp"
+
+namespace devilution {
+
+namespace {
+
+constexpr char Magic[4] = { 'D', 'X', 'F', 'S' };
+constexpr uint16_t Version = 1;
+constexpr uint8_t PaletteChanged = 1;
+
+/** @brief Shortest run of identical or unchanged pixels that is worth ending a literal for. */
+constexpr size_t MinRun = 4;
+
+void WriteVarint(std::vector<uint8_t> &out, size_t value)
+{
+	while (value >= 0x80) {
+		out.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<uint8_t>(value));
+}
+
+bool ReadVarint(const uint8_t *&src, const uint8_t *end, size_t &value)
+{
+	value = 0;
+	for (unsigned shift = 0; shift < 35; shift += 7) {
+		if (src == end)
+			return false;
+		const uint8_t byte = *src++;
+		value |= static_cast<size_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
+
+/** @brief Whether the `MinRun` pixels at `pos` all have the same value. */
+bool IsFillAt(const uint8_t *pixels, size_t pos, size_t count)
+{
+	if (count - pos < MinRun)
+		return false;
+	for (size_t i = 1; i < MinRun; i++) {
+		if (pixels[pos + i] != pixels[pos])
+			return false;
+	}
+	return true;
+}
+
+/** @brief Whether the `MinRun` pixels at `pos` are the same as in the previous frame. */
+bool IsUnchangedAt(const uint8_t *pixels, const uint8_t *previous, size_t pos, size_t count)
+{
+	if (count - pos < MinRun)
+		return false;
+	return memcmp(&pixels[pos], &previous[pos], MinRun) == 0;
+}
+
+bool WriteBytes(const void *data, size_t size, FILE *out)
+{
+	return size == 0 || std::fwrite(data, size, 1, out) == 1;
+}
+
+bool ReadBytes(void *data, size_t size, FILE *in)
+{
+	return size == 0 || std::fread(data, size, 1, in) == 1;
+}
+
+} // namespace
+
+FrameStreamWriter::FrameStreamWriter(FILE *out, int width, int height)
+    : out_(out)
+    , previous_(static_cast<size_t>(width) * height)
+{
+	uint8_t header[10];
+	memcpy(header, Magic, sizeof(Magic));
+	WriteLE16(&header[4], Version);
+	WriteLE16(&header[6], static_cast<uint16_t>(width));
+	WriteLE16(&header[8], static_cast<uint16_t>(height));
+	ok_ = WriteBytes(header, sizeof(header), out_);
+}
+
+void FrameStreamWriter::EncodePixels(const uint8_t *pixels)
+{
+	const uint8_t *previous = previous_.data();
+	const size_t count = previous_.size();
+	encoded_.clear();
+
+	size_t pos = 0;
+	while (pos < count) {
+		size_t skip = 0;
+		while (pos + skip < count && pixels[pos + skip] == previous[pos + skip])
+			skip++;
+		WriteVarint(encoded_, skip);
+		pos += skip;
+		if (pos == count)
+			break;
+
+		if (IsFillAt(pixels, pos, count)) {
+			size_t end = pos + MinRun;
+			while (end < count && pixels[end] == pixels[pos])
+				end++;
+			WriteVarint(encoded_, (end - pos) << 1 | 1);
+			encoded_.push_back(pixels[pos]);
+			pos = end;
+			continue;
+		}
+
+		size_t end = pos + 1;
+		while (end < count && !IsFillAt(pixels, end, count) && !IsUnchangedAt(pixels, previous, end, count))
+			end++;
+		WriteVarint(encoded_, (end - pos) << 1);
+		encoded_.insert(encoded_.end(), &pixels[pos], &pixels[end]);
+		pos = end;
+	}
+
+	memcpy(previous_.data(), pixels, count);
+}
+
+bool FrameStreamWriter::WriteFrame(uint32_t number, const uint8_t *pixels, const std::array<SDL_Color, 256> &palette)
+{
+	if (!ok_)
+		return false;
+
+	const bool paletteChanged = !hasPalette_ || memcmp(palette.data(), palette_.data(), sizeof(palette_)) != 0;
+	palette_ = palette;
+	hasPalette_ = true;
+	EncodePixels(pixels);
+
+	uint8_t header[5];
+	WriteLE32(&header[0], number);
+	header[4] = paletteChanged ? PaletteChanged : 0;
+	ok_ = WriteBytes(header, sizeof(header), out_);
+	if (ok_ && paletteChanged) {
+		uint8_t colors[256 * 3];
+		for (size_t i = 0; i < 256; i++) {
+			colors[i * 3 + 0] = palette[i].r;
+			colors[i * 3 + 1] = palette[i].g;
+			colors[i * 3 + 2] = palette[i].b;
+		}
+		ok_ = WriteBytes(colors, sizeof(colors), out_);
+	}
+	uint8_t size[4];
+	WriteLE32(size, static_cast<uint32_t>(encoded_.size()));
+	ok_ = ok_ && WriteBytes(size, sizeof(size), out_) && WriteBytes(encoded_.data(), encoded_.size(), out_);
+	return ok_;
+}
+
+FrameStreamReader::FrameStreamReader(FILE *in)
+    : in_(in)
+{
+	uint8_t header[10];
+	if (!ReadBytes(header, sizeof(header), in_) || memcmp(header, Magic, sizeof(Magic)) != 0 || LoadLE16(&header[4]) != Version)
+		return;
+	width_ = LoadLE16(&header[6]);
+	height_ = LoadLE16(&header[8]);
+	pixels_.resize(static_cast<size_t>(width_) * height_);
+	ok_ = true;
+}
+
+bool FrameStreamReader::DecodePixels()
+{
+	const uint8_t *src = encoded_.data();
+	const uint8_t *const end = src + encoded_.size();
+	const size_t count = pixels_.size();
+
+	size_t pos = 0;
+	while (pos < count) {
+		size_t skip;
+		if (!ReadVarint(src, end, skip) || skip > count - pos)
+			return false;
+		pos += skip;
+		if (pos == count)
+			break;
+
+		size_t run;
+		if (!ReadVarint(src, end, run))
+			return false;
+		const size_t length = run >> 1;
+		if (length == 0 || length > count - pos)
+			return false;
+		if ((run & 1) != 0) {
+			if (src == end)
+				return false;
+			memset(&pixels_[pos], *src++, length);
+		} else {
+			if (static_cast<size_t>(end - src) < length)
+				return false;
+			memcpy(&pixels_[pos], src, length);
+			src += length;
+		}
+		pos += length;
+	}
+	return src == end;
+}
+
+bool FrameStreamReader::ReadFrame()
+{
+	if (!ok_)
+		return false;
+
+	uint8_t header[5];
+	if (!ReadBytes(header, sizeof(header), in_))
+		return false;
+	number_ = LoadLE32(&header[0]);
+	if ((header[4] & PaletteChanged) != 0) {
+		uint8_t colors[256 * 3];
+		if (!ReadBytes(colors, sizeof(colors), in_))
+			return false;
+		for (size_t i = 0; i < 256; i++)
+			palette_[i] = SDL_Color { colors[i * 3 + 0], colors[i * 3 + 1], colors[i * 3 + 2], SDL_ALPHA_OPAQUE };
+	}
+	uint8_t size[4];
+	if (!ReadBytes(size, sizeof(size), in_))
+		return false;
+	encoded_.resize(LoadLE32(size));
+	if (!ReadBytes(encoded_.data(), encoded_.size(), in_))
+		return false;
+	ok_ = DecodePixels();
+	return ok_;
+}
+
+} // namespace devilution
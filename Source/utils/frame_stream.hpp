@@ -0,0 +1,120 @@
+/**
+ * @file frame_stream.hpp
+ *
+ * Stream of indexed-color frames, each delta coded against the one before it.
+ *
+ * All numbers are little-endian:
+ *
+ *     header: "DXFS", LE16 version, LE16 width, LE16 height
+ *     frame:  LE32 number, u8 flags, [256 * (r, g, b) if flags & PaletteChanged], LE32 size, size bytes of pixel data
+ *
+ * The pixel data covers the frame row by row and is coded against the previous frame (all zeros before the first one)
+ * as a sequence of `varint skip` pixels that didn't change, followed by `varint length << 1 | isFill` and either a single
+ * pixel repeated `length` times or `length` literal pixels. The sequence ends once all pixels of the frame are covered.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include <SDL.h>
+
+namespace devilution {
+
+/**
+ * @brief Writes frames to a frame stream file.
+ */
+class FrameStreamWriter {
+public:
+	/**
+	 * @brief Writes the stream header.
+	 * @param out File to write to, must stay open while the writer is used
+	 */
+	FrameStreamWriter(FILE *out, int width, int height);
+
+	/**
+	 * @brief Appends a frame of `width * height` tightly packed pixels.
+	 * @param number Number of the frame, written as-is so that skipped frames are visible to readers
+	 * @return False if writing to the file failed
+	 */
+	bool WriteFrame(uint32_t number, const uint8_t *pixels, const std::array<SDL_Color, 256> &palette);
+
+	[[nodiscard]] bool ok() const
+	{
+		return ok_;
+	}
+
+private:
+	void EncodePixels(const uint8_t *pixels);
+
+	FILE *out_;
+	bool ok_;
+	std::vector<uint8_t> previous_;
+	std::vector<uint8_t> encoded_;
+	std::array<SDL_Color, 256> palette_ {};
+	bool hasPalette_ = false;
+};
+
+/**
+ * @brief Reads frames back from a frame stream file.
+ */
+class FrameStreamReader {
+public:
+	/** @brief Reads the stream header, check ok() to see whether the file is a frame stream. */
+	explicit FrameStreamReader(FILE *in);
+
+	/**
+	 * @brief Decodes the next frame.
+	 * @return False at the end of the stream or if the frame is corrupt
+	 */
+	bool ReadFrame();
+
+	[[nodiscard]] bool ok() const
+	{
+		return ok_;
+	}
+
+	[[nodiscard]] int width() const
+	{
+		return width_;
+	}
+
+	[[nodiscard]] int height() const
+	{
+		return height_;
+	}
+
+	/** @brief Number of the last frame read. */
+	[[nodiscard]] uint32_t number() const
+	{
+		return number_;
+	}
+
+	/** @brief Pixels of the last frame read, `width * height` tightly packed palette indices. */
+	[[nodiscard]] const uint8_t *pixels() const
+	{
+		return pixels_.data();
+	}
+
+	[[nodiscard]] const std::array<SDL_Color, 256> &palette() const
+	{
+		return palette_;
+	}
+
+private:
+	bool DecodePixels();
+
+	FILE *in_;
+	bool ok_ = false;
+	int width_ = 0;
+	int height_ = 0;
+	uint32_t number_ = 0;
+	std::vector<uint8_t> pixels_;
+	std::vector<uint8_t> encoded_;
+	std::array<SDL_Color, 256> palette_ {};
+};
+
+} // namespace devilution
@@ -1,9 +1,11 @@
 #include "utils/language.h"
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <initializer_list>
 #include <memory>
 #include <string_view>
-#include <unordered_map>
 #include <vector>
 
 #include <function_ref.hpp>
@@ -37,21 +39,18 @@ std::unique_ptr<char[]> translationValues;
 
 using TranslationRef = uint32_t;
 
-struct StringHash {
-	size_t operator()(const char *str) const noexcept
-	{
-		return std::hash<std::string_view> {}(str);
-	}
-};
-
-struct StringEq {
-	bool operator()(const char *lhs, const char *rhs) const noexcept
-	{
-		return std::string_view(lhs) == std::string_view(rhs);
-	}
+struct TranslationEntry {
+	/** @brief The source string, for plural entries only the singular form. */
+	std::string_view key;
+	/** @brief Index of the translation of the first plural form in `translationRefs`. */
+	uint32_t firstRef;
+	/** @brief Number of plural forms the entry has a translation for. */
+	uint32_t forms;
 };
 
-std::vector<std::unordered_map<const char *, TranslationRef, StringHash, StringEq>> translation = { {}, {} };
+/** @brief Entries sorted by key, looked up with a binary search so that keys are never hashed or measured. */
+std::vector<TranslationEntry> translationEntries;
+std::vector<TranslationRef> translationRefs;
 
 constexpr uint32_t TranslationRefOffsetBits = 19;
 constexpr uint32_t TranslationRefSizeBits = 32 - TranslationRefOffsetBits; // 13
@@ -67,6 +66,76 @@ std::string_view GetTranslation(TranslationRef ref)
 	return { &translationValues[ref >> TranslationRefSizeBits], ref & TranslationRefSizeMask };
 }
 
+/** @brief Compares like `entry.compare(key)` without running `strlen` on `key` first. */
+int CompareKey(std::string_view entry, const char *key)
+{
+	for (const char c : entry) {
+		if (*key == '\0' || c != *key)
+			return *key == '\0' || static_cast<unsigned char>(c) > static_cast<unsigned char>(*key) ? 1 : -1;
+		++key;
+	}
+	return *key == '\0' ? 0 : -1;
+}
+
+/** @brief Compares like `entry.compare(key)` where the key is the concatenation of `parts`. */
+int CompareKey(std::string_view entry, std::initializer_list<std::string_view> parts)
+{
+	for (const std::string_view part : parts) {
+		const size_t length = std::min(entry.size(), part.size());
+		const int result = entry.substr(0, length).compare(part.substr(0, length));
+		if (result != 0)
+			return result;
+		if (length < part.size())
+			return -1;
+		entry.remove_prefix(length);
+	}
+	return entry.empty() ? 0 : 1;
+}
+
+template <typename Key>
+const TranslationEntry *FindTranslation(const Key &key, unsigned form)
+{
+	const auto it = std::partition_point(translationEntries.begin(), translationEntries.end(),
+	    [&key](const TranslationEntry &entry) { return CompareKey(entry.key, key) < 0; });
+	if (it == translationEntries.end() || CompareKey(it->key, key) != 0 || form >= it->forms)
+		return nullptr;
+	return &*it;
+}
+
+/** @brief Changes every time the translations are reloaded, invalidating TranslationCache. */
+uint32_t TranslationGeneration = 1;
+
+struct CachedTranslation {
+	const void *address = nullptr;
+	uint32_t generation = 0;
+	const TranslationEntry *entry = nullptr;
+};
+
+/**
+ * @brief Entries that keys were last found at, by the address of the key.
+ *
+ * Most keys are string literals, so comparing the cached entry with the key is cheaper than searching for it again.
+ * The comparison also catches keys whose contents changed since. Each thread has its own cache.
+ */
+thread_local std::array<CachedTranslation, 256> TranslationCache;
+
+/**
+ * @param address Where the key is stored, used to find the cached entry
+ */
+template <typename Key>
+const TranslationEntry *FindCachedTranslation(const void *address, const Key &key)
+{
+	const auto bits = reinterpret_cast<uintptr_t>(address);
+	CachedTranslation &cached = TranslationCache[(bits ^ (bits >> 8)) % TranslationCache.size()];
+	if (cached.address == address && cached.generation == TranslationGeneration && CompareKey(cached.entry->key, key) == 0)
+		return cached.entry;
+
+	const TranslationEntry *entry = FindTranslation(key, 0);
+	if (entry != nullptr)
+		cached = { address, TranslationGeneration, entry };
+	return entry;
+}
+
 } // namespace
 
 namespace {
@@ -292,43 +361,38 @@ bool ReadEntry(const std::byte *data, size_t dataSize, const MoEntry &e, char *r
 
 std::string_view LanguageParticularTranslate(std::string_view context, std::string_view message)
 {
-	constexpr const char Glue = '\004';
+	constexpr std::string_view Glue = "\004";
 
-	std::string key = std::string(context);
-	key.reserve(key.size() + 1 + message.size());
-	key += Glue;
-	key.append(message);
-
-	auto it = translation[0].find(key.c_str());
-	if (it == translation[0].end()) {
+	const TranslationEntry *entry = FindCachedTranslation(message.data(), std::initializer_list<std::string_view> { context, Glue, message });
+	if (entry == nullptr) {
 		return message;
 	}
 
-	return GetTranslation(it->second);
+	return GetTranslation(translationRefs[entry->firstRef]);
 }
 
 std::string_view LanguagePluralTranslate(const char *singular, std::string_view plural, int count)
 {
-	int n = GetLocalPluralId(count);
+	const int n = GetLocalPluralId(count);
 
-	auto it = translation[n].find(singular);
-	if (it == translation[n].end()) {
+	const TranslationEntry *entry = FindTranslation(singular, static_cast<unsigned>(n));
+	if (entry == nullptr) {
 		if (count != 1)
 			return plural;
 		return singular;
 	}
 
-	return GetTranslation(it->second);
+	return GetTranslation(translationRefs[entry->firstRef + n]);
 }
 
 std::string_view LanguageTranslate(const char *key)
 {
-	auto it = translation[0].find(key);
-	if (it == translation[0].end()) {
+	const TranslationEntry *entry = FindCachedTranslation(key, key);
+	if (entry == nullptr) {
 		return key;
 	}
 
-	return GetTranslation(it->second);
+	return GetTranslation(translationRefs[entry->firstRef]);
 }
 
 bool HasTranslation(const std::string &locale)
@@ -359,7 +423,10 @@ bool IsSmallFontTall()
 
 void LanguageInitialize()
 {
-	translation = { {}, {} };
+	// Invalidates the cached entries, they point into the buffers freed below.
+	TranslationGeneration++;
+	translationEntries.clear();
+	translationRefs.clear();
 	translationKeys = nullptr;
 	translationValues = nullptr;
 
@@ -471,10 +538,6 @@ void LanguageInitialize()
 		ParseMetadata(&headerValue[0]);
 	}
 
-	translation.resize(PluralForms);
-	for (unsigned i = 0; i < PluralForms; i++)
-		translation[i] = {};
-
 	// Read strings described by entries
 	size_t keysSize = 0;
 	size_t valuesSize = 0;
@@ -484,6 +547,8 @@ void LanguageInitialize()
 	}
 	translationKeys = std::unique_ptr<char[]> { new char[keysSize] };
 	translationValues = std::unique_ptr<char[]> { new char[valuesSize] };
+	translationEntries.reserve(head.nbMappings - 1);
+	translationRefs.reserve(head.nbMappings - 1);
 
 	char *keyPtr = &translationKeys[0];
 	char *valuePtr = &translationValues[0];
@@ -494,9 +559,11 @@ void LanguageInitialize()
 			// Plural keys also have a plural form but it does not participate in lookup.
 			// Plural values are \0-terminated.
 			std::string_view value { valuePtr, dst[i].length + 1 };
+			TranslationEntry &entry = translationEntries.emplace_back(TranslationEntry { keyPtr, static_cast<uint32_t>(translationRefs.size()), 0 });
 			for (size_t j = 0; j < PluralForms && !value.empty(); j++) {
 				const size_t formValueEnd = value.find('\0');
-				translation[j].emplace(keyPtr, EncodeTranslationRef(static_cast<uint32_t>(value.data() - &translationValues[0]), static_cast<uint32_t>(formValueEnd)));
+				translationRefs.push_back(EncodeTranslationRef(static_cast<uint32_t>(value.data() - &translationValues[0]), static_cast<uint32_t>(formValueEnd)));
+				entry.forms++;
 				value.remove_prefix(formValueEnd + 1);
 			}
 
@@ -505,5 +572,9 @@ void LanguageInitialize()
 		}
 	}
 
+	// Stable so that the first of several entries with the same key wins, like it did when they were kept in a map.
+	std::stable_sort(translationEntries.begin(), translationEntries.end(),
+	    [](const TranslationEntry &a, const TranslationEntry &b) { return a.key < b.key; });
+
 	LogVerbose(StrCat("Loaded translations from ", translationsPath, " in ", SDL_GetTicks() - loadTranslationsStart, "ms"));
 }
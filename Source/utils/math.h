@@ -5,6 +5,8 @@
  */
 #pragma once
 
+#include <cstdint>
+
 namespace devilution {
 namespace math {
 
@@ -69,5 +71,28 @@ T Remap(T inMin, T inMax, T outMin, T outMax, T v)
 	return Lerp(outMin, outMax, t);
 }
 
+/**
+ * @brief Computes the integer square root without going through floating point
+ * @param v Value to take the root of
+ * @return The largest integer r so that r * r <= v
+ */
+constexpr uint64_t IntegerSqrt(uint64_t v)
+{
+	uint64_t result = 0;
+	uint64_t bit = uint64_t { 1 } << 62;
+	while (bit > v)
+		bit >>= 2;
+	while (bit != 0) {
+		if (v >= result + bit) {
+			v -= result + bit;
+			result = (result >> 1) + bit;
+		} else {
+			result >>= 1;
+		}
+		bit >>= 2;
+	}
+	return result;
+}
+
 } // namespace math
 } // namespace devilution
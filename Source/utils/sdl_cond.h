@@ -0,0 +1,62 @@
+#pragma once
+
+#include <mutex>
+
+#include <SDL_mutex.h>
+
+#include "appfat.h"
+#include "utils/sdl_mutex.h"
+
+namespace devilution {
+
+/*
+ * RAII wrapper for SDL_cond. Mirrors the parts of std::condition_variable
+ * that we need, but waits on an SdlMutex.
+ */
+class SdlCond final {
+public:
+	SdlCond()
+	    : cond_(SDL_CreateCond())
+	{
+		if (cond_ == nullptr)
+			ErrSdl();
+	}
+
+	~SdlCond()
+	{
+		SDL_DestroyCond(cond_);
+	}
+
+	SdlCond(const SdlCond &) = delete;
+	SdlCond(SdlCond &&) = delete;
+	SdlCond &operator=(const SdlCond &) = delete;
+	SdlCond &operator=(SdlCond &&) = delete;
+
+	void wait(std::unique_lock<SdlMutex> &lock) // NOLINT(readability-identifier-naming)
+	{
+		if (SDL_CondWait(cond_, lock.mutex()->get()) == -1)
+			ErrSdl();
+	}
+
+	template <typename Predicate>
+	void wait(std::unique_lock<SdlMutex> &lock, Predicate pred) // NOLINT(readability-identifier-naming)
+	{
+		while (!pred())
+			wait(lock);
+	}
+
+	void notify_one() noexcept // NOLINT(readability-identifier-naming)
+	{
+		SDL_CondSignal(cond_);
+	}
+
+	void notify_all() noexcept // NOLINT(readability-identifier-naming)
+	{
+		SDL_CondBroadcast(cond_);
+	}
+
+private:
+	SDL_cond *cond_;
+};
+
+} // namespace devilution
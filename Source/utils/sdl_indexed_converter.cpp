@@ -0,0 +1,103 @@
+#include "utils/sdl_indexed_converter.hpp"
+
+#include <cstring>
+
+#include "utils/sdl_wrap.h"
+
+namespace devilution {
+
+namespace {
+
+bool IsSameFormat(const SDL_PixelFormat &a, const SDL_PixelFormat &b)
+{
+	return a.BitsPerPixel == b.BitsPerPixel
+	    && a.Rmask == b.Rmask
+	    && a.Gmask == b.Gmask
+	    && a.Bmask == b.Bmask
+	    && a.Amask == b.Amask;
+}
+
+template <typename T>
+void ConvertRows(const SDL_Surface &src, SDL_Surface &dst, const std::array<uint32_t, 256> &lookup)
+{
+	const auto *srcRow = static_cast<const uint8_t *>(src.pixels);
+	auto *dstRow = static_cast<uint8_t *>(dst.pixels);
+	for (int y = 0; y < src.h; ++y, srcRow += src.pitch, dstRow += dst.pitch) {
+		auto *dstPixels = reinterpret_cast<T *>(dstRow);
+		for (int x = 0; x < src.w; ++x) {
+			dstPixels[x] = static_cast<T>(lookup[srcRow[x]]);
+		}
+	}
+}
+
+void ConvertRows24(const SDL_Surface &src, SDL_Surface &dst, const std::array<uint32_t, 256> &lookup)
+{
+	const auto *srcRow = static_cast<const uint8_t *>(src.pixels);
+	auto *dstRow = static_cast<uint8_t *>(dst.pixels);
+	for (int y = 0; y < src.h; ++y, srcRow += src.pitch, dstRow += dst.pitch) {
+		uint8_t *dstPixel = dstRow;
+		for (int x = 0; x < src.w; ++x, dstPixel += 3) {
+			const uint32_t color = lookup[srcRow[x]];
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+			dstPixel[0] = static_cast<uint8_t>(color);
+			dstPixel[1] = static_cast<uint8_t>(color >> 8);
+			dstPixel[2] = static_cast<uint8_t>(color >> 16);
+#else
+			dstPixel[0] = static_cast<uint8_t>(color >> 16);
+			dstPixel[1] = static_cast<uint8_t>(color >> 8);
+			dstPixel[2] = static_cast<uint8_t>(color);
+#endif
+		}
+	}
+}
+
+} // namespace
+
+SDL_Surface *IndexedSurfaceConverter::Convert(const SDL_Surface *src, const SDL_PixelFormat *format)
+{
+	if (target_ == nullptr || target_->w != src->w || target_->h != src->h || !IsSameFormat(*target_->format, *format)) {
+		target_ = SDLWrap::CreateRGBSurface(SDL_SWSURFACE, src->w, src->h, format->BitsPerPixel,
+		    format->Rmask, format->Gmask, format->Bmask, format->Amask);
+		surfaceAllocations_++;
+		lookupValid_ = false;
+	}
+
+	const SDL_Palette &palette = *src->format->palette;
+	if (!lookupValid_ || std::memcmp(lookupColors_.data(), palette.colors, palette.ncolors * sizeof(SDL_Color)) != 0) {
+		UpdateColorLookup(palette);
+	}
+
+	switch (target_->format->BytesPerPixel) {
+	case 2:
+		ConvertRows<uint16_t>(*src, *target_, lookup_);
+		break;
+	case 3:
+		ConvertRows24(*src, *target_, lookup_);
+		break;
+	default:
+		ConvertRows<uint32_t>(*src, *target_, lookup_);
+		break;
+	}
+
+	return target_.get();
+}
+
+void IndexedSurfaceConverter::Reset()
+{
+	target_ = nullptr;
+	lookupValid_ = false;
+}
+
+void IndexedSurfaceConverter::UpdateColorLookup(const SDL_Palette &palette)
+{
+	lookupColors_ = {};
+	lookup_ = {};
+	std::memcpy(lookupColors_.data(), palette.colors, palette.ncolors * sizeof(SDL_Color));
+	for (int i = 0; i < palette.ncolors; ++i) {
+		const SDL_Color &color = palette.colors[i];
+		lookup_[i] = SDL_MapRGB(target_->format, color.r, color.g, color.b);
+	}
+	lookupValid_ = true;
+}
+
+} // namespace devilution
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <SDL_version.h>
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+#include <SDL_surface.h>
+#else
+#include <SDL_video.h>
+#endif
+
+#include "utils/sdl_ptrs.h"
+
+namespace devilution {
+
+/**
+ * @brief Converts 8-bit palettized surfaces into a persistent surface of another format.
+ *
+ * Unlike `SDL_ConvertSurface`, the target surface is kept between calls and is only
+ * re-created when the source size or the requested format changes.
+ */
+class IndexedSurfaceConverter {
+public:
+	/**
+	 * @brief Converts `src` (INDEX8) to `format` (16, 24 or 32 bits per pixel).
+	 * @return The converted surface, owned by the converter.
+	 */
+	SDL_Surface *Convert(const SDL_Surface *src, const SDL_PixelFormat *format);
+
+	/** @brief Releases the target surface. */
+	void Reset();
+
+	/** @brief The number of times the target surface has been (re-)created. */
+	size_t SurfaceAllocations() const
+	{
+		return surfaceAllocations_;
+	}
+
+private:
+	void UpdateColorLookup(const SDL_Palette &palette);
+
+	SDLSurfaceUniquePtr target_;
+	size_t surfaceAllocations_ = 0;
+	bool lookupValid_ = false;
+	std::array<SDL_Color, 256> lookupColors_;
+	std::array<uint32_t, 256> lookup_;
+};
+
+} // namespace devilution
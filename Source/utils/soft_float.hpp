@@ -0,0 +1,195 @@
+/**
+ * @file soft_float.hpp
+ *
+ * Integer emulation of the floating point arithmetic the simulation was written with.
+ *
+ * Results are bit-identical to IEEE 754 with round-to-nearest-even, but unlike the FPU they don't depend on
+ * the compiler's choice of x87 or SSE, excess precision, FMA contraction or fast-math flags, so demos, saves and
+ * multiplayer peers stay in sync no matter how the game was built.
+ */
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <tuple>
+#include <utility>
+
+#include "utils/math.h"
+
+namespace devilution {
+
+namespace detail {
+
+/**
+ * @brief Rounds `numerator / denominator` to a `Bits` bit mantissa, ties to even.
+ *
+ * The scaled numerator or denominator has to fit in 64 bits.
+ * @return Mantissa in [2^(Bits - 1), 2^Bits) and the exponent of the rounded value `mantissa * 2^exponent`
+ */
+template <int Bits>
+constexpr std::pair<uint64_t, int> RoundQuotient(uint64_t numerator, uint64_t denominator)
+{
+	constexpr uint64_t MantissaBegin = uint64_t { 1 } << (Bits - 1);
+	constexpr uint64_t MantissaEnd = uint64_t { 1 } << Bits;
+	// Scale the quotient into (2^(Bits - 1), 2^(Bits + 1)), then drop one more bit if it's still too large
+	int shift = Bits - static_cast<int>(std::bit_width(numerator)) + static_cast<int>(std::bit_width(denominator));
+	const auto scale = [&]() {
+		if (shift >= 0)
+			return std::pair<uint64_t, uint64_t> { numerator << shift, denominator };
+		return std::pair<uint64_t, uint64_t> { numerator, denominator << -shift };
+	};
+	auto [num, den] = scale();
+	if (num / den >= MantissaEnd) {
+		shift--;
+		std::tie(num, den) = scale();
+	}
+	uint64_t quotient = num / den;
+	const uint64_t remainder = num - quotient * den;
+	if (remainder * 2 > den || (remainder * 2 == den && (quotient & 1) != 0))
+		quotient++;
+	if (quotient == MantissaEnd) {
+		quotient = MantissaBegin;
+		shift--;
+	}
+	return { quotient, -shift };
+}
+
+} // namespace detail
+
+/**
+ * @brief Non-negative single precision value stored as `mantissa * 2^exponent`.
+ *
+ * Only normal numbers are supported, the simulation never gets close to the subnormal or overflow range of a float.
+ */
+class SoftFloat {
+public:
+	constexpr SoftFloat() = default;
+
+	/** @brief Same rounding as `static_cast<float>(value)`. */
+	static constexpr SoftFloat FromInt(uint32_t value)
+	{
+		return Round(value, 1, 0);
+	}
+
+	[[nodiscard]] constexpr bool isZero() const
+	{
+		return mantissa_ == 0;
+	}
+
+	constexpr SoftFloat operator*(SoftFloat other) const
+	{
+		return Round(static_cast<uint64_t>(mantissa_) * other.mantissa_, 1, exponent_ + other.exponent_);
+	}
+
+	/** @brief Divides by a non-zero value. */
+	constexpr SoftFloat operator/(SoftFloat other) const
+	{
+		return Round(mantissa_, other.mantissa_, exponent_ - other.exponent_);
+	}
+
+	/** @brief Same result as `sqrtf()`. */
+	[[nodiscard]] constexpr SoftFloat squareRoot() const
+	{
+		if (isZero())
+			return {};
+		uint64_t value = mantissa_;
+		int exponent = exponent_;
+		if ((exponent & 1) != 0) {
+			value <<= 1;
+			exponent--;
+		}
+		// Bring the value into [2^46, 2^48) so its root fills exactly 24 bits
+		const int shift = value < (1U << 24) ? 24 : 22;
+		value <<= shift;
+		uint64_t root = math::IntegerSqrt(value);
+		// A square root is never exactly halfway between two integers, so this rounds to nearest
+		if (value - root * root > root)
+			root++;
+		SoftFloat result { static_cast<uint32_t>(root), (exponent - shift) / 2 };
+		if (result.mantissa_ == MantissaEnd) {
+			result.mantissa_ >>= 1;
+			result.exponent_++;
+		}
+		return result;
+	}
+
+	/** @brief Same as `static_cast<uint32_t>()` of the float, the value has to fit. */
+	[[nodiscard]] constexpr uint32_t truncate() const
+	{
+		if (exponent_ >= 0)
+			return mantissa_ << exponent_;
+		if (exponent_ <= -32)
+			return 0;
+		return mantissa_ >> -exponent_;
+	}
+
+private:
+	static constexpr uint32_t MantissaBegin = 1U << 23;
+	static constexpr uint32_t MantissaEnd = 1U << 24;
+
+	constexpr SoftFloat(uint32_t mantissa, int exponent)
+	    : mantissa_(mantissa)
+	    , exponent_(exponent)
+	{
+	}
+
+	/**
+	 * @brief Rounds `numerator / denominator * 2^exponent` to the nearest float, ties to even.
+	 *
+	 * The scaled numerator has to fit in 64 bits, which holds for the integers, products and quotients of mantissas used here.
+	 */
+	static constexpr SoftFloat Round(uint64_t numerator, uint64_t denominator, int exponent)
+	{
+		if (numerator == 0)
+			return {};
+		const auto [mantissa, shift] = detail::RoundQuotient<24>(numerator, denominator);
+		return { static_cast<uint32_t>(mantissa), exponent + shift };
+	}
+
+	uint32_t mantissa_ = 0;
+	int exponent_ = 0;
+};
+
+/**
+ * @brief Same result as `std::max<int64_t>(static_cast<int64_t>(value * (1 + tenths / 10.0)), 0)` in double precision.
+ *
+ * The error of the double is far below 1/10 in this range, so the result is the exact `value * (10 + tenths) / 10`
+ * rounded down. Only when that is an integer can the double come out just below it, if the factor was rounded down.
+ * @param tenths At most 600000
+ */
+constexpr int64_t MultiplyByTenthsLikeDouble(uint32_t value, int tenths)
+{
+	if (tenths <= -10)
+		return 0;
+	const int64_t scaled = static_cast<int64_t>(value) * (10 + tenths);
+	const int64_t exact = scaled / 10;
+	if (tenths == 0 || scaled % 10 != 0 || exact == 0)
+		return exact;
+
+	// The factor as `factorMantissa * 2^factorExponent`, from `tenths / 10.0` and then `1 + ...` each rounded to 53 bits
+	const auto [quotient, quotientExponent] = detail::RoundQuotient<53>(static_cast<uint64_t>(std::abs(tenths)), 10);
+	const uint64_t one = uint64_t { 1 } << -quotientExponent;
+	const auto [factorMantissa, sumExponent] = detail::RoundQuotient<53>(tenths > 0 ? one + quotient : one - quotient, 1);
+	const int factorExponent = quotientExponent + sumExponent;
+
+	// How far the factor was rounded down, in units of 2^factorExponent / 10
+	const int64_t roundedDown = static_cast<int64_t>((static_cast<uint64_t>(10 + tenths) << -factorExponent) - 10 * factorMantissa);
+	if (roundedDown <= 0)
+		return exact;
+
+	// The product falls short of `exact` by `value * roundedDown * 2^factorExponent / 10`. It still rounds to `exact` unless
+	// that is more than half the distance to the double below, ties go to `exact` because its mantissa is even.
+	const int exactBits = static_cast<int>(std::bit_width(static_cast<uint64_t>(exact)));
+	const int halfGapExponent = exactBits - 1 - 53 - (std::has_single_bit(static_cast<uint64_t>(exact)) ? 1 : 0);
+	const int shift = halfGapExponent - factorExponent;
+	uint64_t shortfall = static_cast<uint64_t>(value) * static_cast<uint64_t>(roundedDown);
+	uint64_t halfGap = 10;
+	if (shift >= 0)
+		halfGap <<= shift;
+	else
+		shortfall <<= -shift;
+	return shortfall > halfGap ? exact - 1 : exact;
+}
+
+} // namespace devilution
@@ -0,0 +1,128 @@
+#include "utils/surface_to_pcx.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "utils/pcx.hpp"
+
+namespace devilution {
+namespace {
+
+/**
+ * @brief Write the PCX-file header
+ * @param width Image width
+ * @param height Image height
+ * @param out File stream to write to
+ * @return True on success
+ */
+bool WritePcxHeader(int16_t width, int16_t height, FILE *out)
+{
+	PCXHeader buffer;
+
+	memset(&buffer, 0, sizeof(buffer));
+	buffer.Manufacturer = 10;
+	buffer.Version = 5;
+	buffer.Encoding = 1;
+	buffer.BitsPerPixel = 8;
+	buffer.Xmax = SDL_SwapLE16(width - 1);
+	buffer.Ymax = SDL_SwapLE16(height - 1);
+	buffer.HDpi = SDL_SwapLE16(width);
+	buffer.VDpi = SDL_SwapLE16(height);
+	buffer.NPlanes = 1;
+	buffer.BytesPerLine = SDL_SwapLE16(width);
+
+	return std::fwrite(&buffer, sizeof(buffer), 1, out) == 1;
+}
+
+/**
+ * @brief Write the palette to the PCX file
+ * @param palette Palette to write
+ * @param out File stream for the PCX file.
+ * @return True if successful, else false
+ */
+bool WritePcxPalette(const SDL_Color *palette, FILE *out)
+{
+	uint8_t pcxPalette[1 + 256 * 3];
+
+	pcxPalette[0] = 12;
+	for (int i = 0; i < 256; i++) {
+		pcxPalette[1 + 3 * i + 0] = palette[i].r;
+		pcxPalette[1 + 3 * i + 1] = palette[i].g;
+		pcxPalette[1 + 3 * i + 2] = palette[i].b;
+	}
+
+	return std::fwrite(pcxPalette, sizeof(pcxPalette), 1, out) == 1;
+}
+
+/**
+ * @brief RLE compress the pixel data
+ * @param src Raw pixel buffer
+ * @param dst Output buffer
+ * @param width Width of pixel buffer
+
+ * @return Output buffer
+ */
+uint8_t *EncodePcxLine(const uint8_t *src, uint8_t *dst, int width)
+{
+	int rleLength;
+
+	do {
+		uint8_t rlePixel = *src;
+		src++;
+		rleLength = 1;
+
+		width--;
+
+		while (width != 0 && rlePixel == *src) {
+			if (rleLength >= 63)
+				break;
+			rleLength++;
+
+			width--;
+			src++;
+		}
+
+		if (rleLength > 1 || rlePixel > 0xBF) {
+			*dst = rleLength | 0xC0;
+			dst++;
+		}
+
+		*dst = rlePixel;
+		dst++;
+	} while (width > 0);
+
+	return dst;
+}
+
+/**
+ * @brief Write the pixel data to the PCX file
+ *
+ * @param buf Pixel data
+ * @param out File stream for the PCX file.
+ * @return True if successful, else false
+ */
+bool WritePcxPixels(const Surface &buf, FILE *out)
+{
+	int width = buf.w();
+	std::unique_ptr<uint8_t[]> pBuffer { new uint8_t[2 * width] };
+	const uint8_t *pixels = buf.begin();
+	for (int height = buf.h(); height > 0; height--) {
+		const uint8_t *pBufferEnd = EncodePcxLine(pixels, pBuffer.get(), width);
+		pixels += buf.pitch();
+		if (std::fwrite(pBuffer.get(), pBufferEnd - pBuffer.get(), 1, out) != 1)
+			return false;
+	}
+	return true;
+}
+
+} // namespace
+
+bool SurfaceToPcx(const Surface &surface, const SDL_Color *palette, FILE *out)
+{
+	return WritePcxHeader(surface.w(), surface.h(), out)
+	    && WritePcxPixels(surface, out)
+	    && WritePcxPalette(palette, out);
+}
+
+} // namespace devilution
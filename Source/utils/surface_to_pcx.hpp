@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdio>
+
+#include <SDL.h>
+
+#include "engine/surface.hpp"
+
+namespace devilution {
+
+/**
+ * @brief Writes an 8-bit surface to a file as an RLE compressed PCX image.
+ *
+ * @param surface The source surface.
+ * @param palette The 256 colors the surface's palette indices refer to.
+ * @param out File stream to write to.
+ * @return True on success
+ */
+bool SurfaceToPcx(const Surface &surface, const SDL_Color *palette, FILE *out);
+
+} // namespace devilution
@@ -1,5 +1,17 @@
-local function CreateEvent()
+local function CreateEvent(name)
   local functions = {}
+
+  ---Triggers an event.
+  ---
+  ---The arguments are forwarded to handlers.
+  ---Each handler runs with its own instruction budget and is disabled if it exceeds it.
+  ---@param ... any
+  local function trigger(...)
+    for _, func in ipairs(functions) do
+      callEventHandler(func, ...)
+    end
+  end
+
   return {
     ---Adds an event handler.
     ---
@@ -7,6 +19,7 @@ local function CreateEvent()
     ---@param func function
     add = function(func)
       table.insert(functions, func)
+      eventHandlersChanged(name, #functions, trigger)
     end,
 
     ---Removes the event handler.
@@ -15,48 +28,67 @@ local function CreateEvent()
       for i, f in ipairs(functions) do
         if f == func then
           table.remove(functions, i)
+          eventHandlersChanged(name, #functions, trigger)
           break
         end
       end
     end,
 
-    ---Triggers an event.
-    ---
-    ---The arguments are forwarded to handlers.
-    ---@param ... any
-    trigger = function(...)
-      if arg ~= nil then
-        for _, func in ipairs(functions) do
-          func(table.unpack(arg))
-        end
-      else
-        for _, func in ipairs(functions) do
-          func()
+    ---Removes all event handlers for which `predicate` returns true.
+    ---Used when a script is unloaded.
+    ---@param predicate fun(func: function): boolean
+    __removeIf = function(predicate)
+      local removed = false
+      for i = #functions, 1, -1 do
+        if predicate(functions[i]) then
+          table.remove(functions, i)
+          removed = true
         end
       end
+      if removed then
+        eventHandlersChanged(name, #functions, trigger)
+      end
     end,
+
+    trigger = trigger,
     __sig_trigger = "(...)",
   }
 end
 
 local events = {
   ---Called early on game boot.
-  GameBoot = CreateEvent(),
+  GameBoot = CreateEvent("GameBoot"),
   __doc_GameBoot = "Called early on game boot.",
 
   ---Called every time a new game is started.
-  GameStart = CreateEvent(),
+  GameStart = CreateEvent("GameStart"),
   __doc_GameStart = "Called every time a new game is started.",
 
   ---Called every frame at the end.
-  GameDrawComplete = CreateEvent(),
+  GameDrawComplete = CreateEvent("GameDrawComplete"),
   __doc_GameDrawComplete = "Called every frame at the end.",
+
+  ---Called when a monster is killed, with the monster and the player credited with the kill.
+  MonsterKilled = CreateEvent("MonsterKilled"),
+  __doc_MonsterKilled = "Called when a monster is killed, with the monster and the player credited with the kill.",
+
+  ---Called when an item is generated on the ground, with the item.
+  ItemSpawned = CreateEvent("ItemSpawned"),
+  __doc_ItemSpawned = "Called when an item is generated on the ground, with the item.",
+
+  ---Called when a player reaches a new character level, with the player.
+  PlayerLevelUp = CreateEvent("PlayerLevelUp"),
+  __doc_PlayerLevelUp = "Called when a player reaches a new character level, with the player.",
+
+  ---Called when a missile or spell effect is created, with a copy of the missile.
+  MissileAdded = CreateEvent("MissileAdded"),
+  __doc_MissileAdded = "Called when a missile or spell effect is created, with a copy of the missile.",
 }
 
 ---Registers a custom event type with the given name.
 ---@param name string
 function events.registerCustom(name)
-  events[name] = CreateEvent()
+  events[name] = CreateEvent(name)
 end
 
 events.__sig_registerCustom = "(name: string)"
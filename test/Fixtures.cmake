@@ -84,6 +84,7 @@ set(devilutionx_fixtures
   timedemo/WarriorLevel1to2/demo_0.dmo
   timedemo/WarriorLevel1to2/demo_0_reference_spawn_0.sv
   timedemo/WarriorLevel1to2/spawn_0.sv
+  translations/test.mo
   txtdata/cr.tsv
   txtdata/crlf.tsv
   txtdata/empty.tsv
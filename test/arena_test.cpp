@@ -0,0 +1,132 @@
+#include <cstdint>
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#include "levels/gendung.h"
+#include "utils/arena.hpp"
+
+#if defined(__SANITIZE_ADDRESS__)
+#define ARENA_TEST_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define ARENA_TEST_ASAN
+#endif
+#endif
+
+#ifdef ARENA_TEST_ASAN
+#include <sanitizer/asan_interface.h>
+#include <sanitizer/lsan_interface.h>
+#endif
+
+namespace devilution {
+namespace {
+
+TEST(ArenaTest, AllocationsAreAlignedAndDisjoint)
+{
+	Arena arena(256);
+	auto *bytes = arena.allocate<uint8_t>(3);
+	auto *words = arena.allocate<uint64_t>(4);
+	auto *more = arena.allocate<uint16_t>(5);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(words) % alignof(uint64_t), 0U);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(more) % alignof(uint16_t), 0U);
+	EXPECT_GE(reinterpret_cast<uintptr_t>(words), reinterpret_cast<uintptr_t>(bytes + 3));
+	EXPECT_GE(reinterpret_cast<uintptr_t>(more), reinterpret_cast<uintptr_t>(words + 4));
+
+	const ArenaStats stats = arena.stats();
+	EXPECT_EQ(stats.numAllocations, 3U);
+	EXPECT_EQ(stats.numChunks, 1U);
+	EXPECT_EQ(stats.reservedBytes, 256U);
+	EXPECT_EQ(stats.usedBytes, stats.wastedBytes + 3 + 4 * sizeof(uint64_t) + 5 * sizeof(uint16_t));
+}
+
+TEST(ArenaTest, LargeAllocationGetsItsOwnChunk)
+{
+	Arena arena(64);
+	auto *small = arena.allocate<uint8_t>(60);
+	auto *large = arena.allocate<uint8_t>(1000);
+	std::memset(small, 1, 60);
+	std::memset(large, 2, 1000);
+
+	const ArenaStats stats = arena.stats();
+	EXPECT_EQ(stats.numChunks, 2U);
+	EXPECT_GE(stats.reservedBytes, 1064U);
+	EXPECT_EQ(stats.wastedBytes, 4U);
+}
+
+TEST(ArenaTest, ResetMergesChunks)
+{
+	Arena arena(64);
+	for (int level = 0; level < 3; level++) {
+		for (int i = 0; i < 10; i++)
+			std::memset(arena.allocate<uint8_t>(40), level, 40);
+		const ArenaStats stats = arena.stats();
+		EXPECT_EQ(stats.usedBytes, level == 0 ? 400U : stats.peakUsedBytes) << level;
+		EXPECT_EQ(stats.numChunks, level == 0 ? 10U : 1U) << level;
+		arena.reset();
+	}
+
+	const ArenaStats stats = arena.stats();
+	EXPECT_EQ(stats.usedBytes, 0U);
+	EXPECT_EQ(stats.numAllocations, 0U);
+	EXPECT_EQ(stats.numChunks, 1U);
+	EXPECT_GE(stats.peakUsedBytes, 400U);
+}
+
+TEST(ArenaTest, ReleaseReturnsAllMemory)
+{
+	Arena arena(64);
+	std::memset(arena.allocate<uint8_t>(100), 0, 100);
+	arena.release();
+
+	const ArenaStats stats = arena.stats();
+	EXPECT_EQ(stats.reservedBytes, 0U);
+	EXPECT_EQ(stats.numChunks, 0U);
+}
+
+#ifdef ARENA_TEST_ASAN
+TEST(ArenaDeathTest, ResetMemoryIsPoisoned)
+{
+	Arena arena(64);
+	volatile uint8_t *data = arena.allocate<uint8_t>(16);
+	data[0] = 1;
+	arena.reset();
+	EXPECT_DEATH(data[0] = 2, "use-after-poison");
+}
+
+TEST(ArenaTest, LevelArenaPoisonsPreviousLevel)
+{
+	auto *tiles = LevelArena.allocate<MegaTile>(100);
+	auto *cels = LevelArena.allocate<std::byte>(Arena::DefaultChunkSize * 2);
+	EXPECT_FALSE(__asan_region_is_poisoned(tiles, sizeof(MegaTile) * 100));
+	EXPECT_FALSE(__asan_region_is_poisoned(cels, Arena::DefaultChunkSize * 2));
+
+	LevelArena.reset();
+	EXPECT_TRUE(__asan_address_is_poisoned(tiles));
+	EXPECT_EQ(LevelArena.stats().numChunks, 1U);
+
+	auto *nextLevel = LevelArena.allocate<std::byte>(16);
+	EXPECT_FALSE(__asan_region_is_poisoned(nextLevel, 16));
+	EXPECT_TRUE(__asan_address_is_poisoned(nextLevel + 16));
+	LevelArena.release();
+}
+
+TEST(ArenaTest, LevelChangesDoNotLeak)
+{
+	for (int level = 0; level < 16; level++) {
+		for (int i = 0; i < 20; i++)
+			std::memset(LevelArena.allocate<std::byte>(100000 * (level % 4 + 1)), level, 100000);
+		LevelArena.reset();
+	}
+	LevelArena.release();
+	{
+		Arena arena(64);
+		for (int i = 0; i < 100; i++)
+			std::memset(arena.allocate<uint8_t>(50), i, 50);
+	}
+	EXPECT_EQ(__lsan_do_recoverable_leak_check(), 0);
+}
+#endif
+
+} // namespace
+} // namespace devilution
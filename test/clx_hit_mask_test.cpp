@@ -0,0 +1,132 @@
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "engine/render/clx_hit_mask.hpp"
+#include "engine/render/clx_render.hpp"
+
+using namespace devilution;
+
+namespace {
+
+void AppendLE16(std::vector<uint8_t> &out, uint16_t value)
+{
+	out.push_back(static_cast<uint8_t>(value & 0xFF));
+	out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+/**
+ * @brief Generates a random CLX frame, including runs that cross row boundaries and shadow pixels.
+ */
+std::vector<uint8_t> RandomClxFrame(std::mt19937 &rng, uint16_t width, uint16_t height)
+{
+	std::vector<uint8_t> data;
+	AppendLE16(data, 10);
+	AppendLE16(data, width);
+	AppendLE16(data, height);
+	data.resize(10);
+
+	std::uniform_int_distribution<int> kind(0, 2);
+	std::uniform_int_distribution<int> color(0, 3);
+	const int total = width * height;
+	int covered = 0;
+	while (covered < total) {
+		switch (kind(rng)) {
+		case 0: {
+			const int length = std::uniform_int_distribution<int>(1, 0x7F)(rng);
+			data.push_back(static_cast<uint8_t>(length));
+			covered += length;
+		} break;
+		case 1: {
+			const int length = std::uniform_int_distribution<int>(1, 63)(rng);
+			data.push_back(static_cast<uint8_t>(0xBF - length));
+			data.push_back(static_cast<uint8_t>(color(rng)));
+			covered += length;
+		} break;
+		default: {
+			const int length = std::uniform_int_distribution<int>(1, 65)(rng);
+			data.push_back(static_cast<uint8_t>(0x100 - length));
+			for (int i = 0; i < length; i++)
+				data.push_back(static_cast<uint8_t>(color(rng)));
+			covered += length;
+		} break;
+		}
+	}
+	return data;
+}
+
+void ExpectMaskMatchesClx(const std::vector<uint8_t> &data)
+{
+	const ClxSprite sprite { data.data(), static_cast<uint32_t>(data.size()) };
+	const ClxHitMask mask { sprite };
+	for (int y = 0; y < sprite.height(); y++) {
+		for (int x = 0; x < sprite.width(); x++) {
+			ASSERT_EQ(mask.contains({ x, y }), IsPointWithinClx({ x, y }, sprite)) << "x=" << x << " y=" << y;
+		}
+	}
+}
+
+} // namespace
+
+TEST(ClxHitMask, SimpleSprite)
+{
+	// 4x2 sprite, bottom row first:
+	// bottom: 2 transparent, 1 opaque, 1 shadow
+	// top: fill of 3 opaque, 1 transparent
+	const std::vector<uint8_t> data {
+		10, 0, 4, 0, 2, 0, 0, 0, 0, 0,
+		0x02, 0xFE, 0x05, 0x00,
+		0xBC, 0x07, 0x01
+	};
+	const ClxSprite sprite { data.data(), static_cast<uint32_t>(data.size()) };
+	const ClxHitMask mask { sprite };
+	EXPECT_TRUE(mask.contains({ 0, 0 }));
+	EXPECT_TRUE(mask.contains({ 2, 0 }));
+	EXPECT_FALSE(mask.contains({ 3, 0 }));
+	EXPECT_FALSE(mask.contains({ 1, 1 }));
+	EXPECT_TRUE(mask.contains({ 2, 1 }));
+	EXPECT_FALSE(mask.contains({ 3, 1 }));
+	EXPECT_FALSE(mask.contains({ 4, 0 }));
+	EXPECT_FALSE(mask.contains({ 0, 2 }));
+	ExpectMaskMatchesClx(data);
+}
+
+TEST(ClxHitMask, MatchesIsPointWithinClxForRandomSprites)
+{
+	std::mt19937 rng(12345);
+	const uint16_t sizes[][2] = { { 1, 1 }, { 31, 7 }, { 32, 32 }, { 33, 5 }, { 96, 128 }, { 128, 96 }, { 160, 160 } };
+	for (const auto &size : sizes) {
+		for (int i = 0; i < 20; i++) {
+			ExpectMaskMatchesClx(RandomClxFrame(rng, size[0], size[1]));
+		}
+	}
+}
+
+TEST(ClxHitMask, CachedLookupMatchesIsPointWithinClx)
+{
+	std::mt19937 rng(42);
+	std::vector<uint8_t> first = RandomClxFrame(rng, 64, 64);
+	std::vector<uint8_t> second = RandomClxFrame(rng, 64, 64);
+	const ClxSprite firstSprite { first.data(), static_cast<uint32_t>(first.size()) };
+	const ClxSprite secondSprite { second.data(), static_cast<uint32_t>(second.size()) };
+
+	ClearClxHitMaskCache();
+	for (int y = 0; y < 64; y++) {
+		for (int x = 0; x < 64; x++) {
+			ASSERT_EQ(IsPointWithinClxCached({ x, y }, firstSprite), IsPointWithinClx({ x, y }, firstSprite));
+			ASSERT_EQ(IsPointWithinClxCached({ x, y }, secondSprite), IsPointWithinClx({ x, y }, secondSprite));
+		}
+	}
+
+	// Reusing the same memory for different sprite data requires the cache to be cleared.
+	first = RandomClxFrame(rng, 64, 64);
+	ClearClxHitMaskCache();
+	const ClxSprite reusedSprite { first.data(), static_cast<uint32_t>(first.size()) };
+	for (int y = 0; y < 64; y++) {
+		for (int x = 0; x < 64; x++) {
+			ASSERT_EQ(IsPointWithinClxCached({ x, y }, reusedSprite), IsPointWithinClx({ x, y }, reusedSprite));
+		}
+	}
+	ClearClxHitMaskCache();
+}
@@ -0,0 +1,162 @@
+#include <cstdio>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "engine/demo_file.hpp"
+#include "utils/endian_stream.hpp"
+
+using namespace devilution;
+
+namespace {
+
+/** @brief Writes `numTicks` ticks of a few messages each, starting a new block every `ticksPerBlock` ticks. */
+void WriteTestDemo(FILE *file, uint32_t numTicks, uint32_t ticksPerBlock)
+{
+	DemoBlockWriter writer(file);
+	writer.StartBlock(0, 0x1234);
+	for (uint32_t tick = 0; tick < numTicks; tick++) {
+		if (tick != 0 && tick % ticksPerBlock == 0)
+			writer.StartBlock(tick, tick * 7);
+		writer.WriteByte(0);
+		writer.WriteLE32(tick);
+		for (uint16_t i = 0; i < tick % 5; i++)
+			writer.WriteLE16(i);
+	}
+	writer.Finish();
+}
+
+void ExpectTick(DemoBlockReader &reader, uint32_t tick)
+{
+	EXPECT_EQ(reader.ReadByte(), 0);
+	EXPECT_EQ(reader.ReadLE32(), tick);
+	for (uint16_t i = 0; i < tick % 5; i++)
+		EXPECT_EQ(reader.ReadLE16(), i);
+}
+
+TEST(DemoFile, ReadsBackAllBlocks)
+{
+	FILE *file = std::tmpfile();
+	ASSERT_NE(file, nullptr);
+	WriteByte(file, 4); // Stand-in for the demo header
+	WriteTestDemo(file, 1000, 64);
+	std::fseek(file, 1, SEEK_SET);
+
+	DemoBlockReader reader(file);
+	for (uint32_t tick = 0; tick < 1000; tick++) {
+		ExpectTick(reader, tick);
+		const std::optional<DemoKeyframe> keyframe = reader.TakeKeyframe();
+		ASSERT_EQ(keyframe.has_value(), tick % 64 == 0) << tick;
+		if (keyframe) {
+			EXPECT_EQ(keyframe->tick, tick);
+			EXPECT_EQ(keyframe->rngState, tick == 0 ? 0x1234 : tick * 7);
+		}
+	}
+	reader.ReadByte();
+	EXPECT_TRUE(reader.eof());
+	std::fclose(file);
+}
+
+TEST(DemoFile, IndexListsBlocks)
+{
+	FILE *file = std::tmpfile();
+	ASSERT_NE(file, nullptr);
+	WriteByte(file, 4);
+	WriteTestDemo(file, 1000, 100);
+	std::fseek(file, 1, SEEK_SET);
+
+	const std::optional<std::vector<DemoKeyframe>> index = ReadDemoIndex(file);
+	ASSERT_TRUE(index.has_value());
+	ASSERT_EQ(index->size(), 10);
+	EXPECT_EQ((*index)[0].offset, 1);
+	for (size_t i = 0; i < index->size(); i++) {
+		EXPECT_EQ((*index)[i].tick, i * 100);
+		if (i != 0)
+			EXPECT_GT((*index)[i].offset, (*index)[i - 1].offset);
+	}
+	EXPECT_EQ(std::ftell(file), 1);
+	std::fclose(file);
+}
+
+TEST(DemoFile, SeeksToKeyframe)
+{
+	FILE *file = std::tmpfile();
+	ASSERT_NE(file, nullptr);
+	WriteByte(file, 4);
+	WriteTestDemo(file, 1000, 100);
+	std::fseek(file, 1, SEEK_SET);
+
+	DemoBlockReader reader(file);
+	const std::optional<DemoKeyframe> keyframe = reader.SeekToTick(750);
+	ASSERT_TRUE(keyframe.has_value());
+	EXPECT_EQ(keyframe->tick, 700);
+	EXPECT_EQ(keyframe->rngState, 700 * 7);
+	for (uint32_t tick = 700; tick < 1000; tick++)
+		ExpectTick(reader, tick);
+
+	ASSERT_TRUE(reader.SeekToTick(0).has_value());
+	ExpectTick(reader, 0);
+	EXPECT_FALSE(reader.eof());
+	std::fclose(file);
+}
+
+/** @brief Writes a block header followed by `data`, as if the header was read from a damaged file. */
+void WriteRawBlock(FILE *file, bool compressed, uint32_t rawSize, const std::vector<uint8_t> &data)
+{
+	WriteByte(file, 'B');
+	WriteLE32(file, 0);
+	WriteLE32(file, 0);
+	WriteByte(file, compressed ? 1 : 0);
+	WriteLE32(file, rawSize);
+	WriteLE32(file, static_cast<uint32_t>(data.size()));
+	std::fwrite(data.data(), data.size(), 1, file);
+}
+
+TEST(DemoFile, RejectsOversizedBlock)
+{
+	FILE *file = std::tmpfile();
+	ASSERT_NE(file, nullptr);
+	WriteRawBlock(file, false, 0xFFFFFFFF, { 1, 2, 3, 4 });
+	std::fseek(file, 0, SEEK_SET);
+
+	DemoBlockReader reader(file);
+	reader.ReadLE32();
+	EXPECT_TRUE(reader.eof());
+	std::fclose(file);
+}
+
+TEST(DemoFile, RejectsCorruptBlock)
+{
+	FILE *file = std::tmpfile();
+	ASSERT_NE(file, nullptr);
+	WriteRawBlock(file, true, 16, { 0xDE, 0xAD, 0xBE, 0xEF });
+	std::fseek(file, 0, SEEK_SET);
+
+	DemoBlockReader reader(file);
+	reader.ReadLE32();
+	EXPECT_TRUE(reader.eof());
+	std::fclose(file);
+}
+
+TEST(DemoFile, UnfinishedRecordingHasNoIndex)
+{
+	FILE *file = std::tmpfile();
+	ASSERT_NE(file, nullptr);
+	WriteByte(file, 4);
+	{
+		DemoBlockWriter writer(file);
+		writer.StartBlock(0, 0);
+		writer.WriteLE32(42);
+		writer.StartBlock(1, 0);
+	}
+	std::fseek(file, 1, SEEK_SET);
+
+	EXPECT_FALSE(ReadDemoIndex(file).has_value());
+	DemoBlockReader reader(file);
+	EXPECT_EQ(reader.ReadLE32(), 42);
+	EXPECT_FALSE(reader.eof());
+	EXPECT_FALSE(reader.SeekToTick(0).has_value());
+	std::fclose(file);
+}
+
+} // namespace
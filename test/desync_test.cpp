@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include "desync.h"
+#include "engine/random.hpp"
+#include "items.h"
+#include "levels/gendung.h"
+#include "missiles.h"
+#include "monster.h"
+#include "msg.h"
+#include "multi.h"
+#include "objects.h"
+#include "options.h"
+#include "player.h"
+#include "storm/storm_net.hpp"
+
+using namespace devilution;
+
+namespace {
+
+void ClearGameState()
+{
+	Players.resize(1);
+	MyPlayer = &Players[0];
+	MyPlayer->plractive = false;
+	ActiveMonsterCount = 0;
+	Missiles.clear();
+	ActiveItemCount = 0;
+	ActiveObjectCount = 0;
+	SetRndSeed(42);
+}
+
+TEST(Desync, HashIsStable)
+{
+	ClearGameState();
+	ActiveMonsterCount = 1;
+	ActiveMonsters[0] = 3;
+	Monsters[3].position.tile = { 10, 12 };
+	Monsters[3].hitPoints = 100 << 6;
+
+	EXPECT_EQ(ComputeGameStateHash(), ComputeGameStateHash());
+}
+
+TEST(Desync, ReportsDifferingCategory)
+{
+	ClearGameState();
+	ActiveMonsterCount = 1;
+	ActiveMonsters[0] = 3;
+	Monsters[3].position.tile = { 10, 12 };
+	Monsters[3].hitPoints = 100 << 6;
+	const GameStateHash before = ComputeGameStateHash();
+
+	Monsters[3].hitPoints -= 1 << 6;
+	const GameStateHash after = ComputeGameStateHash();
+	EXPECT_NE(before, after);
+	EXPECT_EQ(DescribeGameStateDifference(before, after), "monsters");
+
+	Monsters[3].aiSeed++;
+	const GameStateHash reseeded = ComputeGameStateHash();
+	EXPECT_EQ(DescribeGameStateDifference(after, reseeded), "monsters");
+
+	// Only one machine plays the sounds of its own player, which advances the global RNG
+	AdvanceRndSeed();
+	EXPECT_EQ(ComputeGameStateHash(), reseeded);
+}
+
+TEST(Desync, ListsEntityHashes)
+{
+	ClearGameState();
+	ActiveMonsterCount = 2;
+	ActiveMonsters[0] = 3;
+	ActiveMonsters[1] = 7;
+	Monsters[3].position.tile = { 10, 12 };
+	Monsters[7].position.tile = { 20, 22 };
+
+	std::vector<GameStateEntityHash> entities;
+	ComputeGameStateHash(&entities);
+	ASSERT_EQ(entities.size(), 2);
+	EXPECT_EQ(entities[0].category, GameStateCategory::Monsters);
+	EXPECT_EQ(entities[0].id, 3);
+	EXPECT_EQ(entities[1].id, 7);
+	EXPECT_NE(entities[0].hash, entities[1].hash);
+}
+
+/** @brief Starts a two player game in which we are player 0 and hashes are shared every 10 ticks. */
+void SetUpPeerGame()
+{
+	ClearGameState();
+	Players.resize(2);
+	MyPlayerId = 0;
+	MyPlayer = &Players[0];
+	gbIsMultiplayer = true;
+	setlevel = false;
+	currlevel = 1;
+	sgOptions.Network.desyncCheckInterval.SetValue(10);
+	SNetInitializeProvider(SELCONN_LOOPBACK, nullptr);
+	DesyncCheckReset();
+
+	ActiveMonsterCount = 1;
+	ActiveMonsters[0] = 3;
+	Monsters[3].position.tile = { 10, 12 };
+	Monsters[3].hitPoints = 100 << 6;
+}
+
+void TearDownPeerGame()
+{
+	DesyncCheckReset();
+	sgOptions.Network.desyncCheckInterval.SetValue(0);
+	gbIsMultiplayer = false;
+}
+
+/** @brief Delivers a CMD_STATEHASH from another player the same way received network messages are. */
+void ReceiveStateHash(uint8_t playerId, uint32_t tick, const GameStateHash &hash)
+{
+	TCmdStateHash cmd {};
+	cmd.bCmd = CMD_STATEHASH;
+	cmd.tick = SDL_SwapLE32(tick);
+	cmd.level = currlevel;
+	cmd.isSetLevel = 0;
+	for (size_t i = 0; i < NumGameStateCategories; i++)
+		cmd.hashes[i] = SDL_SwapLE32(hash.categories[i]);
+	EXPECT_EQ(ParseCmd(playerId, reinterpret_cast<const TCmd *>(&cmd)), sizeof(cmd));
+}
+
+TEST(Desync, ComparesPeerStateHashes)
+{
+	SetUpPeerGame();
+
+	// Peer is behind, our hash for the tick is already recorded
+	DesyncCheckGameTick(10);
+	ReceiveStateHash(1, 10, ComputeGameStateHash());
+	EXPECT_EQ(GetFirstDesyncTick(Players[1]), std::nullopt);
+
+	// Peer is ahead, its hash waits for ours
+	ReceiveStateHash(1, 20, ComputeGameStateHash());
+	EXPECT_EQ(GetFirstDesyncTick(Players[1]), std::nullopt);
+	DesyncCheckGameTick(20);
+	EXPECT_EQ(GetFirstDesyncTick(Players[1]), std::nullopt);
+
+	// Hashes of other levels are not comparable
+	Monsters[3].hitPoints -= 1 << 6;
+	DesyncCheckGameTick(30);
+	currlevel = 2;
+	ReceiveStateHash(1, 30, {});
+	currlevel = 1;
+	EXPECT_EQ(GetFirstDesyncTick(Players[1]), std::nullopt);
+
+	// Our own hash echoed back is ignored
+	DesyncCheckGameTick(40);
+	ReceiveStateHash(0, 40, {});
+	EXPECT_EQ(GetFirstDesyncTick(Players[0]), std::nullopt);
+
+	TearDownPeerGame();
+}
+
+TEST(Desync, ReportsFirstDivergentTick)
+{
+	SetUpPeerGame();
+
+	const GameStateHash shared = ComputeGameStateHash();
+	DesyncCheckGameTick(10);
+	ReceiveStateHash(1, 10, shared);
+
+	Monsters[3].hitPoints -= 1 << 6;
+	ReceiveStateHash(1, 20, shared);
+	DesyncCheckGameTick(20);
+	EXPECT_EQ(GetFirstDesyncTick(Players[1]), 20U);
+
+	Monsters[3].hitPoints -= 1 << 6;
+	DesyncCheckGameTick(30);
+	ReceiveStateHash(1, 30, shared);
+	EXPECT_EQ(GetFirstDesyncTick(Players[1]), 20U);
+
+	DesyncCheckReset();
+	EXPECT_EQ(GetFirstDesyncTick(Players[1]), std::nullopt);
+
+	TearDownPeerGame();
+}
+
+} // namespace
@@ -0,0 +1,139 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "engine.h"
+#include "engine/render/draw_commands.hpp"
+
+namespace devilution {
+namespace {
+
+/** @brief Draws the list onto a blank surface and returns its pixels, '.' for color 0 and the digit of the color otherwise. */
+std::string Render(const DrawCommandList &list, int width, int height)
+{
+	OwnedSurface surface { width, height };
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			surface[{ x, y }] = 0;
+		}
+	}
+
+	list.Draw(surface);
+
+	std::string pixels;
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			const uint8_t color = surface[{ x, y }];
+			pixels += color == 0 ? '.' : static_cast<char>('0' + color);
+		}
+		pixels += '\n';
+	}
+	return pixels;
+}
+
+TEST(DrawCommandsTest, RectsAreClippedToSurface)
+{
+	DrawCommandList list;
+	list.AddRect({ { -2, -2 }, { 4, 4 } }, 1);
+	list.AddRect({ { 5, 3 }, { 10, 10 } }, 2);
+	list.AddRect({ { 3, 1 }, { 2, 1 } }, 3);
+
+	EXPECT_EQ(Render(list, 8, 5),
+	    "11......\n"
+	    "11.33...\n"
+	    "........\n"
+	    ".....222\n"
+	    ".....222\n");
+}
+
+TEST(DrawCommandsTest, Lines)
+{
+	DrawCommandList list;
+	list.AddLine({ 0, 0 }, { 3, 3 }, 1);
+	list.AddLine({ 7, 4 }, { 7, 0 }, 2);
+	list.AddLine({ -3, 4 }, { 5, 4 }, 3);
+	list.AddLine({ 6, 0 }, { 4, 1 }, 4);
+
+	EXPECT_EQ(Render(list, 8, 5),
+	    "1.....42\n"
+	    ".1..44.2\n"
+	    "..1....2\n"
+	    "...1...2\n"
+	    "333333.2\n");
+}
+
+TEST(DrawCommandsTest, LinesAreClippedToSurface)
+{
+	DrawCommandList list;
+	list.AddLine({ 1, 1 }, { 1, 9 }, 1);
+	list.AddLine({ 3, 2 }, { 12, 5 }, 2);
+	list.AddLine({ 5, 2 }, { 9, 6 }, 3);
+	list.AddLine({ -1000000000, -1000000000 }, { 1000000000, 1000000000 }, 4);
+	list.AddLine({ 20, -3 }, { 30, 40 }, 5);
+
+	EXPECT_EQ(Render(list, 8, 5),
+	    "4.......\n"
+	    ".4......\n"
+	    ".14223..\n"
+	    ".1.4.232\n"
+	    ".1..4..3\n");
+}
+
+TEST(DrawCommandsTest, VerticalLineStopsAtSurfaceBottom)
+{
+	OwnedSurface surface { 2, 6 };
+	for (int y = 0; y < surface.h(); y++) {
+		for (int x = 0; x < surface.w(); x++) {
+			surface[{ x, y }] = 0;
+		}
+	}
+
+	DrawVerticalLine(surface.subregion(0, 0, 2, 3), { 1, 2 }, 3, 1);
+
+	for (int y = 0; y < surface.h(); y++) {
+		EXPECT_EQ((surface[{ 0, y }]), 0) << y;
+		EXPECT_EQ((surface[{ 1, y }]), y == 2 ? 1 : 0) << y;
+	}
+}
+
+TEST(DrawCommandsTest, ClipLimitsFollowingCommands)
+{
+	DrawCommandList list;
+	list.AddRect({ { 0, 0 }, { 8, 1 } }, 1);
+	list.SetClip({ { 2, 1 }, { 3, 3 } });
+	list.AddRect({ { 0, 0 }, { 8, 5 } }, 2);
+	list.AddLine({ 0, 0 }, { 7, 7 }, 3);
+	list.SetClip({});
+	list.AddLine({ 0, 4 }, { 7, 4 }, 4);
+
+	EXPECT_EQ(Render(list, 8, 5),
+	    "11111111\n"
+	    "..222...\n"
+	    "..322...\n"
+	    "..232...\n"
+	    "44444444\n");
+}
+
+TEST(DrawCommandsTest, CommandsAreRetainedUntilCleared)
+{
+	DrawCommandList list;
+	EXPECT_TRUE(list.empty());
+	list.AddRect({ { 1, 1 }, { 2, 1 } }, 5);
+	const std::string expected = "....\n.55.\n";
+	EXPECT_EQ(Render(list, 4, 2), expected);
+	EXPECT_EQ(Render(list, 4, 2), expected);
+
+	list.Clear();
+	EXPECT_TRUE(list.empty());
+	EXPECT_EQ(Render(list, 4, 2), "....\n....\n");
+}
+
+TEST(DrawCommandsTest, MissingSpriteIsNotRecorded)
+{
+	DrawCommandList list;
+	EXPECT_FALSE(list.AddSprite("data\\no_such_sprite.clx", 0, { 0, 0 }));
+	EXPECT_TRUE(list.empty());
+}
+
+} // namespace
+} // namespace devilution
@@ -2,6 +2,9 @@
 #include <gtest/gtest.h>
 
 #include <array>
+#include <cstring>
+#include <random>
+#include <vector>
 
 #include "engine/points_in_rectangle_range.hpp"
 #include "engine/world_tile.hpp"
@@ -106,4 +109,113 @@ TEST(DrlgTest, ThemeRoomSize)
 	EXPECT_EQ(GetSizeForThemeRoom(), WorldTileSize(4, 4)) << "Search is terminated by the 0 width row 7, inset corner gives a larger height than otherwise expected";
 }
 
+namespace {
+
+/** @brief Fills the dungeon from a small set of tiles so that minisets match often. */
+void FillRandomDungeon(std::mt19937 &rng)
+{
+	Protected.reset();
+	for (WorldTileCoord y = 0; y < DMAXY; y++) {
+		for (WorldTileCoord x = 0; x < DMAXX; x++) {
+			dungeon[x][y] = static_cast<uint8_t>(1 + rng() % 3);
+			if (rng() % 8 == 0)
+				Protected.set(x, y);
+		}
+	}
+}
+
+Miniset RandomMiniset(std::mt19937 &rng)
+{
+	Miniset miniset {};
+	miniset.size = { static_cast<WorldTileCoord>(1 + rng() % 4), static_cast<WorldTileCoord>(1 + rng() % 4) };
+	for (WorldTileCoord y = 0; y < miniset.size.height; y++) {
+		for (WorldTileCoord x = 0; x < miniset.size.width; x++) {
+			// Mostly wildcards and only a couple of tiles so that searches have hits
+			miniset.search[y][x] = rng() % 3 == 0 ? 0 : static_cast<uint8_t>(1 + rng() % 2);
+			miniset.replace[y][x] = rng() % 2 == 0 ? 0 : static_cast<uint8_t>(1 + rng() % 4);
+		}
+	}
+	return miniset;
+}
+
+/** @brief The tile by tile scan that the drlg PlaceMiniSetRandom functions did before MinisetMatcher. */
+void PlaceEverywhereReference(const Miniset &miniset, bool respectProtected, std::mt19937 &rng)
+{
+	const WorldTileCoord sw = miniset.size.width;
+	const WorldTileCoord sh = miniset.size.height;
+	for (WorldTileCoord sy = 0; sy < DMAXY - sh; sy++) {
+		for (WorldTileCoord sx = 0; sx < DMAXX - sw; sx++) {
+			if (!miniset.matches({ sx, sy }, respectProtected))
+				continue;
+			if (rng() % 100 >= 50)
+				continue;
+			miniset.place({ sx, sy });
+		}
+	}
+}
+
+void PlaceEverywhere(const Miniset &miniset, bool respectProtected, std::mt19937 &rng)
+{
+	const WorldTileCoord sw = miniset.size.width;
+	const WorldTileCoord sh = miniset.size.height;
+	const WorldTileCoord endX = DMAXX - sw;
+	MinisetMatcher matcher(miniset, respectProtected);
+	for (WorldTileCoord sy = 0; sy < DMAXY - sh; sy++) {
+		for (WorldTileCoord sx = matcher.nextMatch({ 0, sy }, endX); sx < endX; sx = matcher.nextMatch({ static_cast<WorldTileCoord>(sx + 1), sy }, endX)) {
+			if (rng() % 100 >= 50)
+				continue;
+			matcher.place({ sx, sy });
+		}
+	}
+}
+
+} // namespace
+
+TEST(DrlgTest, MinisetMatcherMatchesEveryPosition)
+{
+	for (uint32_t seed = 0; seed < 100; seed++) {
+		std::mt19937 rng(seed);
+		FillRandomDungeon(rng);
+		const Miniset miniset = RandomMiniset(rng);
+		const bool respectProtected = seed % 2 == 0;
+		const MinisetMatcher matcher(miniset, respectProtected);
+		for (WorldTileCoord y = 0; y <= DMAXY - miniset.size.height; y++) {
+			const uint64_t row = matcher.matchesInRow(y);
+			for (WorldTileCoord x = 0; x <= DMAXX - miniset.size.width; x++) {
+				ASSERT_EQ((row >> x) & 1, miniset.matches({ x, y }, respectProtected) ? 1U : 0U) << "seed " << seed << " at " << static_cast<int>(x) << "," << static_cast<int>(y);
+			}
+			ASSERT_EQ(row >> (DMAXX - miniset.size.width + 1), 0U) << "Matches must leave room for the miniset";
+		}
+	}
+}
+
+TEST(DrlgTest, MinisetMatcherPlacesLikeTileByTileScan)
+{
+	for (uint32_t seed = 0; seed < 100; seed++) {
+		std::mt19937 rng(seed);
+		FillRandomDungeon(rng);
+		std::vector<Miniset> minisets;
+		for (int i = 0; i < 8; i++)
+			minisets.push_back(RandomMiniset(rng));
+		const bool respectProtected = seed % 2 == 0;
+
+		uint8_t start[DMAXX][DMAXY];
+		memcpy(start, dungeon, sizeof(dungeon));
+
+		std::mt19937 referenceRng(seed);
+		for (const Miniset &miniset : minisets)
+			PlaceEverywhereReference(miniset, respectProtected, referenceRng);
+		uint8_t expected[DMAXX][DMAXY];
+		memcpy(expected, dungeon, sizeof(dungeon));
+
+		memcpy(dungeon, start, sizeof(dungeon));
+		std::mt19937 matcherRng(seed);
+		for (const Miniset &miniset : minisets)
+			PlaceEverywhere(miniset, respectProtected, matcherRng);
+
+		ASSERT_EQ(memcmp(dungeon, expected, sizeof(dungeon)), 0) << "seed " << seed;
+		ASSERT_EQ(matcherRng(), referenceRng()) << "Both scans must draw the same random numbers, seed " << seed;
+	}
+}
+
 } // namespace devilution
@@ -0,0 +1,64 @@
+#include <array>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include "drlg_test.hpp"
+#include "engine/random.hpp"
+#include "levels/gendung.h"
+
+using namespace devilution;
+
+namespace {
+
+constexpr uint32_t NumSeeds = 20;
+
+/**
+ * @brief Dungeon hashes of levels 1 to 24, one per level over seeds level * 1000 + 1 to level * 1000 + NumSeeds.
+ *
+ * Recorded with the implementation from before MinisetMatcher, which compared minisets with the dungeon tile by tile.
+ */
+constexpr std::array<uint32_t, 24> ExpectedDungeonHashes = {
+	0x65FCF824, 0x5986B8F6, 0x6D37A85C, 0xD80B4EDC, 0x2D9B414C, 0x72DFA190,
+	0xFBB9D8A0, 0x12BAAB9A, 0x70F185DF, 0x0B69AB8A, 0x6FC01259, 0x7BB0BC58,
+	0x0039BC23, 0x18BF81F7, 0x7DE333C2, 0x9290F6BB, 0xA60396D1, 0x7F4D0A8D,
+	0xD8799BD5, 0xDBA867AF, 0x28B8D99E, 0x7A90E521, 0x6B2F7926, 0xC59390FE,
+};
+
+/** @brief Hashes the tiles CreateDungeon generates, along with the random numbers used. */
+uint32_t HashDungeon(int level, uint32_t seed)
+{
+	currlevel = level;
+	leveltype = GetLevelType(level);
+
+	LevelArena.reset();
+	pMegaTiles = LevelArena.allocate<MegaTile>(GetTileCount(leveltype));
+
+	CreateDungeon(seed, ENTRY_MAIN);
+
+	uint32_t hash = 2166136261U;
+	for (int y = 0; y < DMAXY; y++) {
+		for (int x = 0; x < DMAXX; x++)
+			hash = (hash ^ dungeon[x][y]) * 16777619U;
+	}
+	return (hash ^ GetLCGEngineState()) * 16777619U;
+}
+
+TEST(DrlgSweep, DungeonsMatchTileByTileMinisetScan)
+{
+	paths::SetPrefPath(paths::BasePath());
+	paths::SetAssetsPath(paths::BasePath() + "/test/fixtures/");
+	TestInitGame();
+
+	for (int level = 1; level <= 24; level++) {
+		// The corner stone and Na-Krul's room of the Crypt are loaded from the assets
+		if (level == 21)
+			paths::SetAssetsPath(paths::BasePath() + "/assets");
+		uint32_t hash = 2166136261U;
+		for (uint32_t seed = level * 1000U + 1; seed <= level * 1000U + NumSeeds; seed++)
+			hash = (hash ^ HashDungeon(level, seed)) * 16777619U;
+		EXPECT_EQ(hash, ExpectedDungeonHashes[level - 1]) << "level " << level;
+	}
+}
+
+} // namespace
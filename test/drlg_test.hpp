@@ -5,6 +5,8 @@
  */
 #pragma once
 
+#include <algorithm>
+
 #include "engine/load_file.hpp"
 #include "levels/themes.h"
 #include "multi.h"
@@ -68,7 +70,10 @@ void TestCreateDungeon(int level, uint32_t seed, lvl_entry entry)
 	currlevel = level;
 	leveltype = GetLevelType(level);
 
-	pMegaTiles = std::make_unique<MegaTile[]>(GetTileCount(leveltype));
+	LevelArena.reset();
+	const int tileCount = GetTileCount(leveltype);
+	pMegaTiles = LevelArena.allocate<MegaTile>(tileCount);
+	std::fill_n(pMegaTiles, tileCount, MegaTile {});
 
 	CreateDungeon(seed, entry);
 	CreateThemeRooms();
@@ -0,0 +1,95 @@
+#include <cstdlib>
+#include <initializer_list>
+#include <new>
+
+#include <gtest/gtest.h>
+
+#include "engine/assets.hpp"
+#include "engine/surface.hpp"
+#include "options.h"
+#include "player.h"
+#include "qol/floatingnumbers.h"
+
+namespace {
+
+size_t AllocationCount = 0;
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+	AllocationCount++;
+	if (void *ptr = std::malloc(size != 0 ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+namespace devilution {
+namespace {
+
+TEST(FloatingNumbersTest, AddingNumbersDoesNotAllocate)
+{
+	Players.resize(4);
+	MyPlayer = &Players[0];
+	sgOptions.Gameplay.enableFloatingNumbers.SetValue(FloatingNumbers::Vertical);
+	ClearFloatingNumbers();
+
+	const size_t allocationsBefore = AllocationCount;
+	// Simulate many frames of a big fight, far more numbers than fit on screen at once
+	for (int frame = 0; frame < 100; frame++) {
+		for (int hit = 0; hit < 50; hit++) {
+			const Player &player = Players[hit % Players.size()];
+			AddFloatingNumber(static_cast<DamageType>(hit % 5), player, (frame * 50 + hit) * 37);
+			AddFloatingNumber(DamageType::Physical, player, 20);
+		}
+	}
+	EXPECT_EQ(AllocationCount, allocationsBefore);
+
+	ClearFloatingNumbers();
+	sgOptions.Gameplay.enableFloatingNumbers.SetValue(FloatingNumbers::Off);
+}
+
+TEST(FloatingNumbersTest, DrawingNumbersDoesNotAllocate)
+{
+	for (const char *font : { "fonts\\12-00.clx", "fonts\\24-00.clx", "fonts\\30-00.clx" }) {
+		if (!FindAsset(font).ok())
+			GTEST_SKIP() << "Missing font " << font;
+	}
+
+	Players.resize(4);
+	MyPlayer = &Players[0];
+	sgOptions.Gameplay.enableFloatingNumbers.SetValue(FloatingNumbers::Vertical);
+	ClearFloatingNumbers();
+	for (int hit = 0; hit < 200; hit++) {
+		Player &player = Players[hit % Players.size()];
+		player.position.tile = { 10 + hit % 7, 10 + hit % 5 };
+		AddFloatingNumber(static_cast<DamageType>(hit % 5), player, (hit * 997) << 3);
+	}
+
+	OwnedSurface out { 640, 480 };
+	const Point viewPosition { 10, 10 };
+	const Displacement offset { 320, 240 };
+	// The first frame loads the fonts and measures the text
+	DrawFloatingNumbers(out, viewPosition, offset);
+
+	const size_t allocationsBefore = AllocationCount;
+	for (int frame = 0; frame < 60; frame++)
+		DrawFloatingNumbers(out, viewPosition, offset);
+	EXPECT_EQ(AllocationCount, allocationsBefore);
+
+	ClearFloatingNumbers();
+	sgOptions.Gameplay.enableFloatingNumbers.SetValue(FloatingNumbers::Off);
+}
+
+} // namespace
+} // namespace devilution
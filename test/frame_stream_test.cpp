@@ -0,0 +1,121 @@
+#include <array>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/frame_stream.hpp"
+
+using namespace devilution;
+
+namespace {
+
+constexpr int Width = 64;
+constexpr int Height = 48;
+
+std::array<SDL_Color, 256> MakePalette(uint8_t tint)
+{
+	std::array<SDL_Color, 256> palette;
+	for (size_t i = 0; i < palette.size(); i++)
+		palette[i] = SDL_Color { static_cast<uint8_t>(i), tint, static_cast<uint8_t>(255 - i), SDL_ALPHA_OPAQUE };
+	return palette;
+}
+
+/** @brief A sequence of frames that exercises fills, literals and unchanged areas. */
+std::vector<std::vector<uint8_t>> MakeFrames()
+{
+	std::mt19937 rng(1234);
+	std::vector<std::vector<uint8_t>> frames;
+	std::vector<uint8_t> frame(Width * Height, 0);
+	for (int i = 0; i < 6; i++) {
+		// A solid block that moves every frame
+		for (int y = 10; y < 20; y++) {
+			for (int x = 0; x < 16; x++)
+				frame[y * Width + (x + i * 3) % Width] = static_cast<uint8_t>(200 + i);
+		}
+		// Noise in a few scattered pixels
+		for (int n = 0; n < 50; n++)
+			frame[rng() % frame.size()] = static_cast<uint8_t>(rng());
+		frames.push_back(frame);
+	}
+	// One unchanged frame and one changing only the last pixel
+	frames.push_back(frame);
+	frame.back() ^= 0xFF;
+	frames.push_back(frame);
+	return frames;
+}
+
+long WriteStream(FILE *file, const std::vector<std::vector<uint8_t>> &frames)
+{
+	FrameStreamWriter writer(file, Width, Height);
+	for (size_t i = 0; i < frames.size(); i++) {
+		EXPECT_TRUE(writer.WriteFrame(static_cast<uint32_t>(i * 2), frames[i].data(), MakePalette(i < 3 ? 0 : 1)));
+	}
+	return std::ftell(file);
+}
+
+TEST(FrameStreamTest, RoundTrip)
+{
+	const std::vector<std::vector<uint8_t>> frames = MakeFrames();
+	FILE *file = std::tmpfile();
+	ASSERT_NE(file, nullptr);
+	WriteStream(file, frames);
+	std::rewind(file);
+
+	FrameStreamReader reader(file);
+	ASSERT_TRUE(reader.ok());
+	EXPECT_EQ(reader.width(), Width);
+	EXPECT_EQ(reader.height(), Height);
+	for (size_t i = 0; i < frames.size(); i++) {
+		ASSERT_TRUE(reader.ReadFrame()) << "frame " << i;
+		EXPECT_EQ(reader.number(), i * 2);
+		EXPECT_EQ(std::vector<uint8_t>(reader.pixels(), reader.pixels() + Width * Height), frames[i]) << "frame " << i;
+		const std::array<SDL_Color, 256> palette = MakePalette(i < 3 ? 0 : 1);
+		EXPECT_EQ(reader.palette()[17].g, palette[17].g) << "frame " << i;
+	}
+	EXPECT_FALSE(reader.ReadFrame());
+	std::fclose(file);
+}
+
+TEST(FrameStreamTest, UnchangedFramesAreSmall)
+{
+	const std::vector<uint8_t> frame(Width * Height, 7);
+	FILE *file = std::tmpfile();
+	ASSERT_NE(file, nullptr);
+	FrameStreamWriter writer(file, Width, Height);
+	ASSERT_TRUE(writer.WriteFrame(0, frame.data(), MakePalette(0)));
+	const long first = std::ftell(file);
+	ASSERT_TRUE(writer.WriteFrame(1, frame.data(), MakePalette(0)));
+	// Frame header, size and a single skip covering the whole frame
+	EXPECT_LE(std::ftell(file) - first, 12);
+	std::fclose(file);
+}
+
+TEST(FrameStreamTest, RejectsCorruptFrames)
+{
+	const std::vector<std::vector<uint8_t>> frames = MakeFrames();
+	FILE *file = std::tmpfile();
+	ASSERT_NE(file, nullptr);
+	const long size = WriteStream(file, frames);
+
+	// Truncate the stream in the middle of the last frame's pixel data
+	std::vector<uint8_t> data(size);
+	std::rewind(file);
+	ASSERT_EQ(std::fread(data.data(), data.size(), 1, file), 1U);
+	std::fclose(file);
+	data.resize(data.size() - 1);
+	file = std::tmpfile();
+	ASSERT_NE(file, nullptr);
+	std::fwrite(data.data(), data.size(), 1, file);
+	std::rewind(file);
+
+	FrameStreamReader reader(file);
+	ASSERT_TRUE(reader.ok());
+	for (size_t i = 0; i + 1 < frames.size(); i++)
+		ASSERT_TRUE(reader.ReadFrame()) << "frame " << i;
+	EXPECT_FALSE(reader.ReadFrame());
+	std::fclose(file);
+}
+
+} // namespace
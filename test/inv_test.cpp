@@ -1,8 +1,16 @@
+#include <algorithm>
+#include <array>
+#include <random>
+#include <utility>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "cursor.h"
 #include "inv.h"
+#include "lighting.h"
 #include "player.h"
+#include "playerdat.hpp"
 #include "storm/storm_net.hpp"
 
 namespace devilution {
@@ -19,6 +27,7 @@ public:
 	static void SetUpTestSuite()
 	{
 		LoadSpellData();
+		LoadPlayerDataFiles();
 		LoadItemData();
 	}
 };
@@ -309,5 +318,229 @@ TEST_F(InvTest, ItemSize)
 	EXPECT_EQ(GetInventorySize(testItem), Size(1, 1));
 }
 
+/** @brief Cell-by-cell fit check the inventory used before InventoryOccupancy. */
+bool ReferenceFitsInSlot(const int8_t (&invGrid)[InventoryGridCells], int slotIndex, Size itemSize)
+{
+	int yy = 10 * (slotIndex / 10);
+	for (int j = 0; j < itemSize.height; j++) {
+		if (yy >= InventoryGridCells)
+			return false;
+		int xx = slotIndex % 10;
+		for (int i = 0; i < itemSize.width; i++) {
+			if (xx >= 10 || invGrid[xx + yy] != 0)
+				return false;
+			xx++;
+		}
+		yy += 10;
+	}
+	return true;
+}
+
+/** @brief The slot AutoPlaceItemInInventory picked before InventoryOccupancy, or -1 if the item doesn't fit. */
+int ReferenceAutoPlaceSlot(const int8_t (&invGrid)[InventoryGridCells], Size itemSize)
+{
+	std::vector<int> slots;
+	if (itemSize.height == 1) {
+		for (int i = 30; i <= 39; i++)
+			slots.push_back(i);
+		for (int x = 9; x >= 0; x--) {
+			for (int y = 2; y >= 0; y--)
+				slots.push_back(10 * y + x);
+		}
+	} else if (itemSize.height == 2) {
+		for (int x = 10 - itemSize.width; x >= 0; x -= itemSize.width) {
+			for (int y = 0; y < 3; y++)
+				slots.push_back(10 * y + x);
+		}
+		if (itemSize.width == 2) {
+			for (int x = 7; x >= 0; x -= 2) {
+				for (int y = 0; y < 3; y++)
+					slots.push_back(10 * y + x);
+			}
+		}
+	} else if (itemSize == Size { 1, 3 }) {
+		for (int i = 0; i < 20; i++)
+			slots.push_back(i);
+	} else if (itemSize == Size { 2, 3 }) {
+		for (int i = 0; i < 9; i++)
+			slots.push_back(i);
+		for (int i = 10; i < 19; i++)
+			slots.push_back(i);
+	}
+	for (int slot : slots) {
+		if (ReferenceFitsInSlot(invGrid, slot, itemSize))
+			return slot;
+	}
+	return -1;
+}
+
+void TestAutoPlaceSlot(const Item &item, Size itemSize, uint64_t occupiedCells)
+{
+	clear_inventory();
+	for (int i = 0; i < InventoryGridCells; i++) {
+		if ((occupiedCells & (uint64_t { 1 } << i)) != 0)
+			MyPlayer->InvGrid[i] = -1;
+	}
+
+	const int expectedSlot = ReferenceAutoPlaceSlot(MyPlayer->InvGrid, itemSize);
+	ASSERT_EQ(AutoPlaceItemInInventory(*MyPlayer, item), expectedSlot != -1) << "cells " << occupiedCells;
+	ASSERT_EQ(AutoPlaceItemInInventory(*MyPlayer, item, true), expectedSlot != -1) << "cells " << occupiedCells;
+	if (expectedSlot == -1)
+		return;
+
+	// The bottom-left cell of an item refers to it with a positive index
+	EXPECT_EQ(MyPlayer->InvGrid[expectedSlot + 10 * (itemSize.height - 1)], 1) << "cells " << occupiedCells;
+	for (int y = 0; y < itemSize.height; y++) {
+		for (int x = 0; x < itemSize.width; x++)
+			EXPECT_NE(MyPlayer->InvGrid[expectedSlot + 10 * y + x], 0) << "cells " << occupiedCells;
+	}
+}
+
+TEST_F(InvTest, AutoPlaceItemInInventory_slot_order)
+{
+	std::vector<std::pair<Item, Size>> itemsBySize;
+	for (int i = 0; i <= IDI_LAST; i++) {
+		Item item {};
+		InitializeItem(item, static_cast<_item_indexes>(i));
+		const Size itemSize = GetInventorySize(item);
+		if (c_none_of(itemsBySize, [&itemSize](const std::pair<Item, Size> &entry) { return entry.second == itemSize; }))
+			itemsBySize.emplace_back(item, itemSize);
+	}
+	ASSERT_GE(itemsBySize.size(), 5);
+
+	std::mt19937_64 rng(1234);
+	for (const auto &[item, itemSize] : itemsBySize) {
+		TestAutoPlaceSlot(item, itemSize, 0);
+		// Every inventory with one or two occupied cells
+		for (int i = 0; i < InventoryGridCells; i++) {
+			for (int j = i; j < InventoryGridCells; j++)
+				TestAutoPlaceSlot(item, itemSize, (uint64_t { 1 } << i) | (uint64_t { 1 } << j));
+		}
+		// Random inventories from nearly empty to nearly full
+		for (int density = 1; density < 8; density++) {
+			for (int n = 0; n < 2000; n++) {
+				uint64_t occupiedCells = 0;
+				for (int i = 0; i < InventoryGridCells; i++) {
+					if (rng() % 8 < static_cast<uint64_t>(density))
+						occupiedCells |= uint64_t { 1 } << i;
+				}
+				TestAutoPlaceSlot(item, itemSize, occupiedCells);
+			}
+		}
+	}
+}
+
+/** @brief An equippable item with random bonuses and requirements, so equipping it can change which other items are usable. */
+Item RandomEquipment(std::mt19937 &rng)
+{
+	const auto random = [&rng](int min, int max) { return std::uniform_int_distribution<int>(min, max)(rng); };
+	Item item {};
+	do {
+		InitializeItem(item, static_cast<_item_indexes>(random(0, IDI_LAST)));
+	} while (IsNoneOf(item._iClass, ICLASS_WEAPON, ICLASS_ARMOR));
+	item._iMagical = static_cast<item_quality>(random(ITEM_QUALITY_NORMAL, ITEM_QUALITY_UNIQUE));
+	item._iIdentified = random(0, 1) == 1;
+	item._iPLStr = random(-10, 10);
+	item._iPLMag = random(-10, 10);
+	item._iPLDex = random(-10, 10);
+	item._iPLVit = random(-10, 10);
+	item._iPLDam = random(0, 50);
+	item._iPLToHit = random(0, 30);
+	item._iPLAC = random(-20, 50);
+	item._iPLFR = random(0, 30);
+	item._iPLLR = random(0, 30);
+	item._iPLMR = random(0, 30);
+	item._iPLLight = random(-2, 2);
+	item._iPLHP = random(-10, 10) << 6;
+	item._iPLMana = random(-10, 10) << 6;
+	item._iFlags = random(0, 3) == 0 ? ItemSpecialEffect::ZeroResistance : ItemSpecialEffect::None;
+	item._iMinStr = random(0, 45);
+	item._iMinMag = random(0, 45);
+	item._iMinDex = random(0, 45);
+	return item;
+}
+
+/** @brief Everything CalcPlrInv derives from the player's equipment. */
+std::vector<int> DerivedStats(const Player &player)
+{
+	std::vector<int> stats {
+		player._pStrength, player._pMagic, player._pDexterity, player._pVitality, player._pDamageMod,
+		player._pHitPoints, player._pMaxHP, player._pMana, player._pMaxMana,
+		player._pIMinDam, player._pIMaxDam, player._pIAC, player._pIBonusDam, player._pIBonusToHit, player._pIBonusAC,
+		player._pIBonusDamMod, player._pIGetHit, player._pIEnAc, player._pIFMinDam, player._pIFMaxDam, player._pILMinDam, player._pILMaxDam,
+		static_cast<int>(player._pIFlags), static_cast<int>(player.pDamAcFlags), player._pISplLvlAdd, player._pLightRad,
+		player._pMagResist, player._pFireResist, player._pLghtResist, player._pBlockFlag, player._pgfxnum,
+		static_cast<int>(player._pISpells), static_cast<int>(player._pScrlSpells)
+	};
+	for (const Item &item : player.InvBody)
+		stats.push_back(item._iStatFlag);
+	for (int i = 0; i < player._pNumInv; i++)
+		stats.push_back(player.InvList[i]._iStatFlag);
+	return stats;
+}
+
+TEST_F(InvTest, CalcPlrInvAfterEquip_matches_CalcPlrInv)
+{
+	std::mt19937 rng(1234);
+	const auto random = [&rng](int min, int max) { return std::uniform_int_distribution<int>(min, max)(rng); };
+
+	// The first player is only ever updated incrementally, so any drift in its cached slot bonuses accumulates over
+	// the whole sequence. The second player mirrors every change and is recalculated from scratch each time.
+	Players.resize(2);
+	Player &player = Players[0];
+	Player &reference = Players[1];
+	const auto recalculateReference = [&]() {
+		MyPlayer = &reference;
+		CalcPlrInv(reference, false);
+		MyPlayer = &player;
+	};
+
+	for (int round = 0; round < 50; round++) {
+		const auto heroClass = static_cast<HeroClass>(random(0, static_cast<int>(HeroClass::Barbarian)));
+		const int level = random(1, 50);
+		const int baseStr = random(15, 40);
+		const int baseMag = random(15, 40);
+		const int baseDex = random(15, 40);
+		const int baseVit = random(15, 40);
+		std::array<Item, 5> carried;
+		for (Item &item : carried)
+			item = RandomEquipment(rng);
+		for (Player *target : { &player, &reference }) {
+			target->lightId = NO_LIGHT;
+			target->_pClass = heroClass;
+			target->setCharacterLevel(level);
+			target->_pBaseStr = baseStr;
+			target->_pBaseMag = baseMag;
+			target->_pBaseDex = baseDex;
+			target->_pBaseVit = baseVit;
+			target->_pHPBase = target->_pMaxHPBase = 100 << 6;
+			target->_pManaBase = target->_pMaxManaBase = 50 << 6;
+			for (Item &item : target->InvBody)
+				item.clear();
+			for (Item &item : target->SpdList)
+				item.clear();
+			for (int i = 0; i < InventoryGridCells; i++)
+				target->InvGrid[i] = 0;
+			std::copy(carried.begin(), carried.end(), target->InvList);
+			target->_pNumInv = static_cast<int>(carried.size());
+		}
+		MyPlayer = &player;
+		CalcPlrInv(player, false);
+
+		for (int change = 0; change < 40; change++) {
+			const auto bodyLocation = static_cast<inv_body_loc>(random(0, NUM_INVLOC - 1));
+			if (random(0, 3) == 0) {
+				player.InvBody[bodyLocation].clear();
+				reference.InvBody[bodyLocation].clear();
+			} else {
+				player.InvBody[bodyLocation] = reference.InvBody[bodyLocation] = RandomEquipment(rng);
+			}
+			CalcPlrInvAfterEquip(player, { bodyLocation }, false);
+			recalculateReference();
+			ASSERT_EQ(DerivedStats(player), DerivedStats(reference)) << "round " << round << " change " << change;
+		}
+	}
+}
+
 } // namespace
 } // namespace devilution
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include "engine/random.hpp"
+#include "items.h"
+
+using namespace devilution;
+
+namespace {
+
+struct AffixRoll {
+	const PLStruct *prefix;
+	const PLStruct *suffix;
+	uint32_t rngState;
+
+	bool operator==(const AffixRoll &other) const
+	{
+		return prefix == other.prefix && suffix == other.suffix && rngState == other.rngState;
+	}
+};
+
+/** The linear scan GetItemPowerPrefixAndSuffix used before the affix candidate index was introduced. */
+AffixRoll ReferencePrefixAndSuffix(int minlvl, int maxlvl, AffixItemType flgs, bool onlygood, bool hellfireItem)
+{
+	AffixRoll result { nullptr, nullptr, 0 };
+	int preidx = -1;
+	int sufidx = -1;
+
+	int l[256];
+	goodorevil goe;
+
+	bool allocatePrefix = FlipCoin(4);
+	bool allocateSuffix = !FlipCoin(3);
+	if (!allocatePrefix && !allocateSuffix) {
+		if (FlipCoin())
+			allocatePrefix = true;
+		else
+			allocateSuffix = true;
+	}
+	goe = GOE_ANY;
+	if (!onlygood && !FlipCoin(3))
+		onlygood = true;
+	if (allocatePrefix) {
+		int nt = 0;
+		for (int j = 0, n = static_cast<int>(ItemPrefixes.size()); j < n; ++j) {
+			if (!IsPrefixValidForItemType(j, flgs, hellfireItem))
+				continue;
+			if (ItemPrefixes[j].PLMinLvl < minlvl || ItemPrefixes[j].PLMinLvl > maxlvl)
+				continue;
+			if (onlygood && !ItemPrefixes[j].PLOk)
+				continue;
+			if (HasAnyOf(flgs, AffixItemType::Staff) && ItemPrefixes[j].power.type == IPL_CHARGES)
+				continue;
+			l[nt] = j;
+			nt++;
+			if (ItemPrefixes[j].PLDouble) {
+				l[nt] = j;
+				nt++;
+			}
+		}
+		if (nt != 0) {
+			preidx = l[GenerateRnd(nt)];
+			goe = ItemPrefixes[preidx].PLGOE;
+			result.prefix = &ItemPrefixes[preidx];
+		}
+	}
+	if (allocateSuffix) {
+		int nl = 0;
+		for (int j = 0, n = static_cast<int>(ItemSuffixes.size()); j < n; ++j) {
+			if (IsSuffixValidForItemType(j, flgs, hellfireItem)
+			    && ItemSuffixes[j].PLMinLvl >= minlvl && ItemSuffixes[j].PLMinLvl <= maxlvl
+			    && !((goe == GOE_GOOD && ItemSuffixes[j].PLGOE == GOE_EVIL) || (goe == GOE_EVIL && ItemSuffixes[j].PLGOE == GOE_GOOD))
+			    && (!onlygood || ItemSuffixes[j].PLOk)) {
+				l[nl] = j;
+				nl++;
+			}
+		}
+		if (nl != 0) {
+			sufidx = l[GenerateRnd(nl)];
+			result.suffix = &ItemSuffixes[sufidx];
+		}
+	}
+	result.rngState = GetLCGEngineState();
+	return result;
+}
+
+AffixRoll IndexedPrefixAndSuffix(int minlvl, int maxlvl, AffixItemType flgs, bool onlygood, bool hellfireItem)
+{
+	AffixRoll result { nullptr, nullptr, 0 };
+	GetItemPowerPrefixAndSuffix(
+	    minlvl, maxlvl, flgs, onlygood, hellfireItem,
+	    [&result](const PLStruct &prefix) { result.prefix = &prefix; },
+	    [&result](const PLStruct &suffix) { result.suffix = &suffix; });
+	result.rngState = GetLCGEngineState();
+	return result;
+}
+
+class ItemAffixesTest : public ::testing::Test {
+public:
+	static void SetUpTestSuite()
+	{
+		LoadItemData();
+	}
+};
+
+TEST_F(ItemAffixesTest, CandidatesAreSortedByLevel)
+{
+	for (bool hellfireItem : { false, true }) {
+		for (uint8_t flgs = 0; flgs < 64; ++flgs) {
+			const std::vector<AffixCandidate> &prefixes = GetPrefixCandidates(static_cast<AffixItemType>(flgs), hellfireItem);
+			for (size_t i = 1; i < prefixes.size(); ++i) {
+				ASSERT_LE(prefixes[i - 1].minLvl, prefixes[i].minLvl);
+				if (prefixes[i - 1].minLvl == prefixes[i].minLvl)
+					ASSERT_LT(prefixes[i - 1].id, prefixes[i].id);
+			}
+			size_t numValid = 0;
+			for (int i = 0; i < static_cast<int>(ItemPrefixes.size()); ++i) {
+				if (IsPrefixValidForItemType(i, static_cast<AffixItemType>(flgs), hellfireItem))
+					++numValid;
+			}
+			EXPECT_EQ(prefixes.size(), numValid);
+		}
+	}
+}
+
+TEST_F(ItemAffixesTest, SeedSweepMatchesLinearScan)
+{
+	const AffixItemType itemTypes[] = {
+		AffixItemType::Misc,
+		AffixItemType::Bow,
+		AffixItemType::Staff,
+		AffixItemType::Weapon,
+		AffixItemType::Shield,
+		AffixItemType::Armor,
+		AffixItemType::Weapon | AffixItemType::Bow,
+	};
+	for (bool hellfireItem : { false, true }) {
+		for (AffixItemType flgs : itemTypes) {
+			for (int lvl = 0; lvl <= 60; lvl += 3) {
+				for (bool onlygood : { false, true }) {
+					for (uint32_t seed = 0; seed < 200; ++seed) {
+						const uint32_t rndSeed = seed * 2654435761U + lvl;
+						SetRndSeed(rndSeed);
+						const AffixRoll expected = ReferencePrefixAndSuffix(lvl / 2, lvl, flgs, onlygood, hellfireItem);
+						SetRndSeed(rndSeed);
+						const AffixRoll actual = IndexedPrefixAndSuffix(lvl / 2, lvl, flgs, onlygood, hellfireItem);
+						ASSERT_TRUE(actual == expected) << "seed " << rndSeed << " lvl " << lvl << " flgs " << static_cast<int>(flgs);
+					}
+				}
+			}
+		}
+	}
+}
+
+} // namespace
@@ -0,0 +1,106 @@
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "utils/language.h"
+#include "utils/paths.h"
+
+namespace devilution {
+namespace {
+
+class LanguageTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		paths::SetAssetsPath(paths::BasePath() + "/test/fixtures/translations/");
+		// Loads test/fixtures/translations/test.mo, see test.po for its source.
+		forceLocale = "test";
+		LanguageInitialize();
+	}
+
+	void TearDown() override
+	{
+		forceLocale = "en";
+		LanguageInitialize();
+		forceLocale = "";
+	}
+};
+
+std::string_view TranslateHello()
+{
+	return _("Hello");
+}
+
+TEST_F(LanguageTest, Translate)
+{
+	EXPECT_EQ(LanguageTranslate("Hello"), "Hallo");
+	EXPECT_EQ(LanguageTranslate("Fire"), "Brand");
+	EXPECT_EQ(LanguageTranslate("Fir"), "Fir");
+	EXPECT_EQ(LanguageTranslate("Fireball"), "Fireball");
+	EXPECT_EQ(LanguageTranslate(""), "");
+	EXPECT_EQ(LanguageTranslate(std::string("Hello")), "Hallo");
+}
+
+TEST_F(LanguageTest, TranslationsAreNullTerminated)
+{
+	const std::string_view translation = LanguageTranslate("Hello");
+	EXPECT_EQ(translation.data()[translation.size()], '\0');
+}
+
+TEST_F(LanguageTest, ParticularTranslate)
+{
+	EXPECT_EQ(LanguageParticularTranslate("spell", "Fire"), "Feuer");
+	EXPECT_EQ(LanguageParticularTranslate("spell", "Fireball"), "Feuerball");
+	EXPECT_EQ(LanguageParticularTranslate("spellbook", "Level {:d}"), "Stufe {:d}");
+	EXPECT_EQ(LanguageParticularTranslate("spell", "Level {:d}"), "Level {:d}");
+	EXPECT_EQ(LanguageParticularTranslate("spel", "lFire"), "lFire");
+	EXPECT_EQ(LanguageParticularTranslate("", "Fire"), "Fire");
+	EXPECT_EQ(LanguageParticularTranslate("spell", "Hello"), "Hello");
+}
+
+TEST_F(LanguageTest, PluralTranslate)
+{
+	EXPECT_EQ(LanguagePluralTranslate("{:d} apple", "{:d} apples", 1), "{:d} Apfel");
+	EXPECT_EQ(LanguagePluralTranslate("{:d} apple", "{:d} apples", 2), "{:d} Äpfel");
+	EXPECT_EQ(LanguagePluralTranslate("{:d} pear", "{:d} pears", 1), "{:d} pear");
+	EXPECT_EQ(LanguagePluralTranslate("{:d} pear", "{:d} pears", 2), "{:d} pears");
+	// Entries without plural forms only have a translation for the singular
+	EXPECT_EQ(LanguagePluralTranslate("Hello", "Hellos", 1), "Hallo");
+	EXPECT_EQ(LanguagePluralTranslate("Hello", "Hellos", 2), "Hellos");
+}
+
+TEST_F(LanguageTest, CachedTranslationsFollowLanguageChanges)
+{
+	EXPECT_EQ(TranslateHello(), "Hallo");
+	EXPECT_EQ(TranslateHello(), "Hallo");
+
+	forceLocale = "en";
+	LanguageInitialize();
+	EXPECT_EQ(TranslateHello(), "Hello");
+
+	forceLocale = "test";
+	LanguageInitialize();
+	EXPECT_EQ(TranslateHello(), "Hallo");
+}
+
+TEST_F(LanguageTest, CachedTranslationsFollowChangedKeys)
+{
+	char buffer[8] = "Hello";
+	EXPECT_EQ(_(buffer), "Hallo");
+	buffer[4] = '\0';
+	EXPECT_EQ(_(buffer), "Hell");
+
+	const char *keys[] = { "Hello", "Fire" };
+	std::string translations;
+	for (const char *key : keys)
+		translations.append(_(key));
+	EXPECT_EQ(translations, "HalloBrand");
+
+	EXPECT_EQ(pgettext("spell", "Fire"), "Feuer");
+	const std::string spell = "Fireball";
+	EXPECT_EQ(pgettext("spell", spell), "Feuerball");
+}
+
+} // namespace
+} // namespace devilution
@@ -0,0 +1,252 @@
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <sol/sol.hpp>
+
+#include "engine/random.hpp"
+#include "lighting.h"
+#include "lua/game_events.hpp"
+#include "lua/lua.hpp"
+#include "missiles.h"
+#include "player.h"
+#include "utils/algorithm/container.hpp"
+
+namespace devilution {
+namespace {
+
+class LuaTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		LuaInitialize();
+	}
+
+	void TearDown() override
+	{
+		LuaShutdown();
+	}
+
+	static sol::environment RunUntrusted(std::string_view code)
+	{
+		sol::environment env = CreateUntrustedLuaSandbox();
+		const sol::protected_function_result result = GetLuaState().safe_script(code, env, sol::script_pass_on_error);
+		EXPECT_TRUE(result.valid());
+		return env;
+	}
+};
+
+TEST_F(LuaTest, RunawayHandlerIsDisabled)
+{
+	sol::environment env = RunUntrusted(R"lua(
+local events = require("devilutionx.events")
+events.registerCustom("Runaway")
+calls = 0
+events.Runaway.add(function() while true do end end)
+events.Runaway.add(function() calls = calls + 1 end)
+)lua");
+
+	LuaEvent("Runaway");
+	LuaEvent("Runaway");
+	EXPECT_EQ(env.get<int>("calls"), 2);
+
+	const std::vector<LuaEventHandlerStats> stats = GetLuaEventHandlerStats();
+	ASSERT_EQ(stats.size(), 2U);
+	EXPECT_EQ(c_count_if(stats, [](const LuaEventHandlerStats &handler) { return handler.disabled; }), 1);
+	for (const LuaEventHandlerStats &handler : stats) {
+		EXPECT_EQ(handler.calls, handler.disabled ? 1U : 2U);
+		EXPECT_LE(handler.maxTime, handler.totalTime);
+	}
+}
+
+TEST_F(LuaTest, RunawayHandlerCannotCatchBudgetError)
+{
+	RunUntrusted(R"lua(
+local events = require("devilutionx.events")
+events.registerCustom("Runaway")
+events.Runaway.add(function()
+  while true do
+    pcall(function() while true do end end)
+  end
+end)
+)lua");
+
+	LuaEvent("Runaway");
+	LuaEvent("Runaway");
+
+	const std::vector<LuaEventHandlerStats> stats = GetLuaEventHandlerStats();
+	ASSERT_EQ(stats.size(), 1U);
+	EXPECT_TRUE(stats[0].disabled);
+	EXPECT_EQ(stats[0].calls, 1U);
+}
+
+TEST_F(LuaTest, FailingHandlerStaysEnabled)
+{
+	sol::environment env = RunUntrusted(R"lua(
+local events = require("devilutionx.events")
+events.registerCustom("Failing")
+calls = 0
+events.Failing.add(function() calls = calls + 1; error("failed") end)
+)lua");
+
+	LuaEvent("Failing");
+	LuaEvent("Failing");
+	EXPECT_EQ(env.get<int>("calls"), 2);
+
+	const std::vector<LuaEventHandlerStats> stats = GetLuaEventHandlerStats();
+	ASSERT_EQ(stats.size(), 1U);
+	EXPECT_FALSE(stats[0].disabled);
+}
+
+TEST_F(LuaTest, RunawayScriptIsStoppedAndUnloaded)
+{
+	EXPECT_FALSE(LuaLoadUntrustedScript("runaway", R"lua(
+local events = require("devilutionx.events")
+events.MissileAdded.add(function() end)
+while true do end
+)lua"));
+	EXPECT_FALSE(HasLuaGameEventHandlers(LuaGameEvent::MissileAdded));
+
+	// The budget only applies to the top-level chunk, later scripts and handlers run normally.
+	EXPECT_TRUE(LuaLoadUntrustedScript("other", R"lua(require("devilutionx.events").MissileAdded.add(function() end))lua"));
+	EXPECT_TRUE(HasLuaGameEventHandlers(LuaGameEvent::MissileAdded));
+}
+
+TEST_F(LuaTest, UnloadingScriptRemovesItsHandlers)
+{
+	ASSERT_TRUE(LuaLoadUntrustedScript("first", R"lua(
+local events = require("devilutionx.events")
+events.registerCustom("Custom")
+events.Custom.add(function() end)
+events.MissileAdded.add(function() end)
+)lua"));
+	ASSERT_TRUE(LuaLoadUntrustedScript("second", R"lua(
+require("devilutionx.events").Custom.add(function() end)
+)lua"));
+
+	LuaEvent("Custom");
+	EXPECT_EQ(GetLuaEventHandlerStats().size(), 2U);
+
+	LuaUnloadUntrustedScript("first");
+	EXPECT_FALSE(HasLuaGameEventHandlers(LuaGameEvent::MissileAdded));
+	LuaEvent("Custom");
+	const std::vector<LuaEventHandlerStats> stats = GetLuaEventHandlerStats();
+	ASSERT_EQ(stats.size(), 1U);
+	EXPECT_EQ(stats[0].name, "second:2");
+	EXPECT_EQ(stats[0].calls, 2U);
+
+	LuaUnloadUntrustedScript("second");
+	EXPECT_TRUE(GetLuaEventHandlerStats().empty());
+}
+
+TEST_F(LuaTest, UntrustedSandboxRestrictsLibraries)
+{
+	sol::environment untrusted = CreateUntrustedLuaSandbox();
+	for (const char *global : { "os", "debug", "coroutine", "rawequal", "rawget", "rawset", "setmetatable" }) {
+		EXPECT_EQ(untrusted[global].get_type(), sol::type::lua_nil) << global;
+	}
+	EXPECT_EQ(untrusted["string"].get_type(), sol::type::table);
+	EXPECT_EQ(CreateLuaSandbox()["os"].get_type(), sol::type::table);
+
+	// A runaway finalizer would run outside of any budget
+	const sol::protected_function_result result = GetLuaState().safe_script(
+	    R"lua(setmetatable({}, { __gc = function() while true do end end }))lua", untrusted, sol::script_pass_on_error);
+	EXPECT_FALSE(result.valid());
+}
+
+TEST_F(LuaTest, RecordedDrawCommandsAreCapped)
+{
+	sol::environment env = RunUntrusted(R"lua(
+local render = require("devilutionx.render")
+recorded = 0
+for i = 1, 5000 do
+  if render.rect(0, 0, 1, 1, 1) then recorded = recorded + 1 end
+end
+render.clear()
+recordedAfterClear = render.line(0, 0, 1, 1, 1)
+)lua");
+
+	EXPECT_EQ(env.get<int>("recorded"), 4096);
+	EXPECT_TRUE(env.get<bool>("recordedAfterClear"));
+}
+
+struct MissileOutcome {
+	MissileID type;
+	WorldTilePosition position;
+	int damage;
+	int rnd;
+	int animFrame;
+
+	bool operator==(const MissileOutcome &other) const = default;
+};
+
+/** @brief Creates a few missiles that consume random numbers and records what came out. */
+std::vector<MissileOutcome> SimulateMissiles(uint32_t &rngState)
+{
+	Players.resize(1);
+	MyPlayerId = 0;
+	MyPlayer = &Players[MyPlayerId];
+	*MyPlayer = {};
+	MyPlayer->_pMagic = 60;
+	LoadMissileData();
+	InitLighting();
+	Missiles.clear();
+	SetRndSeed(42);
+
+	std::vector<MissileOutcome> outcome;
+	for (int i = 0; i < 8; i++) {
+		const Missile *missile = AddMissile({ 10, 10 }, { 20, 10 + i }, Direction::South, MissileID::ChargedBolt, TARGET_MONSTERS, *MyPlayer, 0, 0);
+		EXPECT_NE(missile, nullptr);
+		if (missile != nullptr)
+			outcome.push_back({ missile->_mitype, missile->position.tile, missile->_midam, missile->_mirnd, missile->_miAnimFrame });
+	}
+	rngState = GetLCGEngineState();
+	Missiles.clear();
+	return outcome;
+}
+
+TEST_F(LuaTest, GameEventsAreOnlyDispatchedWithHandlers)
+{
+	EXPECT_FALSE(HasLuaGameEventHandlers(LuaGameEvent::MissileAdded));
+
+	sol::environment env = RunUntrusted(R"lua(
+local events = require("devilutionx.events")
+handler = function() end
+events.MissileAdded.add(handler)
+)lua");
+	EXPECT_TRUE(HasLuaGameEventHandlers(LuaGameEvent::MissileAdded));
+	EXPECT_FALSE(HasLuaGameEventHandlers(LuaGameEvent::MonsterKilled));
+
+	GetLuaState().safe_script(R"lua(require("devilutionx.events").MissileAdded.remove(handler))lua", env);
+	EXPECT_FALSE(HasLuaGameEventHandlers(LuaGameEvent::MissileAdded));
+}
+
+TEST_F(LuaTest, ObservingHandlersKeepSimulationDeterministic)
+{
+	uint32_t expectedRngState;
+	const std::vector<MissileOutcome> expected = SimulateMissiles(expectedRngState);
+
+	sol::environment env = RunUntrusted(R"lua(
+local events = require("devilutionx.events")
+seen = 0
+writable = false
+events.MissileAdded.add(function(missile)
+  seen = seen + 1
+  local _ = missile.type + missile.caster + missile.source + missile.x + missile.y + missile.damage + missile.spellLevel
+  if pcall(function() missile.damage = 1000 end) then
+    writable = true
+  end
+  math.random()
+end)
+)lua");
+
+	uint32_t rngState;
+	const std::vector<MissileOutcome> observed = SimulateMissiles(rngState);
+	EXPECT_EQ(env.get<int>("seen"), static_cast<int>(expected.size()));
+	EXPECT_FALSE(env.get<bool>("writable"));
+	EXPECT_EQ(rngState, expectedRngState);
+	EXPECT_EQ(observed, expected);
+}
+
+} // namespace
+} // namespace devilution
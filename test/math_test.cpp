@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include "engine/displacement.hpp"
+#include "engine/point.hpp"
 
 namespace devilution {
 
@@ -32,15 +33,15 @@ TEST(MathTest, NormalizeDisplacement)
 {
 	// Normalizing displacements transforms the value into 16 bit fixed point representations
 	Displacement vector { 5, 0 };
-	EXPECT_FLOAT_EQ(vector.magnitude(), 5);
+	EXPECT_EQ(Point(0, 0).ExactDistance(Point(0, 0) + vector), 5);
 	EXPECT_EQ(vector.normalized(), Displacement(1 << 16, 0)); // (1.0, 0.0)
 
 	vector = { 3, 4 };
-	EXPECT_FLOAT_EQ(vector.magnitude(), 5);
+	EXPECT_EQ(Point(0, 0).ExactDistance(Point(0, 0) + vector), 5);
 	EXPECT_EQ(vector.normalized(), Displacement(39321, 52428)); // ~(0.6, 0.8)
 
 	vector = { -5, 2 };
-	EXPECT_FLOAT_EQ(vector.magnitude(), 5.3851647f);
+	EXPECT_EQ(Point(0, 0).ExactDistance(Point(0, 0) + vector), 5); // ~5.385
 	EXPECT_EQ(vector.normalized(), Displacement(-60848, 24339)); // ~(-0.92, 0.37)
 }
 
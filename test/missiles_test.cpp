@@ -1,7 +1,11 @@
+#include <random>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "engine/path.h"
 #include "engine/random.hpp"
+#include "levels/gendung.h"
 #include "missiles.h"
 
 using namespace devilution;
@@ -147,3 +151,81 @@ TEST(Missiles, GetDirection16)
 
 	EXPECT_EQ(Direction16::South_SouthWest, GetDirection16({ 0, 0 }, { 0, 0 })) << "GetDirection16 is expected to default to Direction16::South_SouthWest when the points occupy the same tile";
 }
+
+namespace {
+
+/** @brief The tile by tile search FindClosest used before it was sorting monster positions instead. */
+Monster *FindClosestByCrawl(Point source, int rad)
+{
+	const auto checkBlock = [](Point from, Point to) {
+		while (from != to) {
+			from += GetDirection(from, to);
+			if (TileHasAny(dPiece[from.x][from.y], TileProperties::Solid))
+				return true;
+		}
+		return false;
+	};
+	std::optional<Point> monsterPosition = FindClosestValidPosition(
+	    [&](Point target) {
+		    return InDungeonBounds(target) && dMonster[target.x][target.y] > 0 && !checkBlock(source, target);
+	    },
+	    source, 1, rad);
+	if (!monsterPosition)
+		return nullptr;
+	return &Monsters[dMonster[monsterPosition->x][monsterPosition->y] - 1];
+}
+
+} // namespace
+
+TEST(Missiles, FindClosestMatchesCrawl)
+{
+	std::mt19937 rng(12345);
+	const auto random = [&rng](int min, int max) { return std::uniform_int_distribution<int>(min, max)(rng); };
+
+	SOLData[1] = TileProperties::Solid;
+	for (int round = 0; round < 200; round++) {
+		memset(dMonster, 0, sizeof(dMonster));
+		for (auto &column : dPiece) {
+			for (uint16_t &piece : column)
+				piece = random(0, 9) == 0 ? 1 : 0;
+		}
+
+		// Cluster the monsters around the middle so most searches have several candidates at the same distance
+		ActiveMonsterCount = random(0, MaxMonsters);
+		for (size_t i = 0; i < ActiveMonsterCount; i++) {
+			ActiveMonsters[i] = static_cast<int>(i);
+			Monster &monster = Monsters[i];
+			const Point tile { random(20, 90), random(20, 90) };
+			const Point neighbour = tile + static_cast<Direction>(random(0, 7));
+			monster.position.tile = tile;
+			monster.position.old = tile;
+			monster.position.future = tile;
+			switch (random(0, 2)) {
+			case 0:
+				monster.occupyTile(tile, false);
+				break;
+			case 1: // walking away from its tile
+				monster.position.future = neighbour;
+				monster.occupyTile(tile, false);
+				monster.occupyTile(neighbour, true);
+				break;
+			default: // walking into the future tile
+				monster.position.future = neighbour;
+				monster.occupyTile(tile, true);
+				monster.occupyTile(neighbour, false);
+				break;
+			}
+		}
+
+		for (int query = 0; query < 50; query++) {
+			const Point source { random(0, MAXDUNX - 1), random(0, MAXDUNY - 1) };
+			const int rad = random(1, 25);
+			EXPECT_EQ(TestFindClosest(source, rad), FindClosestByCrawl(source, rad)) << "source " << source.x << ":" << source.y << " radius " << rad;
+		}
+	}
+
+	memset(dMonster, 0, sizeof(dMonster));
+	memset(dPiece, 0, sizeof(dPiece));
+	SOLData[1] = TileProperties::None;
+	ActiveMonsterCount = 0;
+}
@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <optional>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "engine/random.hpp"
+#include "levels/gendung.h"
+#include "lighting.h"
+#include "objects.h"
+#include "player.h"
+
+namespace devilution {
+namespace {
+
+struct LightType {
+	_object_id type;
+	int radius;
+};
+
+constexpr std::array<LightType, 5> LightTypes { {
+    { OBJ_CANDLE2, 5 },
+    { OBJ_L5CANDLE, 3 },
+    { OBJ_TORCHL, 8 },
+    { OBJ_TORCHR2, 8 },
+    { OBJ_BCROSS, 5 },
+} };
+
+constexpr int NumLights = 24;
+
+/** @brief RndLocOk as it was before RndLocSampler. */
+bool RndLocOkByScan(Point p)
+{
+	if (dMonster[p.x][p.y] != 0)
+		return false;
+	if (dPlayer[p.x][p.y] != 0)
+		return false;
+	if (IsObjectAtPosition(p))
+		return false;
+	if (TileContainsSetPiece(p))
+		return false;
+	if (TileHasAny(dPiece[p.x][p.y], TileProperties::Solid))
+		return false;
+	return IsNoneOf(leveltype, DTYPE_CATHEDRAL, DTYPE_CRYPT) || dPiece[p.x][p.y] <= 125 || dPiece[p.x][p.y] >= 143;
+}
+
+bool IsAreaOkByScan(Rectangle rect)
+{
+	for (int y = rect.position.y; y < rect.position.y + rect.size.height; y++) {
+		for (int x = rect.position.x; x < rect.position.x + rect.size.width; x++) {
+			if (!RndLocOkByScan({ x, y }))
+				return false;
+		}
+	}
+	return true;
+}
+
+/** @brief GetRndObjLoc as it was before RndLocSampler. */
+Point GetRndObjLocByScan(int randarea)
+{
+	if (randarea == 0)
+		return { 0, 0 };
+
+	int tries = 0;
+	int x;
+	int y;
+	while (true) {
+		tries++;
+		if (tries > 1000 && randarea > 1)
+			randarea--;
+		x = GenerateRnd(MAXDUNX);
+		y = GenerateRnd(MAXDUNY);
+		if (IsAreaOkByScan(Rectangle { { x, y }, { randarea, randarea } }))
+			break;
+	}
+	return { x, y };
+}
+
+/** @brief GetRandomObjectPosition as it was before RndLocSampler. */
+std::optional<Point> GetRandomObjectPositionByScan(Displacement standoff)
+{
+	for (int i = 0; i <= 20000; i++) {
+		Point position = Point { GenerateRnd(80), GenerateRnd(80) } + Displacement { 16, 16 };
+		if (IsAreaOkByScan(Rectangle { position - standoff, Size { standoff.deltaX * 2 + 1, standoff.deltaY * 2 + 1 } }))
+			return position;
+	}
+	return {};
+}
+
+/**
+ * @brief Fills the level with a random mix of everything RndLocOk rejects, more of it the higher the density.
+ *
+ * Like on real levels the edge of the map is solid, so no candidate area reaches past it.
+ */
+void FillRandomLevel(std::mt19937 &rng, int density)
+{
+	const auto random = [&rng](int min, int max) { return std::uniform_int_distribution<int>(min, max)(rng); };
+
+	leveltype = random(0, 1) == 0 ? DTYPE_CATHEDRAL : DTYPE_CAVES;
+	memset(dMonster, 0, sizeof(dMonster));
+	memset(dPlayer, 0, sizeof(dPlayer));
+	memset(dObject, 0, sizeof(dObject));
+	memset(dFlags, 0, sizeof(dFlags));
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++) {
+			dPiece[x][y] = 0;
+			if (x >= MAXDUNX - 12 || y >= MAXDUNY - 12) {
+				dPiece[x][y] = 1;
+				continue;
+			}
+			if (random(0, 999) >= density)
+				continue;
+			switch (random(0, 5)) {
+			case 0:
+				dMonster[x][y] = 1;
+				break;
+			case 1:
+				dPlayer[x][y] = 1;
+				break;
+			case 2:
+				dObject[x][y] = 1;
+				break;
+			case 3:
+				dFlags[x][y] |= DungeonFlag::Populated;
+				break;
+			case 4:
+				dPiece[x][y] = 1;
+				break;
+			default:
+				dPiece[x][y] = random(126, 142);
+				break;
+			}
+		}
+	}
+}
+
+void ClearRandomLevel()
+{
+	memset(dMonster, 0, sizeof(dMonster));
+	memset(dPlayer, 0, sizeof(dPlayer));
+	memset(dObject, 0, sizeof(dObject));
+	memset(dFlags, 0, sizeof(dFlags));
+	memset(dPiece, 0, sizeof(dPiece));
+	SOLData[1] = TileProperties::None;
+}
+
+TEST(Objects, LightTrackerMatchesFullScan)
+{
+	std::mt19937 rng(4242);
+	const auto random = [&rng](int min, int max) { return std::uniform_int_distribution<int>(min, max)(rng); };
+	const auto randomTile = [&]() { return Point { random(0, MAXDUNX - 1), random(0, MAXDUNY - 1) }; };
+
+	currlevel = 2;
+	setlevel = false;
+	InitLighting();
+	memset(dObject, 0, sizeof(dObject));
+
+	std::array<int, NumLights> radius;
+	const auto placeLight = [&](int id) {
+		Object &object = Objects[id];
+		if (object._oVar1 == 1)
+			AddUnLight(object._olid);
+		dObject[object.position.x][object.position.y] = 0;
+		Point tile;
+		do {
+			tile = randomTile();
+		} while (dObject[tile.x][tile.y] != 0);
+		const LightType &lightType = LightTypes[random(0, static_cast<int>(LightTypes.size()) - 1)];
+		object = {};
+		object._otype = lightType.type;
+		object.position = tile;
+		object._olid = NO_LIGHT;
+		dObject[tile.x][tile.y] = id + 1;
+		radius[id] = lightType.radius;
+	};
+
+	ActiveObjectCount = NumLights;
+	for (int i = 0; i < NumLights; i++) {
+		ActiveObjects[i] = i;
+		Objects[i].position = { 0, 0 };
+		Objects[i]._oVar1 = 0;
+		placeLight(i);
+	}
+
+	// Players wander around the level, with the occasional teleport, level change or player joining and leaving.
+	// The full scan is checked after every tick.
+	const auto resetPlayer = [&](Player &player) {
+		player = {};
+		player.plractive = true;
+		player.plrlevel = currlevel;
+		player.position.tile = randomTile();
+	};
+	Players.resize(2);
+	for (Player &player : Players)
+		resetPlayer(player);
+	MyPlayer = &Players[0];
+
+	for (int tick = 0; tick < 5000; tick++) {
+		for (Player &player : Players) {
+			const int action = random(0, 199);
+			if (action < 150) {
+				const Point tile = player.position.tile + static_cast<Direction>(random(0, 7));
+				player.position.tile = { std::clamp(tile.x, 0, MAXDUNX - 1), std::clamp(tile.y, 0, MAXDUNY - 1) };
+			} else if (action < 153) {
+				player.position.tile = randomTile();
+			} else if (action < 155) {
+				player.plrlevel = player.plrlevel == currlevel ? currlevel + 1 : currlevel;
+			} else if (action < 156) {
+				player.plractive = !player.plractive;
+			}
+		}
+		if (random(0, 99) == 0) {
+			Players.resize(random(1, MAX_PLRS));
+			for (Player &player : Players) {
+				if (!player.plractive && player.plrlevel == 0)
+					resetPlayer(player);
+			}
+			MyPlayer = &Players[0];
+		}
+		if (random(0, 19) == 0)
+			placeLight(random(0, NumLights - 1));
+
+		ProcessObjects();
+		ProcessLightList();
+
+		for (int i = 0; i < NumLights; i++) {
+			const Object &object = Objects[i];
+			const bool visible = TestIsLightVisible(object, radius[i]);
+			ASSERT_EQ(object._oVar1, visible ? 1 : 0) << "tick " << tick << " light " << i << " at " << object.position.x << ":" << object.position.y;
+			if (visible) {
+				ASSERT_NE(object._olid, NO_LIGHT) << "tick " << tick << " light " << i;
+				EXPECT_FALSE(Lights[object._olid].isInvalid);
+			}
+		}
+	}
+
+	Players.clear();
+	MyPlayer = nullptr;
+	ActiveObjectCount = 0;
+	memset(dObject, 0, sizeof(dObject));
+	InitLighting();
+}
+
+TEST(Objects, GetRndObjLocMatchesScan)
+{
+	std::mt19937 rng(9001);
+	SOLData[1] = TileProperties::Solid;
+	// The denser levels reject enough candidates for RndLocSampler to switch to its map, the densest ones also make
+	// GetRndObjLoc shrink the area after 1000 tries.
+	for (int density = 0; density <= 350; density += 25) {
+		FillRandomLevel(rng, density);
+		for (int i = 0; i < 20; i++) {
+			const uint32_t levelSeed = static_cast<uint32_t>(rng());
+			const int randarea = i % 6;
+
+			SetRndSeed(levelSeed);
+			const Point expected = GetRndObjLocByScan(randarea);
+			const uint32_t expectedRngState = GetLCGEngineState();
+
+			SetRndSeed(levelSeed);
+			const Point actual = TestGetRndObjLoc(randarea);
+			ASSERT_EQ(actual, expected) << "density " << density << " seed " << levelSeed << " area " << randarea;
+			ASSERT_EQ(GetLCGEngineState(), expectedRngState) << "density " << density << " seed " << levelSeed << " area " << randarea;
+		}
+	}
+	ClearRandomLevel();
+}
+
+TEST(Objects, GetRandomObjectPositionMatchesScan)
+{
+	std::mt19937 rng(1337);
+	SOLData[1] = TileProperties::Solid;
+	for (int density = 0; density <= 500; density += 25) {
+		FillRandomLevel(rng, density);
+		for (int i = 0; i < 20; i++) {
+			const uint32_t levelSeed = static_cast<uint32_t>(rng());
+			const Displacement standoff { i % 3, (i / 3) % 3 };
+
+			SetRndSeed(levelSeed);
+			const std::optional<Point> expected = GetRandomObjectPositionByScan(standoff);
+			const uint32_t expectedRngState = GetLCGEngineState();
+
+			SetRndSeed(levelSeed);
+			const std::optional<Point> actual = TestGetRandomObjectPosition(standoff);
+			ASSERT_EQ(actual, expected) << "density " << density << " seed " << levelSeed;
+			ASSERT_EQ(GetLCGEngineState(), expectedRngState) << "density " << density << " seed " << levelSeed;
+		}
+	}
+	ClearRandomLevel();
+}
+
+} // namespace
+} // namespace devilution
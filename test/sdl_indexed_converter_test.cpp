@@ -0,0 +1,148 @@
+#include <cstring>
+
+#include <SDL.h>
+#include <gtest/gtest.h>
+
+#include "utils/sdl_indexed_converter.hpp"
+#include "utils/sdl_wrap.h"
+
+using namespace devilution;
+
+namespace {
+
+constexpr int Width = 37;
+constexpr int Height = 11;
+
+SDLSurfaceUniquePtr CreateIndexedSurface(SDL_Palette *palette, uint8_t seed)
+{
+	SDLSurfaceUniquePtr surface = SDLWrap::CreateRGBSurfaceWithFormat(0, Width, Height, 8, SDL_PIXELFORMAT_INDEX8);
+	for (int y = 0; y < Height; ++y) {
+		auto *row = static_cast<uint8_t *>(surface->pixels) + y * surface->pitch;
+		for (int x = 0; x < Width; ++x)
+			row[x] = static_cast<uint8_t>(x * 7 + y * 13 + seed);
+	}
+	SDL_SetSurfacePalette(surface.get(), palette);
+	return surface;
+}
+
+SDLPaletteUniquePtr CreatePalette(uint8_t seed)
+{
+	SDLPaletteUniquePtr palette = SDLWrap::AllocPalette();
+	SDL_Color colors[256];
+	for (int i = 0; i < 256; ++i) {
+		colors[i].r = static_cast<uint8_t>(i + seed);
+		colors[i].g = static_cast<uint8_t>(i * 3 + seed);
+		colors[i].b = static_cast<uint8_t>(255 - i);
+		colors[i].a = SDL_ALPHA_OPAQUE;
+	}
+	SDL_SetPaletteColors(palette.get(), colors, 0, 256);
+	return palette;
+}
+
+void ExpectSameAsSdlConversion(SDL_Surface *src, SDL_Surface *converted, Uint32 format)
+{
+	SDLSurfaceUniquePtr expected = SDLWrap::ConvertSurfaceFormat(src, format, 0);
+	ASSERT_EQ(converted->w, expected->w);
+	ASSERT_EQ(converted->h, expected->h);
+	const int rowSize = expected->w * expected->format->BytesPerPixel;
+	for (int y = 0; y < expected->h; ++y) {
+		const auto *expectedRow = static_cast<const uint8_t *>(expected->pixels) + y * expected->pitch;
+		const auto *actualRow = static_cast<const uint8_t *>(converted->pixels) + y * converted->pitch;
+		ASSERT_EQ(std::memcmp(expectedRow, actualRow, rowSize), 0) << "row " << y;
+	}
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 7)
+SDL_malloc_func RealMalloc;
+SDL_calloc_func RealCalloc;
+SDL_realloc_func RealRealloc;
+SDL_free_func RealFree;
+size_t NumAllocations;
+
+void *SDLCALL CountingMalloc(size_t size)
+{
+	++NumAllocations;
+	return RealMalloc(size);
+}
+
+void *SDLCALL CountingCalloc(size_t nmemb, size_t size)
+{
+	++NumAllocations;
+	return RealCalloc(nmemb, size);
+}
+
+void *SDLCALL CountingRealloc(void *mem, size_t size)
+{
+	++NumAllocations;
+	return RealRealloc(mem, size);
+}
+#endif
+
+} // namespace
+
+TEST(IndexedSurfaceConverter, MatchesSdlConvertSurface)
+{
+	SDLPaletteUniquePtr palette = CreatePalette(17);
+	SDLSurfaceUniquePtr src = CreateIndexedSurface(palette.get(), 3);
+
+	const Uint32 formats[] = { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_ABGR8888, SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_RGB24 };
+	for (Uint32 format : formats) {
+		SDLSurfaceUniquePtr formatSurface = SDLWrap::CreateRGBSurfaceWithFormat(0, 1, 1, 0, format);
+		IndexedSurfaceConverter converter;
+		SDL_Surface *converted = converter.Convert(src.get(), formatSurface->format);
+		ExpectSameAsSdlConversion(src.get(), converted, format);
+	}
+}
+
+TEST(IndexedSurfaceConverter, ReusesSurfaceAcrossFrames)
+{
+	SDLPaletteUniquePtr palette = CreatePalette(0);
+	SDLPaletteUniquePtr otherPalette = CreatePalette(99);
+	SDLSurfaceUniquePtr formatSurface = SDLWrap::CreateRGBSurfaceWithFormat(0, 1, 1, 0, SDL_PIXELFORMAT_ARGB8888);
+	SDLSurfaceUniquePtr frames[] = {
+		CreateIndexedSurface(palette.get(), 0),
+		CreateIndexedSurface(palette.get(), 1),
+		CreateIndexedSurface(otherPalette.get(), 2),
+	};
+
+	IndexedSurfaceConverter converter;
+	SDL_Surface *first = converter.Convert(frames[0].get(), formatSurface->format);
+	ExpectSameAsSdlConversion(frames[0].get(), first, SDL_PIXELFORMAT_ARGB8888);
+
+#if SDL_VERSION_ATLEAST(2, 0, 7)
+	SDL_GetMemoryFunctions(&RealMalloc, &RealCalloc, &RealRealloc, &RealFree);
+	SDL_SetMemoryFunctions(CountingMalloc, CountingCalloc, CountingRealloc, RealFree);
+	NumAllocations = 0;
+#endif
+	for (int i = 0; i < 30; ++i) {
+		SDL_Surface *converted = converter.Convert(frames[i % 3].get(), formatSurface->format);
+		EXPECT_EQ(converted, first);
+	}
+#if SDL_VERSION_ATLEAST(2, 0, 7)
+	SDL_SetMemoryFunctions(RealMalloc, RealCalloc, RealRealloc, RealFree);
+	EXPECT_EQ(NumAllocations, 0);
+#endif
+	EXPECT_EQ(converter.SurfaceAllocations(), 1);
+
+	for (const SDLSurfaceUniquePtr &frame : frames) {
+		ExpectSameAsSdlConversion(frame.get(), converter.Convert(frame.get(), formatSurface->format), SDL_PIXELFORMAT_ARGB8888);
+	}
+}
+
+TEST(IndexedSurfaceConverter, RecreatesSurfaceOnFormatChange)
+{
+	SDLPaletteUniquePtr palette = CreatePalette(5);
+	SDLSurfaceUniquePtr src = CreateIndexedSurface(palette.get(), 0);
+	SDLSurfaceUniquePtr argb = SDLWrap::CreateRGBSurfaceWithFormat(0, 1, 1, 0, SDL_PIXELFORMAT_ARGB8888);
+	SDLSurfaceUniquePtr rgb565 = SDLWrap::CreateRGBSurfaceWithFormat(0, 1, 1, 0, SDL_PIXELFORMAT_RGB565);
+
+	IndexedSurfaceConverter converter;
+	converter.Convert(src.get(), argb->format);
+	converter.Convert(src.get(), argb->format);
+	EXPECT_EQ(converter.SurfaceAllocations(), 1);
+	ExpectSameAsSdlConversion(src.get(), converter.Convert(src.get(), rgb565->format), SDL_PIXELFORMAT_RGB565);
+	EXPECT_EQ(converter.SurfaceAllocations(), 2);
+	converter.Reset();
+	converter.Convert(src.get(), rgb565->format);
+	EXPECT_EQ(converter.SurfaceAllocations(), 3);
+}
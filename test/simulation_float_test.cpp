@@ -0,0 +1,106 @@
+#include <fstream>
+#include <iterator>
+#include <regex>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace devilution {
+namespace {
+
+/**
+ * @brief Translation units that run as part of the game logic and have to produce the same results on every build,
+ * along with their headers and the headers of the types they compute with.
+ *
+ * Floating point results depend on the compiler and its flags, use integers or SoftFloat instead.
+ */
+constexpr const char *SimulationSources[] = {
+	"dead.cpp",
+	"dead.h",
+	"engine/actor_position.cpp",
+	"engine/actor_position.hpp",
+	"engine/direction.hpp",
+	"engine/displacement.hpp",
+	"engine/path.cpp",
+	"engine/path.h",
+	"engine/point.hpp",
+	"engine/random.cpp",
+	"engine/random.hpp",
+	"engine/rectangle.hpp",
+	"engine/size.hpp",
+	"engine/world_tile.hpp",
+	"inv.cpp",
+	"inv.h",
+	"items.cpp",
+	"items.h",
+	"levels/crypt.cpp",
+	"levels/crypt.h",
+	"levels/drlg_l1.cpp",
+	"levels/drlg_l1.h",
+	"levels/drlg_l2.cpp",
+	"levels/drlg_l2.h",
+	"levels/drlg_l3.cpp",
+	"levels/drlg_l3.h",
+	"levels/drlg_l4.cpp",
+	"levels/drlg_l4.h",
+	"levels/gendung.cpp",
+	"levels/gendung.h",
+	"levels/setmaps.cpp",
+	"levels/setmaps.h",
+	"levels/themes.cpp",
+	"levels/themes.h",
+	"levels/town.cpp",
+	"levels/town.h",
+	"levels/trigs.cpp",
+	"levels/trigs.h",
+	"lighting.cpp",
+	"lighting.h",
+	"missiles.cpp",
+	"missiles.h",
+	"monster.cpp",
+	"monster.h",
+	"msg.cpp",
+	"msg.h",
+	"objects.cpp",
+	"objects.h",
+	"pack.cpp",
+	"pack.h",
+	"player.cpp",
+	"player.h",
+	"portal.cpp",
+	"portal.h",
+	"quests.cpp",
+	"quests.h",
+	"spells.cpp",
+	"spells.h",
+	"sync.cpp",
+	"sync.h",
+	"towners.cpp",
+	"towners.h",
+	"utils/math.h",
+	"utils/soft_float.hpp",
+};
+
+/** @brief Blanks out comments and string literals so they can't trigger false positives. */
+std::string StripCommentsAndStrings(const std::string &source)
+{
+	static const std::regex CommentsAndStrings(R"(//[^\n]*|/\*[\s\S]*?\*/|"(\\.|[^"\\\n])*"|'(\\.|[^'\\\n])*')");
+	return std::regex_replace(source, CommentsAndStrings, " ");
+}
+
+} // namespace
+
+TEST(SimulationFloatTest, SimulationSourcesDontUseFloatingPoint)
+{
+	static const std::regex FloatingPoint(R"(\b(float|double)\b|\b(sqrtf?|hypotf?|powf?|l?roundf?|floorf?|ceilf?|fmodf?)\s*\(|\b\d+\.\d*([eE][-+]?\d+)?[fF]?\b|\b\d+[eE][-+]?\d+\b)");
+	for (const char *source : SimulationSources) {
+		const std::string path = std::string(DEVILUTIONX_SOURCE_DIR "/") + source;
+		std::ifstream file(path);
+		ASSERT_TRUE(file.is_open()) << "Failed to open " << path;
+		const std::string code = StripCommentsAndStrings(std::string(std::istreambuf_iterator<char>(file), {}));
+		std::smatch match;
+		EXPECT_FALSE(std::regex_search(code, match, FloatingPoint)) << source << " uses floating point: " << match.str();
+	}
+}
+
+} // namespace devilution
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <cstdlib>
+
+#include <gtest/gtest.h>
+
+#include "engine/displacement.hpp"
+#include "utils/soft_float.hpp"
+
+namespace devilution {
+namespace {
+
+/** @brief Same FNV-1a as the desync check uses. */
+class Hasher {
+public:
+	void Add(int value)
+	{
+		uint32_t v = static_cast<uint32_t>(value);
+		for (int i = 0; i < 4; i++) {
+			hash_ = (hash_ ^ (v & 0xFF)) * 16777619;
+			v >>= 8;
+		}
+	}
+
+	[[nodiscard]] uint32_t value() const
+	{
+		return hash_;
+	}
+
+private:
+	uint32_t hash_ = 2166136261;
+};
+
+} // namespace
+
+TEST(SoftFloatTest, IntegerSqrt)
+{
+	EXPECT_EQ(math::IntegerSqrt(0), 0);
+	EXPECT_EQ(math::IntegerSqrt(1), 1);
+	EXPECT_EQ(math::IntegerSqrt(24), 4);
+	EXPECT_EQ(math::IntegerSqrt(25), 5);
+	EXPECT_EQ(math::IntegerSqrt(UINT64_MAX), 0xFFFFFFFF);
+}
+
+TEST(SoftFloatTest, RoundsLikeFloat)
+{
+	// 2^24 + 1 can't be represented and rounds to even, 2^24 + 3 rounds up
+	EXPECT_EQ(SoftFloat::FromInt((1 << 24) + 1).truncate(), 1 << 24);
+	EXPECT_EQ(SoftFloat::FromInt((1 << 24) + 3).truncate(), (1 << 24) + 4);
+	EXPECT_EQ((SoftFloat::FromInt(1) / SoftFloat::FromInt(3) * SoftFloat::FromInt(3)).truncate(), 1);
+	EXPECT_EQ((SoftFloat::FromInt(32 << 16) / SoftFloat::FromInt(3) * SoftFloat::FromInt(123)).truncate(), 85983232);
+	EXPECT_EQ(SoftFloat::FromInt(2).squareRoot().truncate(), 1);
+	EXPECT_EQ((SoftFloat::FromInt(2).squareRoot() * SoftFloat::FromInt(1 << 16)).truncate(), 92681);
+	EXPECT_EQ(SoftFloat::FromInt(0).squareRoot().truncate(), 0);
+}
+
+TEST(SoftFloatTest, MultiplyByTenthsLikeDouble)
+{
+	// The double factor for -9 is just below 0.1, so whole results come out one lower
+	EXPECT_EQ(MultiplyByTenthsLikeDouble(10, -9), 0);
+	EXPECT_EQ(MultiplyByTenthsLikeDouble(20, -9), 1);
+	EXPECT_EQ(MultiplyByTenthsLikeDouble(25, -9), 2);
+	EXPECT_EQ(MultiplyByTenthsLikeDouble(1000, 5), 1500);
+	EXPECT_EQ(MultiplyByTenthsLikeDouble(1000, -10), 0);
+	EXPECT_EQ(MultiplyByTenthsLikeDouble(1000, -20), 0);
+}
+
+TEST(SoftFloatTest, MultiplyByTenthsMatchesDouble)
+{
+#if FLT_EVAL_METHOD != 0
+	GTEST_SKIP() << "Doubles are evaluated with excess precision";
+#endif
+	// How experience was scaled by the level difference before, checked for every level difference a monster can have
+	const auto expected = [](uint32_t value, int tenths) {
+		return std::max<int64_t>(static_cast<int64_t>(value * (1 + tenths / 10.0)), 0);
+	};
+	int mismatches = 0;
+	for (int tenths = -12; tenths <= 600; tenths++) {
+		const auto check = [&](uint32_t value) {
+			if (MultiplyByTenthsLikeDouble(value, tenths) != expected(value, tenths) && mismatches++ < 10)
+				ADD_FAILURE() << value << " * (1 + " << tenths << " / 10.0)";
+		};
+		for (uint32_t value = 0; value < (1 << 14); value++)
+			check(value);
+		// The spacing of doubles changes at powers of two
+		for (int bits = 14; bits < 32; bits++) {
+			for (int offset = -64; offset <= 64; offset++)
+				check((1U << bits) + offset);
+		}
+		check(UINT32_MAX);
+	}
+	EXPECT_EQ(mismatches, 0);
+}
+
+TEST(SoftFloatTest, MissileVelocityScalingIsStable)
+{
+	// Expected value is what `static_cast<int>(delta * ((32 << 16) / static_cast<float>(denominator)))` gives with SSE floats
+	Hasher hasher;
+	for (int denominator = 1; denominator < (1 << 22); denominator += denominator / 16 + 1) {
+		const SoftFloat factor = SoftFloat::FromInt(32 << 16) / SoftFloat::FromInt(denominator);
+		for (int delta = -denominator; delta <= denominator; delta += denominator / 32 + 1) {
+			const int scaled = static_cast<int>((SoftFloat::FromInt(std::abs(delta)) * factor).truncate());
+			hasher.Add(delta < 0 ? -scaled : scaled);
+		}
+	}
+	EXPECT_EQ(hasher.value(), 0x78e9b0b4);
+}
+
+TEST(SoftFloatTest, NormalScreenVectorsAreStable)
+{
+	// Expected value is what the float implementation of normalized() gives with SSE floats
+	Hasher hasher;
+	for (int deltaY = -111; deltaY <= 111; deltaY++) {
+		for (int deltaX = -111; deltaX <= 111; deltaX++) {
+			if (deltaX == 0 && deltaY == 0)
+				continue;
+			const Displacement normal = Displacement(deltaX, deltaY).worldToNormalScreen();
+			hasher.Add(normal.deltaX);
+			hasher.Add(normal.deltaY);
+		}
+	}
+	EXPECT_EQ(hasher.value(), 0x76cf0898);
+}
+
+} // namespace devilution
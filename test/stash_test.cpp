@@ -0,0 +1,281 @@
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "itemdat.h"
+#include "pfile.h"
+#include "qol/stash.h"
+#include "qol/stash_search.h"
+#include "utils/paths.h"
+
+namespace devilution {
+namespace {
+
+void FillPage(StashStruct &stash, unsigned page, StashStruct::StashCell value)
+{
+	for (auto &column : stash.stashGrids[page]) {
+		column.fill(value);
+	}
+	stash.PageChanged(page);
+}
+
+std::optional<std::pair<unsigned, Point>> FindFreeAreaCellByCell(const StashStruct &stash, Size itemSize, unsigned startPage)
+{
+	for (unsigned pageCounter = 0; pageCounter < CountStashPages; pageCounter++) {
+		const unsigned page = (startPage + pageCounter) % CountStashPages;
+		const StashStruct::StashGrid *grid = stash.FindGrid(page);
+		for (int y = 0; y <= 10 - itemSize.height; y++) {
+			for (int x = 0; x <= 10 - itemSize.width; x++) {
+				bool isFree = true;
+				for (int dy = 0; dy < itemSize.height; dy++) {
+					for (int dx = 0; dx < itemSize.width; dx++) {
+						if (grid != nullptr && (*grid)[x + dx][y + dy] != 0)
+							isFree = false;
+					}
+				}
+				if (isFree)
+					return std::make_pair(page, Point { x, y });
+			}
+		}
+	}
+	return {};
+}
+
+TEST(StashTest, FindFreeAreaOnEmptyStash)
+{
+	StashStruct stash {};
+	stash.SetPage(42);
+
+	const auto freeArea = stash.FindFreeArea({ 2, 3 }, stash.GetPage());
+	ASSERT_TRUE(freeArea.has_value());
+	EXPECT_EQ(freeArea->first, 42U);
+	EXPECT_EQ(freeArea->second, Point(0, 0));
+	EXPECT_TRUE(stash.stashGrids.empty());
+	EXPECT_FALSE(stash.IsItemAtPosition({ 0, 0 }));
+	EXPECT_TRUE(stash.stashGrids.empty());
+}
+
+TEST(StashTest, FindFreeAreaWrapsAround)
+{
+	StashStruct stash {};
+	for (unsigned page = 1; page < CountStashPages; page++)
+		FillPage(stash, page, 1);
+	stash.stashGrids[0][0][0] = 1;
+	stash.PageChanged(0);
+
+	const auto freeArea = stash.FindFreeArea({ 1, 1 }, 50);
+	ASSERT_TRUE(freeArea.has_value());
+	EXPECT_EQ(freeArea->first, 0U);
+	EXPECT_EQ(freeArea->second, Point(1, 0));
+}
+
+TEST(StashTest, FindFreeAreaOnFullStash)
+{
+	StashStruct stash {};
+	for (unsigned page = 0; page < CountStashPages; page++)
+		FillPage(stash, page, 1);
+	// Only the last column of the last page is left free
+	for (auto &cell : stash.stashGrids[CountStashPages - 1][9])
+		cell = 0;
+	stash.PageChanged(CountStashPages - 1);
+
+	EXPECT_EQ(stash.FindFreeArea({ 1, 3 }, 7), std::make_pair(CountStashPages - 1, Point(9, 0)));
+	EXPECT_FALSE(stash.FindFreeArea({ 2, 1 }, 7).has_value());
+
+	FillPage(stash, CountStashPages - 1, 1);
+	for (int width = 1; width <= 2; width++) {
+		for (int height = 1; height <= 3; height++) {
+			EXPECT_FALSE(stash.FindFreeArea({ width, height }, 0).has_value());
+		}
+	}
+	EXPECT_EQ(stash.stashGrids.size(), CountStashPages);
+}
+
+TEST(StashTest, FailedSearchDoesNotCreatePages)
+{
+	StashStruct stash {};
+	FillPage(stash, 3, 1);
+
+	EXPECT_FALSE(stash.FindFreeArea({ 11, 1 }, 0).has_value());
+	const auto freeArea = stash.FindFreeArea({ 10, 10 }, 3);
+	ASSERT_TRUE(freeArea.has_value());
+	EXPECT_EQ(freeArea->first, 4U);
+	EXPECT_EQ(stash.stashGrids.size(), 1U);
+}
+
+TEST(StashTest, FindFreeAreaMatchesCellByCellSearch)
+{
+	std::mt19937 rng(1234);
+	StashStruct stash {};
+	for (int round = 0; round < 200; round++) {
+		const unsigned page = rng() % CountStashPages;
+		// Mostly fill pages so the search has to skip some of them
+		for (auto &column : stash.stashGrids[page]) {
+			for (StashStruct::StashCell &cell : column) {
+				cell = rng() % 8 == 0 ? 0 : 1;
+			}
+		}
+		stash.PageChanged(page);
+
+		const unsigned startPage = rng() % CountStashPages;
+		for (int width = 1; width <= 3; width++) {
+			for (int height = 1; height <= 4; height++) {
+				EXPECT_EQ(stash.FindFreeArea({ width, height }, startPage), FindFreeAreaCellByCell(stash, { width, height }, startPage));
+			}
+		}
+	}
+}
+
+class StashSearchTest : public ::testing::Test {
+public:
+	static void SetUpTestSuite()
+	{
+		LoadItemData();
+	}
+};
+
+Item MakeItem(_item_indexes id, ItemType type, item_quality quality = ITEM_QUALITY_NORMAL)
+{
+	Item item {};
+	item.IDidx = id;
+	item._itype = type;
+	item._iMagical = quality;
+	return item;
+}
+
+size_t SavedStashSize()
+{
+	Stash.dirty = true;
+	sfile_write_stash();
+	std::optional<SaveReader> archive = OpenStashArchive();
+	if (!archive)
+		return 0;
+	size_t size = 0;
+	ReadArchive(*archive, "spstashitems", &size);
+	return size;
+}
+
+TEST_F(StashSearchTest, FailedAutoPlaceDoesNotChangeSavedStash)
+{
+	paths::SetPrefPath(".");
+	std::remove("stash.sv");
+	gbIsMultiplayer = false;
+	gbIsHellfire = false;
+
+	Stash = {};
+	Stash.stashList = { MakeItem(IDI_HEAL, ItemType::Misc) };
+	for (unsigned page = 0; page < CountStashPages; page++)
+		FillPage(Stash, page, 1);
+	const size_t savedSize = SavedStashSize();
+	ASSERT_GT(savedSize, 0U);
+
+	Player player {};
+	EXPECT_FALSE(AutoPlaceItemInStash(player, MakeItem(IDI_HEAL, ItemType::Misc), true));
+	EXPECT_EQ(Stash.stashList.size(), 1U);
+	EXPECT_EQ(Stash.stashGrids.size(), CountStashPages);
+	EXPECT_EQ(SavedStashSize(), savedSize);
+
+	Stash = {};
+	std::remove("stash.sv");
+}
+
+TEST_F(StashSearchTest, FindMatchesAllCriteria)
+{
+	StashSearchIndex index;
+	Item sword = MakeItem(IDI_WARRIOR, ItemType::Sword);
+	sword._ivalue = 50;
+	sword._iMinStr = 18;
+	Item shield = MakeItem(IDI_WARRSHLD, ItemType::Shield, ITEM_QUALITY_MAGIC);
+	shield._iIdentified = true;
+	shield._iSufPower = IPL_FIRERES;
+	shield._iIvalue = 400;
+	Item hiddenShield = shield;
+	hiddenShield._iIdentified = false;
+	Item bow = MakeItem(IDI_ROGUE, ItemType::Bow);
+	bow._iMinDex = 40;
+	index.Update(0, sword, 5);
+	index.Update(1, shield, 2);
+	index.Update(2, hiddenShield, 7);
+	index.Update(3, bow, 2);
+
+	EXPECT_EQ(index.Find({}), (std::vector<uint16_t> { 1, 3, 0, 2 }));
+	EXPECT_EQ(index.Find({ .text = "SHORT" }), (std::vector<uint16_t> { 3, 0 }));
+	EXPECT_EQ(index.Find({ .type = ItemType::Shield }), (std::vector<uint16_t> { 1, 2 }));
+	EXPECT_EQ(index.Find({ .quality = ITEM_QUALITY_MAGIC, .affix = IPL_FIRERES }), (std::vector<uint16_t> { 1 }));
+	EXPECT_EQ(index.Find({ .maxStrength = 20, .maxDexterity = 30 }), (std::vector<uint16_t> { 1, 0, 2 }));
+	EXPECT_EQ(index.Find({ .maxStrength = 10 }), (std::vector<uint16_t> { 1, 3, 2 }));
+	EXPECT_EQ(index.Find({ .minValue = 100 }), (std::vector<uint16_t> { 1 }));
+	EXPECT_TRUE(index.Find({ .text = "axe" }).empty());
+	EXPECT_TRUE(index.Matches(3, { .text = "bow", .type = ItemType::Bow }));
+	EXPECT_FALSE(index.Matches(4, {}));
+}
+
+TEST_F(StashSearchTest, RemoveMovesLastEntry)
+{
+	StashSearchIndex index;
+	index.Update(0, MakeItem(IDI_WARRIOR, ItemType::Sword), 0);
+	index.Update(1, MakeItem(IDI_WARRSHLD, ItemType::Shield), 1);
+	index.Update(2, MakeItem(IDI_WARRCLUB, ItemType::Mace), 2);
+	const uint32_t generation = index.generation();
+
+	index.Remove(0);
+	EXPECT_NE(index.generation(), generation);
+	ASSERT_EQ(index.size(), 2U);
+	EXPECT_EQ(index.Find({ .type = ItemType::Mace }), (std::vector<uint16_t> { 0 }));
+	EXPECT_EQ(index.GetPage(0), 2U);
+	EXPECT_TRUE(index.Find({ .type = ItemType::Sword }).empty());
+
+	index.Remove(1);
+	EXPECT_EQ(index.Find({}), (std::vector<uint16_t> { 0 }));
+
+	// Replacing an entry, as happens when swapping items in the stash
+	index.Update(0, MakeItem(IDI_ROGUE, ItemType::Bow), 4);
+	EXPECT_EQ(index.Find({ .text = "bow" }), (std::vector<uint16_t> { 0 }));
+	EXPECT_EQ(index.GetPage(0), 4U);
+}
+
+TEST_F(StashSearchTest, RebuildFromStashGrids)
+{
+	StashStruct stash {};
+	stash.stashList = { MakeItem(IDI_WARRIOR, ItemType::Sword), MakeItem(IDI_WARRCLUB, ItemType::Mace) };
+	stash.stashGrids[9][0][0] = 1;
+	stash.stashGrids[9][0][1] = 1;
+	stash.stashGrids[3][4][4] = 2;
+
+	stash.RebuildSearchIndex();
+	ASSERT_EQ(stash.searchIndex.size(), 2U);
+	EXPECT_EQ(stash.searchIndex.GetPage(0), 9U);
+	EXPECT_EQ(stash.searchIndex.GetPage(1), 3U);
+	EXPECT_EQ(stash.searchIndex.Find({}), (std::vector<uint16_t> { 1, 0 }));
+}
+
+TEST_F(StashSearchTest, IdentifyingUpdatesIndex)
+{
+	Item unique = MakeItem(IDI_WARRIOR, ItemType::Sword, ITEM_QUALITY_UNIQUE);
+	unique._iCreateInfo = 1;
+	unique._iUid = 0;
+	unique._iIvalue = 1000;
+
+	StashStruct stash {};
+	stash.stashList = { unique };
+	stash.stashGrids[0][0][0] = 1;
+	stash.RebuildSearchIndex();
+
+	const StashSearchQuery byName { .text = std::string(UniqueItems[0].UIName) };
+	EXPECT_TRUE(stash.searchIndex.Find(byName).empty());
+	EXPECT_TRUE(stash.searchIndex.Find({ .minValue = 1000 }).empty());
+
+	stash.stashList[0]._iIdentified = true;
+	stash.ItemChanged(0);
+	EXPECT_EQ(stash.searchIndex.Find(byName), (std::vector<uint16_t> { 0 }));
+	EXPECT_EQ(stash.searchIndex.Find({ .minValue = 1000 }), (std::vector<uint16_t> { 0 }));
+	EXPECT_EQ(stash.searchIndex.GetPage(0), 0U);
+	EXPECT_TRUE(stash.dirty);
+}
+
+} // namespace
+} // namespace devilution
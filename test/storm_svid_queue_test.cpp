@@ -0,0 +1,124 @@
+#include <atomic>
+#include <cstring>
+
+#include <SDL.h>
+#include <gtest/gtest.h>
+
+#include "storm/storm_svid_queue.hpp"
+
+using namespace devilution;
+
+namespace {
+
+constexpr size_t FrameSize = 16;
+constexpr size_t AudioBufferSize = 64;
+constexpr double FrameLength = 1000000.0 / 15;
+
+/** Synthetic video where every pixel of a frame holds its frame number. */
+class TestFrameSource final : public SVidFrameSource {
+public:
+	explicit TestFrameSource(uint32_t numFrames)
+	    : numFrames_(numFrames)
+	{
+	}
+
+	bool DecodeNextFrame(SVidFrame &frame) override
+	{
+		if (numFrames_ != 0 && frame.sequence >= numFrames_)
+			return false;
+		decodedFrames++;
+		memset(frame.pixels.get(), static_cast<uint8_t>(frame.sequence), FrameSize);
+		if (frame.sequence % 3 == 0) {
+			frame.palette.fill(static_cast<uint8_t>(frame.sequence));
+			frame.paletteChanged = true;
+		}
+		if (frame.audio != nullptr) {
+			frame.audio[0] = static_cast<int16_t>(frame.sequence);
+			frame.audioLength = 2 * (frame.sequence % AudioBufferSize);
+		}
+		return true;
+	}
+
+	std::atomic<uint32_t> decodedFrames = 0;
+
+private:
+	uint32_t numFrames_;
+};
+
+} // namespace
+
+TEST(SVidDecodeQueue, FramesArriveInOrder)
+{
+	TestFrameSource source(20);
+	SVidDecodeQueue queue(source, 4, FrameSize, AudioBufferSize, FrameLength);
+	queue.Start();
+
+	for (uint32_t i = 0; i < 20; i++) {
+		SVidFrame *frame = queue.Front();
+		ASSERT_NE(frame, nullptr);
+		EXPECT_EQ(frame->sequence, i);
+		EXPECT_DOUBLE_EQ(frame->frameEnd, (i + 1) * FrameLength);
+		EXPECT_EQ(frame->pixels[0], i);
+		EXPECT_EQ(frame->pixels[FrameSize - 1], i);
+		EXPECT_EQ(frame->paletteChanged, i % 3 == 0);
+		if (frame->paletteChanged)
+			EXPECT_EQ(frame->palette[0], i);
+		EXPECT_EQ(frame->audio[0], static_cast<int16_t>(i));
+		EXPECT_EQ(frame->audioLength, 2 * i);
+		queue.Pop(/*presented=*/true);
+	}
+	EXPECT_EQ(queue.Front(), nullptr);
+	EXPECT_EQ(queue.PresentedFrames(), 20);
+	EXPECT_EQ(queue.DroppedFrames(), 0);
+}
+
+TEST(SVidDecodeQueue, CountsDroppedFrames)
+{
+	TestFrameSource source(10);
+	SVidDecodeQueue queue(source, 2, FrameSize, /*audioBufferSize=*/0, FrameLength);
+	queue.Start();
+
+	for (uint32_t i = 0; i < 10; i++) {
+		SVidFrame *frame = queue.Front();
+		ASSERT_NE(frame, nullptr);
+		EXPECT_EQ(frame->sequence, i);
+		EXPECT_EQ(frame->audio, nullptr);
+		EXPECT_EQ(frame->audioLength, 0);
+		queue.Pop(/*presented=*/i % 4 != 0);
+	}
+	EXPECT_EQ(queue.Front(), nullptr);
+	EXPECT_EQ(queue.PresentedFrames(), 7);
+	EXPECT_EQ(queue.DroppedFrames(), 3);
+}
+
+TEST(SVidDecodeQueue, DecodeAheadIsBounded)
+{
+	TestFrameSource source(100);
+	SVidDecodeQueue queue(source, 3, FrameSize, AudioBufferSize, FrameLength);
+	queue.Start();
+
+	ASSERT_NE(queue.Front(), nullptr);
+	SDL_Delay(50);
+	EXPECT_LE(source.decodedFrames, 3);
+
+	queue.Pop(/*presented=*/true);
+	ASSERT_NE(queue.Front(), nullptr);
+	SDL_Delay(50);
+	EXPECT_LE(source.decodedFrames, 4);
+}
+
+TEST(SVidDecodeQueue, StopsWhileLooping)
+{
+	TestFrameSource source(/*numFrames=*/0);
+	SVidDecodeQueue queue(source, 4, FrameSize, AudioBufferSize, FrameLength);
+	queue.Start();
+
+	for (uint32_t i = 0; i < 50; i++) {
+		SVidFrame *frame = queue.Front();
+		ASSERT_NE(frame, nullptr);
+		EXPECT_EQ(frame->sequence, i);
+		queue.Pop(/*presented=*/true);
+	}
+	queue.Stop();
+	EXPECT_EQ(queue.Front(), nullptr);
+}
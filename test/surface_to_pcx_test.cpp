@@ -0,0 +1,135 @@
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/pcx.hpp"
+#include "utils/surface_to_pcx.hpp"
+
+using namespace devilution;
+
+namespace {
+
+/** @brief The encoder that used to run on the game thread in capture.cpp. */
+uint8_t *ReferenceEncode(uint8_t *src, uint8_t *dst, int width)
+{
+	int rleLength;
+
+	do {
+		uint8_t rlePixel = *src;
+		src++;
+		rleLength = 1;
+
+		width--;
+
+		while (rlePixel == *src) {
+			if (rleLength >= 63)
+				break;
+			if (width == 0)
+				break;
+			rleLength++;
+
+			width--;
+			src++;
+		}
+
+		if (rleLength > 1 || rlePixel > 0xBF) {
+			*dst = rleLength | 0xC0;
+			dst++;
+		}
+
+		*dst = rlePixel;
+		dst++;
+	} while (width > 0);
+
+	return dst;
+}
+
+std::vector<uint8_t> ReferencePcx(const Surface &surface, const SDL_Color *palette)
+{
+	std::vector<uint8_t> result(sizeof(PCXHeader));
+	PCXHeader header;
+	memset(&header, 0, sizeof(header));
+	header.Manufacturer = 10;
+	header.Version = 5;
+	header.Encoding = 1;
+	header.BitsPerPixel = 8;
+	header.Xmax = SDL_SwapLE16(surface.w() - 1);
+	header.Ymax = SDL_SwapLE16(surface.h() - 1);
+	header.HDpi = SDL_SwapLE16(surface.w());
+	header.VDpi = SDL_SwapLE16(surface.h());
+	header.NPlanes = 1;
+	header.BytesPerLine = SDL_SwapLE16(surface.w());
+	memcpy(result.data(), &header, sizeof(header));
+
+	// One spare byte per row, the reference encoder reads one pixel past the end of the row.
+	const int width = surface.w();
+	std::vector<uint8_t> row(width + 1);
+	std::unique_ptr<uint8_t[]> buffer { new uint8_t[2 * width] };
+	for (int y = 0; y < surface.h(); y++) {
+		memcpy(row.data(), surface.at(0, y), width);
+		row[width] = row[width - 1];
+		uint8_t *end = ReferenceEncode(row.data(), buffer.get(), width);
+		result.insert(result.end(), buffer.get(), end);
+	}
+
+	result.push_back(12);
+	for (int i = 0; i < 256; i++) {
+		result.push_back(palette[i].r);
+		result.push_back(palette[i].g);
+		result.push_back(palette[i].b);
+	}
+	return result;
+}
+
+std::vector<uint8_t> EncodePcx(const Surface &surface, const SDL_Color *palette)
+{
+	FILE *file = std::tmpfile();
+	EXPECT_NE(file, nullptr);
+	EXPECT_TRUE(SurfaceToPcx(surface, palette, file));
+	std::vector<uint8_t> result(std::ftell(file));
+	std::rewind(file);
+	EXPECT_EQ(std::fread(result.data(), result.size(), 1, file), 1);
+	std::fclose(file);
+	return result;
+}
+
+void TestSurface(int width, int height, int maxRun, uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	OwnedSurface surface { width, height };
+	for (int y = 0; y < height; y++) {
+		uint8_t *row = surface.at(0, y);
+		for (int x = 0; x < width;) {
+			const uint8_t color = static_cast<uint8_t>(rng());
+			const int run = std::uniform_int_distribution<int>(1, maxRun)(rng);
+			for (int i = 0; i < run && x < width; i++, x++)
+				row[x] = color;
+		}
+	}
+	SDL_Color palette[256];
+	for (int i = 0; i < 256; i++)
+		palette[i] = { static_cast<uint8_t>(i), static_cast<uint8_t>(255 - i), static_cast<uint8_t>(i * 7), 0 };
+
+	EXPECT_EQ(EncodePcx(surface, palette), ReferencePcx(surface, palette)) << width << "x" << height << " runs up to " << maxRun;
+}
+
+TEST(SurfaceToPcx, MatchesReferenceEncoder)
+{
+	uint32_t seed = 0;
+	for (int width : { 1, 2, 3, 63, 64, 65, 127, 640, 641 }) {
+		for (int maxRun : { 1, 4, 70, 200 }) {
+			TestSurface(width, 7, maxRun, seed++);
+		}
+	}
+}
+
+TEST(SurfaceToPcx, MatchesReferenceEncoderAtScreenSize)
+{
+	TestSurface(1920, 1080, 80, 42);
+}
+
+} // namespace
@@ -0,0 +1,150 @@
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include <gtest/gtest.h>
+
+#include "drlg_test.hpp"
+#include "engine/random.hpp"
+#include "levels/trigs.h"
+#include "monster.h"
+
+using namespace devilution;
+
+namespace {
+
+constexpr uint32_t NumSeeds = 25;
+
+/**
+ * @brief Theme hashes of levels 1 to 15, one per level over seeds level * 1000 + 1 to level * 1000 + NumSeeds.
+ *
+ * Recorded with the implementation from before ThemeRegionMap, which scanned the whole map for every fit.
+ */
+constexpr std::array<uint32_t, 15> ExpectedThemeHashes = {
+	0x17FF5441, 0x9AE24686, 0xAABB260E, 0x3FBA9819, 0x6863F5A9,
+	0x12C06D33, 0x7E171748, 0x6ADF5B34, 0xA98CB8FD, 0xDDF3E758,
+	0x95BECAE4, 0xF20540EE, 0x496F3D4D, 0x97A0CD6E, 0xBFA05D22,
+};
+
+/**
+ * @brief The TIL and SOL files are not part of the fixtures, so the floor tile of each level type gets the micros 0 to 3
+ * and every other tile gets micros of its own.
+ */
+int GetFloorTile(dungeon_type levelType)
+{
+	switch (levelType) {
+	case DTYPE_CATHEDRAL:
+		return 13;
+	case DTYPE_CATACOMBS:
+		return 3;
+	case DTYPE_CAVES:
+		return 7;
+	case DTYPE_HELL:
+		return 6;
+	default:
+		return 0;
+	}
+}
+
+/** @brief Micros 0 to 3 are floor, all other micros are solid and some of them are also traps. */
+void SetTestSOLData()
+{
+	for (size_t i = 0; i < MAXTILES; i++) {
+		SOLData[i] = TileProperties::None;
+		if (i < 4)
+			continue;
+		SOLData[i] |= TileProperties::Solid;
+		if (i % 7 == 1)
+			SOLData[i] |= TileProperties::Trap;
+	}
+}
+
+void InitTriggers()
+{
+	switch (leveltype) {
+	case DTYPE_CATHEDRAL:
+		InitL1Triggers();
+		break;
+	case DTYPE_CATACOMBS:
+		InitL2Triggers();
+		break;
+	case DTYPE_CAVES:
+		InitL3Triggers();
+		break;
+	case DTYPE_HELL:
+		InitL4Triggers();
+		break;
+	default:
+		break;
+	}
+}
+
+/** @brief Hashes the themes InitThemes picks and where the theme objects of each fit, along with the random numbers used. */
+uint32_t HashThemes(int level, uint32_t seed)
+{
+	currlevel = level;
+	leveltype = GetLevelType(level);
+
+	LevelArena.reset();
+	const int tileCount = GetTileCount(leveltype);
+	pMegaTiles = LevelArena.allocate<MegaTile>(tileCount);
+	const int floorTile = GetFloorTile(leveltype);
+	for (int i = 0; i < tileCount; i++) {
+		const auto micro = static_cast<uint16_t>(i + 1 == floorTile ? 0 : (i + 1) * 4);
+		pMegaTiles[i] = { micro, static_cast<uint16_t>(micro + 1), static_cast<uint16_t>(micro + 2), static_cast<uint16_t>(micro + 3) };
+	}
+
+	CreateDungeon(seed, ENTRY_MAIN);
+	InitTriggers();
+	LevelMonsterTypeCount = 0;
+
+	SetRndSeed(seed);
+	InitThemes();
+
+	uint32_t hash = 2166136261U;
+	const auto add = [&hash](uint32_t value) {
+		hash = (hash ^ value) * 16777619U;
+	};
+	const auto addPosition = [&add](const std::optional<Point> &position) {
+		add(position ? position->x * 256 + position->y : 0xFFFF);
+	};
+	add(leveltype);
+	add(numthemes);
+	for (int i = 0; i < numthemes; i++) {
+		add(themes[i].ttval);
+		add(themes[i].ttype);
+		const ThemeFits fits = TestThemeFits(i);
+		addPosition(fits.shrine);
+		addPosition(fits.obj5);
+		addPosition(fits.obj3);
+	}
+	add(GetLCGEngineState());
+	return hash;
+}
+
+TEST(Themes, PlacementMatchesFullMapScan)
+{
+	paths::SetPrefPath(paths::BasePath());
+	paths::SetAssetsPath(paths::BasePath() + "/test/fixtures/");
+	TestInitGame();
+	SetTestSOLData();
+
+	for (int level = 1; level <= 15; level++) {
+		// Without the Warlord's set piece Hell almost never has room for a theme, so it is placed on every Hell level
+		if (GetLevelType(level) == DTYPE_HELL)
+			Quests[Q_WARLORD]._qlevel = level;
+		uint32_t hash = 2166136261U;
+		int themeCount = 0;
+		for (uint32_t seed = level * 1000U + 1; seed <= level * 1000U + NumSeeds; seed++) {
+			hash = (hash ^ HashThemes(level, seed)) * 16777619U;
+			themeCount += numthemes;
+		}
+		EXPECT_GT(themeCount, 0) << "level " << level;
+		EXPECT_EQ(hash, ExpectedThemeHashes[level - 1]) << "level " << level;
+	}
+
+	for (TileProperties &properties : SOLData)
+		properties = TileProperties::None;
+}
+
+} // namespace
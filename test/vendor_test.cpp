@@ -0,0 +1,171 @@
+#include <chrono>
+#include <iostream>
+#include <iterator>
+
+#include <gtest/gtest.h>
+
+#include "engine/random.hpp"
+#include "items.h"
+#include "player.h"
+#include "playerdat.hpp"
+#include "spells.h"
+#include "stores.h"
+
+using namespace devilution;
+
+namespace {
+
+constexpr int MaxCharacterLevel = 50;
+constexpr uint32_t VendorSeeds[] = { 1, 743271966, 1383137027, 2034738122 };
+
+/**
+ * @brief Hash of the vendor stock and RNG state over all character levels, one per seed in VendorSeeds.
+ *
+ * Recorded with the implementation that named every candidate before rejecting it.
+ */
+constexpr uint32_t ExpectedDiabloHashes[] = { 0xF584AB34, 0xB3BC9E7B, 0x15F4033F, 0x004D5693 };
+constexpr uint32_t ExpectedHellfireHashes[] = { 0xB13B8766, 0x3BDAB3C0, 0x97583768, 0x8A704655 };
+
+class VendorTest : public ::testing::Test {
+public:
+	void SetUp() override
+	{
+		Players.resize(1);
+		MyPlayer = &Players[0];
+		CreatePlayer(*MyPlayer, HeroClass::Warrior);
+		gbIsMultiplayer = false;
+		gbIsSpawn = false;
+	}
+
+	static void SetUpTestSuite()
+	{
+		LoadSpellData();
+		LoadPlayerDataFiles();
+		LoadItemData();
+	}
+};
+
+void RestockVendors(int lvl, uint32_t seed)
+{
+	MyPlayer->setCharacterLevel(lvl);
+
+	SetRndSeed(seed);
+	SpawnSmith(lvl);
+
+	for (Item &item : premiumitems)
+		item.clear();
+	numpremium = 0;
+	premiumlevel = lvl;
+	SpawnPremium(*MyPlayer);
+
+	SpawnWitch(lvl);
+
+	boyitem.clear();
+	boylevel = 0;
+	SpawnBoy(lvl);
+}
+
+/**
+ * @brief Vendors skip naming the candidates they reject, so check that what they keep matches a
+ * regular recreation of the same seed, which is what loading a save or a multiplayer sync does.
+ */
+void CheckRecreatedItem(const Item &item)
+{
+	if (item.isEmpty())
+		return;
+
+	Item recreated;
+	RecreateItem(*MyPlayer, recreated, item.IDidx, item._iCreateInfo, item._iSeed, item._ivalue, gbIsHellfire);
+	EXPECT_EQ(item.IDidx, recreated.IDidx) << "seed " << item._iSeed;
+	EXPECT_STREQ(item._iName, recreated._iName) << "seed " << item._iSeed;
+	EXPECT_STREQ(item._iIName, recreated._iIName) << "seed " << item._iSeed;
+	EXPECT_EQ(item._iIvalue, recreated._iIvalue) << "seed " << item._iSeed;
+	EXPECT_EQ(item._iMagical, recreated._iMagical) << "seed " << item._iSeed;
+	EXPECT_EQ(item._iPrePower, recreated._iPrePower) << "seed " << item._iSeed;
+	EXPECT_EQ(item._iSufPower, recreated._iSufPower) << "seed " << item._iSeed;
+	EXPECT_EQ(item._iSpell, recreated._iSpell) << "seed " << item._iSeed;
+	EXPECT_EQ(item._iMaxCharges, recreated._iMaxCharges) << "seed " << item._iSeed;
+	EXPECT_EQ(item._iMinStr, recreated._iMinStr) << "seed " << item._iSeed;
+	EXPECT_EQ(item._iMinMag, recreated._iMinMag) << "seed " << item._iSeed;
+	EXPECT_EQ(item._iMinDex, recreated._iMinDex) << "seed " << item._iSeed;
+}
+
+void CheckVendorItems()
+{
+	for (const Item &item : smithitem)
+		CheckRecreatedItem(item);
+	for (const Item &item : premiumitems)
+		CheckRecreatedItem(item);
+	// The first witch items are the pinned potions and scrolls which aren't generated from their seed
+	for (size_t i = 3; i < WITCH_ITEMS; i++)
+		CheckRecreatedItem(witchitem[i]);
+	CheckRecreatedItem(boyitem);
+}
+
+/** @brief Hashes the seeds of the vendor stock, any change to how many values a reroll consumes shows up here. */
+uint32_t HashVendorSeeds()
+{
+	uint32_t hash = 2166136261U;
+	const auto add = [&hash](const Item &item) {
+		hash = (hash ^ (item.isEmpty() ? 0 : item._iSeed)) * 16777619U;
+	};
+	for (const Item &item : smithitem)
+		add(item);
+	for (const Item &item : premiumitems)
+		add(item);
+	for (const Item &item : witchitem)
+		add(item);
+	add(boyitem);
+	return hash;
+}
+
+void TestVendorSeeds(const uint32_t (&expectedHashes)[std::size(VendorSeeds)])
+{
+	for (size_t i = 0; i < std::size(VendorSeeds); i++) {
+		const uint32_t seed = VendorSeeds[i];
+		uint32_t hash = 2166136261U;
+		for (int lvl = 1; lvl <= MaxCharacterLevel; lvl++) {
+			RestockVendors(lvl, seed);
+			CheckVendorItems();
+			hash = (hash ^ HashVendorSeeds()) * 16777619U;
+			hash = (hash ^ GetLCGEngineState()) * 16777619U;
+		}
+		EXPECT_EQ(hash, expectedHashes[i]) << "seed " << seed;
+	}
+}
+
+TEST_F(VendorTest, VendorSeeds_diablo)
+{
+	gbIsHellfire = false;
+	TestVendorSeeds(ExpectedDiabloHashes);
+}
+
+TEST_F(VendorTest, VendorSeeds_hellfire)
+{
+	gbIsHellfire = true;
+	TestVendorSeeds(ExpectedHellfireHashes);
+}
+
+/**
+ * @brief Times a full restock of all vendors for every character level.
+ *
+ * Run with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+ */
+TEST_F(VendorTest, DISABLED_Benchmark)
+{
+	constexpr int Iterations = 20;
+
+	for (bool hellfire : { false, true }) {
+		gbIsHellfire = hellfire;
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < Iterations; i++) {
+			for (int lvl = 1; lvl <= MaxCharacterLevel; lvl++)
+				RestockVendors(lvl, static_cast<uint32_t>(i * MaxCharacterLevel + lvl));
+		}
+		const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+		std::cout << (hellfire ? "hellfire" : "diablo") << ": "
+		          << elapsed.count() / (Iterations * MaxCharacterLevel) << "us per restock" << std::endl;
+	}
+}
+
+} // namespace